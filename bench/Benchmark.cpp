@@ -0,0 +1,524 @@
+// 衝突判定のベンチマーク
+//
+// Linux でのビルド例 (リポジトリのルートで):
+//   g++ -std=c++20 -O2 -pthread -I. -Iinclude bench/*.cpp src/Collision/*.cpp src/sys/*.cpp -o collision_bench
+//
+// 使い方:
+//   collision_bench [--scenes uniform,clustered,mixed,static] [--counts 1000,10000,100000,1000000]
+//                   [--threads 1,2,4,...] [--frames N] [--rays N] [--seed N] [--csv]
+//   collision_bench --verify [--verify-scenes N] [--seed N]
+//   collision_bench --record FILE [--scenes S] [--counts N] [--frames N] [--seed N]
+//   collision_bench --replay FILE [--threads 1,2,4,...] [--csv]
+//
+// シーンの種類と数、スレッド数の組ごとに Detect・ProcessEvent・RayCast・登録の入れ替えを計測し、
+// 1フレーム (RayCast は1本、入れ替えは1フレーム分) あたりの所要時間の分位数と処理量を出力する。
+// 同じ引数なら同じシーンが生成されるので、変更の前後で出力を比較できる。
+//
+// --verify はランダムなシーンで Detect・ProcessEvent・RayCast・Query 系を、ライブラリの判定を使わない
+// 総当たりの結果 (Reference.h) と比較し、不一致があれば終了コード 1 を返す (Verify.h)。
+//
+// --record は最初のシーンの種類と数でシーンを生成し、--frames フレーム分の動きと一緒にスナップショット
+// (Collision/Snapshot.h) へ書き出す。--replay はそれを読み込み、記録したフレームを再生して計測する。
+// 再生はシーンの生成と移動を含まないので、同じファイルを使えば環境をまたいで同じ入力で比べられる。
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Collision/CollisionManager.h"
+#include "Collision/Snapshot.h"
+#include "src/sys/Singleton.h"
+
+#include "Scene.h"
+#include "Verify.h"
+
+using namespace Collision;
+
+namespace{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedNanoseconds(Clock::time_point begin) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    }
+
+    struct Options{
+        std::vector<Bench::SceneKind> scenes {Bench::SceneKind::Uniform, Bench::SceneKind::Clustered, Bench::SceneKind::MixedSize, Bench::SceneKind::MostlyStatic};
+        std::vector<size_t> counts {1000, 10000, 100000, 1000000};
+        // 空ならスレッドプールの大きさまで倍々に増やす
+        std::vector<uint32_t> threads;
+        // 0 なら数に応じて決める
+        size_t frames = 0;
+        size_t rays = 0;
+        uint64_t seed = 1;
+        bool csv = false;
+        // 性能ではなく総当たりとの一致を検証する
+        bool verify = false;
+        size_t verifyScenes = 2000;
+        // スナップショットの書き出し先と再生するファイル
+        std::string record;
+        std::string replay;
+    };
+
+    // 所要時間の標本 (ナノ秒)
+    class Samples{
+        std::vector<double> values_;
+
+    public:
+        void Add(double nanoseconds) {
+            values_.push_back(nanoseconds);
+        }
+
+        bool Empty() const {
+            return values_.empty();
+        }
+
+        // 最近傍順位による分位数
+        double Percentile(double percent) {
+            std::ranges::sort(values_);
+            const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(values_.size())));
+            return values_[std::clamp<size_t>(rank, 1, values_.size()) - 1];
+        }
+
+        double Mean() const {
+            double sum = 0.0;
+            for (const double value : values_) sum += value;
+            return sum / static_cast<double>(values_.size());
+        }
+    };
+
+    class Reporter{
+        bool csv_;
+
+    public:
+        explicit Reporter(bool csv) :csv_(csv) {
+            if (csv_){
+                std::printf("scene,count,threads,metric,p50_ms,p90_ms,p99_ms,max_ms,items_per_second\n");
+            } else{
+                std::printf("%-9s %8s %3s %-14s %10s %10s %10s %10s %14s\n", "scene", "count", "thr", "metric", "p50 ms", "p90 ms", "p99 ms", "max ms", "items/s");
+            }
+        }
+
+        /**
+         * 1行出力します。
+         * @param metric 計測項目
+         * @param samples 1標本あたりの所要時間
+         * @param items 1標本あたりに処理した数 (処理量の計算に使う)
+         */
+        void Report(const char* scene, size_t count, uint32_t threads, const char* metric, Samples& samples, double items) const {
+            if (samples.Empty()) return;
+            const double toMs = 1e-6;
+            const double throughput = items / (samples.Mean() * 1e-9);
+            const char* format = csv_ ? "%s,%zu,%u,%s,%.4f,%.4f,%.4f,%.4f,%.1f\n" : "%-9s %8zu %3u %-14s %10.4f %10.4f %10.4f %10.4f %14.1f\n";
+            std::printf(format, scene, count, threads, metric,
+                        samples.Percentile(50) * toMs, samples.Percentile(90) * toMs, samples.Percentile(99) * toMs, samples.Percentile(100) * toMs, throughput);
+        }
+
+        void Note(const std::string& text) const {
+            std::printf("# %s\n", text.c_str());
+        }
+    };
+
+    // シーンの物体を Manager のコライダーとして保持する
+    class World{
+        Manager* manager_;
+        const Bench::Scene& scene_;
+        std::vector<Collider*> colliders_;
+        // 動く物体のコライダーと位置 (UpdateTransforms にそのまま渡す)
+        std::vector<Collider*> dynamicColliders_;
+        std::vector<Vec3> translates_;
+        uint64_t events_ = 0;
+
+    public:
+        World(Manager* manager, const Bench::Scene& scene) :manager_(manager), scene_(scene) {
+            colliders_.resize(scene.bodies.size());
+            manager_->ReserveColliders(colliders_.size());
+            manager_->CreateColliders(colliders_);
+            for (size_t i = 0; i < colliders_.size(); ++i){
+                Apply(colliders_[i], scene.bodies[i]);
+            }
+            CollectDynamic();
+        }
+
+        ~World() {
+            manager_->DestroyColliders(colliders_);
+            // 遅延解除を反映して次のシーンに持ち越さない
+            manager_->Detect();
+            manager_->ProcessEvent();
+        }
+
+        /// シーンの位置をコライダーへまとめて反映します
+        void Sync() {
+            for (size_t i = 0; i < scene_.dynamic.size(); ++i){
+                translates_[i] = scene_.bodies[scene_.dynamic[i]].translate;
+            }
+            manager_->UpdateTransforms(dynamicColliders_, translates_);
+        }
+
+        /**
+         * ランダムに選んだコライダーを破棄し、同じ物体のコライダーを生成し直します。
+         * @param count 入れ替える数
+         * @param random 選ぶための乱数
+         */
+        void Churn(size_t count, Bench::Random& random) {
+            std::vector<uint32_t> indices(count);
+            std::vector<Collider*> victims(count);
+            for (size_t i = 0; i < count; ++i){
+                indices[i] = random.Below(static_cast<uint32_t>(colliders_.size()));
+            }
+            std::ranges::sort(indices);
+            indices.erase(std::ranges::unique(indices).begin(), indices.end());
+            victims.resize(indices.size());
+            for (size_t i = 0; i < indices.size(); ++i){
+                victims[i] = colliders_[indices[i]];
+            }
+
+            manager_->DestroyColliders(victims);
+            manager_->CreateColliders(victims);
+            for (size_t i = 0; i < indices.size(); ++i){
+                colliders_[indices[i]] = victims[i];
+                Apply(victims[i], scene_.bodies[indices[i]]);
+            }
+            CollectDynamic();
+        }
+
+        const std::vector<Collider*>& GetColliders() const {
+            return colliders_;
+        }
+
+    private:
+        void Apply(Collider* collider, const Bench::Body& body) {
+            collider->SetType(body.type)->SetSize(body.size)->SetTranslate(body.translate)->SetRotate(body.rotate);
+            if (body.attribute) collider->AddAttribute(body.attribute);
+            if (body.ignore) collider->AddIgnore(body.ignore);
+            uint64_t* events = &events_;
+            collider->SetEvent(EventType::Trigger, [events](const Collider*){ ++*events; });
+            collider->SetEvent(EventType::Exit, [events](const Collider*){ ++*events; });
+            collider->Enable();
+        }
+
+        void CollectDynamic() {
+            dynamicColliders_.resize(scene_.dynamic.size());
+            translates_.resize(scene_.dynamic.size());
+            for (size_t i = 0; i < scene_.dynamic.size(); ++i){
+                dynamicColliders_[i] = colliders_[scene_.dynamic[i]];
+            }
+        }
+    };
+
+    template <typename T, typename Parse>
+    bool ParseList(std::string_view text, std::vector<T>& out, Parse parse) {
+        out.clear();
+        while (!text.empty()){
+            const size_t comma = text.find(',');
+            T value;
+            if (!parse(text.substr(0, comma), value)) return false;
+            out.push_back(value);
+            text = comma == std::string_view::npos ? std::string_view {} : text.substr(comma + 1);
+        }
+        return !out.empty();
+    }
+
+    template <typename T>
+    bool ParseNumber(std::string_view text, T& value) {
+        char* end = nullptr;
+        const std::string copy(text);
+        const unsigned long long parsed = std::strtoull(copy.c_str(), &end, 10);
+        if (copy.empty() || *end != '\0') return false;
+        value = static_cast<T>(parsed);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i){
+            const std::string_view arg = argv[i];
+            const std::string_view value = i + 1 < argc ? argv[i + 1] : "";
+            bool ok = true;
+            if (arg == "--csv"){
+                options.csv = true;
+                continue;
+            } else if (arg == "--verify"){
+                options.verify = true;
+                continue;
+            } else if (arg == "--record"){
+                options.record = value;
+            } else if (arg == "--replay"){
+                options.replay = value;
+            } else if (arg == "--verify-scenes"){
+                ok = ParseNumber(value, options.verifyScenes);
+            } else if (arg == "--scenes"){
+                ok = ParseList(value, options.scenes, [](std::string_view text, Bench::SceneKind& kind){ return Bench::Parse(text, kind); });
+            } else if (arg == "--counts"){
+                ok = ParseList(value, options.counts, ParseNumber<size_t>);
+            } else if (arg == "--threads"){
+                ok = ParseList(value, options.threads, ParseNumber<uint32_t>);
+            } else if (arg == "--frames"){
+                ok = ParseNumber(value, options.frames);
+            } else if (arg == "--rays"){
+                ok = ParseNumber(value, options.rays);
+            } else if (arg == "--seed"){
+                ok = ParseNumber(value, options.seed);
+            } else{
+                ok = false;
+            }
+            if (!ok){
+                std::fprintf(stderr, "invalid option: %s %s\n", argv[i], value.data());
+                return false;
+            }
+            ++i;
+        }
+        return true;
+    }
+
+    std::vector<uint32_t> ThreadCounts(const Manager* manager, const Options& options) {
+        std::vector<uint32_t> threads = options.threads;
+        if (threads.empty()){
+            for (uint32_t t = 1; t < manager->GetMaxThreadCount(); t *= 2) threads.push_back(t);
+            threads.push_back(manager->GetMaxThreadCount());
+        }
+        return threads;
+    }
+
+    std::vector<Ray> MakeRays(const Bench::Scene& scene, size_t count, uint64_t seed) {
+        Bench::Random random(seed);
+        std::vector<Ray> rays;
+        rays.reserve(count);
+        const float extent = scene.extent;
+        for (size_t i = 0; i < count; ++i){
+            const Vec3 origin(random.Uniform(-extent, extent), random.Uniform(-extent, extent), random.Uniform(-extent, extent));
+            Vec3 direction(random.Uniform(-1.f, 1.f), random.Uniform(-1.f, 1.f), random.Uniform(-1.f, 1.f));
+            direction = direction.Length() < 1e-3f ? Vec3(1.f, 0.f, 0.f) : direction / direction.Length();
+            rays.emplace_back(origin, direction, extent);
+        }
+        return rays;
+    }
+
+    void Run(Manager* manager, const Options& options, Bench::SceneKind kind, size_t count, const Reporter& reporter) {
+        Bench::Scene scene = Bench::GenerateScene(kind, count, options.seed);
+        World world(manager, scene);
+
+        const size_t frames = options.frames ? options.frames : std::clamp<size_t>(5'000'000 / std::max<size_t>(count, 1), 5, 60);
+        const size_t rayCount = options.rays ? options.rays : std::clamp<size_t>(50'000'000 / std::max<size_t>(count, 1), 16, 1000);
+        constexpr float kDeltaTime = 1.f / 60.f;
+
+        const std::vector<uint32_t> threads = ThreadCounts(manager, options);
+
+        // 初回の構築と全件の Trigger を計測から外す
+        manager->Detect();
+        manager->ProcessEvent();
+        reporter.Note(std::string(Bench::ToString(kind)) + " count=" + std::to_string(count) + " dynamic=" + std::to_string(scene.dynamic.size()) +
+                      " pairs=" + std::to_string(manager->GetStats().confirmedPairs) + " frames=" + std::to_string(frames));
+
+        std::vector<uint32_t> measured;
+        for (const uint32_t thread : threads){
+            manager->SetThreadCount(thread);
+            // プールより多い指定は丸められるので同じ数を2度計測しない
+            const uint32_t used = manager->GetThreadCount();
+            if (std::ranges::find(measured, used) != measured.end()) continue;
+            measured.push_back(used);
+            Samples detect, process, frame;
+            for (size_t f = 0; f < frames; ++f){
+                Bench::StepScene(scene, kDeltaTime);
+                const auto frameBegin = Clock::now();
+                world.Sync();
+
+                auto begin = Clock::now();
+                manager->Detect();
+                detect.Add(ElapsedNanoseconds(begin));
+
+                begin = Clock::now();
+                manager->ProcessEvent();
+                process.Add(ElapsedNanoseconds(begin));
+                frame.Add(ElapsedNanoseconds(frameBegin));
+            }
+            reporter.Report(Bench::ToString(kind), count, used, "detect", detect, static_cast<double>(count));
+            reporter.Report(Bench::ToString(kind), count, used, "process_event", process, static_cast<double>(count));
+            reporter.Report(Bench::ToString(kind), count, used, "frame", frame, static_cast<double>(count));
+        }
+        manager->SetThreadCount(0);
+        const uint32_t allThreads = manager->GetThreadCount();
+
+        // RayCast は呼び出したスレッドだけで処理されるのでスレッド数によらない
+        {
+            std::vector<Ray> rays = MakeRays(scene, rayCount, options.seed + 1);
+            Samples single;
+            for (const Ray& ray : rays){
+                const auto begin = Clock::now();
+                manager->RayCast(&ray);
+                single.Add(ElapsedNanoseconds(begin));
+            }
+            reporter.Report(Bench::ToString(kind), count, 1, "raycast", single, 1.0);
+
+            // 連続して撃つ場合 (1本ずつの時刻の取得を含めない)
+            Samples batch;
+            for (int b = 0; b < 5; ++b){
+                const auto begin = Clock::now();
+                for (const Ray& ray : rays){
+                    manager->RayCast(&ray);
+                }
+                batch.Add(ElapsedNanoseconds(begin));
+            }
+            reporter.Report(Bench::ToString(kind), count, 1, "raycast_batch", batch, static_cast<double>(rays.size()));
+        }
+
+        // 毎フレーム 1% のコライダーを破棄・生成する
+        {
+            Bench::Random random(options.seed + 2);
+            const size_t churn = std::max<size_t>(1, count / 100);
+            Samples registration, detect;
+            for (size_t f = 0; f < frames; ++f){
+                auto begin = Clock::now();
+                world.Churn(churn, random);
+                registration.Add(ElapsedNanoseconds(begin));
+
+                begin = Clock::now();
+                manager->Detect();
+                manager->ProcessEvent();
+                detect.Add(ElapsedNanoseconds(begin));
+            }
+            // 破棄と生成で2操作
+            reporter.Report(Bench::ToString(kind), count, allThreads, "churn", registration, static_cast<double>(churn * 2));
+            reporter.Report(Bench::ToString(kind), count, allThreads, "churn_frame", detect, static_cast<double>(count));
+        }
+    }
+
+    // 最初のシーンの種類と数でシーンを動かしながら記録する
+    bool Record(Manager* manager, const Options& options) {
+        const Bench::SceneKind kind = options.scenes.front();
+        const size_t count = options.counts.front();
+        Bench::Scene scene = Bench::GenerateScene(kind, count, options.seed);
+        World world(manager, scene);
+
+        const size_t frames = options.frames ? options.frames : 60;
+        constexpr float kDeltaTime = 1.f / 60.f;
+        Collision::SnapshotWriter writer(world.GetColliders());
+        for (size_t f = 0; f < frames; ++f){
+            Bench::StepScene(scene, kDeltaTime);
+            world.Sync();
+            writer.RecordFrame();
+        }
+
+        if (!writer.Write(options.record)){
+            std::fprintf(stderr, "failed to write %s\n", options.record.c_str());
+            return false;
+        }
+        std::printf("# recorded %s count=%zu frames=%zu to %s\n", Bench::ToString(kind), count, frames, options.record.c_str());
+        return true;
+    }
+
+    // 記録したフレームをスレッド数ごとに再生する
+    bool Replay(Manager* manager, const Options& options, const Reporter& reporter) {
+        Collision::Snapshot snapshot;
+        auto begin = Clock::now();
+        if (!snapshot.Open(options.replay)){
+            std::fprintf(stderr, "failed to open %s\n", options.replay.c_str());
+            return false;
+        }
+        Samples open;
+        open.Add(ElapsedNanoseconds(begin));
+
+        const size_t count = snapshot.GetColliderCount();
+        std::vector<Collider*> colliders(count);
+        begin = Clock::now();
+        snapshot.Load(*manager, colliders);
+        Samples load;
+        load.Add(ElapsedNanoseconds(begin));
+
+        // 記録時と同じくイベントを受け取るコライダーにする
+        uint64_t events = 0;
+        auto subscribe = [&]{
+            for (Collider* collider : colliders){
+                collider->SetEvent(EventType::Trigger, [&events](const Collider*){ ++events; });
+                collider->SetEvent(EventType::Exit, [&events](const Collider*){ ++events; });
+            }
+        };
+        subscribe();
+
+        reporter.Note("replay " + options.replay + " count=" + std::to_string(count) + " frames=" + std::to_string(snapshot.GetFrameCount()));
+        reporter.Report("replay", count, 1, "open", open, static_cast<double>(count));
+        reporter.Report("replay", count, 1, "load", load, static_cast<double>(count));
+
+        std::vector<uint32_t> measured;
+        for (const uint32_t thread : ThreadCounts(manager, options)){
+            manager->SetThreadCount(thread);
+            const uint32_t used = manager->GetThreadCount();
+            if (std::ranges::find(measured, used) != measured.end()) continue;
+
+            // 初期状態から再生し直す
+            if (!measured.empty()){
+                manager->DestroyColliders(colliders);
+                manager->Detect();
+                manager->ProcessEvent();
+                snapshot.Load(*manager, colliders);
+                subscribe();
+            }
+            measured.push_back(used);
+
+            // 初回の構築と全件の Trigger を計測から外す
+            manager->Detect();
+            manager->ProcessEvent();
+
+            Samples detect, process, frame;
+            for (size_t f = 0; f < snapshot.GetFrameCount(); ++f){
+                const auto frameBegin = Clock::now();
+                snapshot.ApplyFrame(*manager, f, colliders);
+
+                begin = Clock::now();
+                manager->Detect();
+                detect.Add(ElapsedNanoseconds(begin));
+
+                begin = Clock::now();
+                manager->ProcessEvent();
+                process.Add(ElapsedNanoseconds(begin));
+                frame.Add(ElapsedNanoseconds(frameBegin));
+            }
+            reporter.Report("replay", count, used, "detect", detect, static_cast<double>(count));
+            reporter.Report("replay", count, used, "process_event", process, static_cast<double>(count));
+            reporter.Report("replay", count, used, "frame", frame, static_cast<double>(count));
+        }
+        manager->SetThreadCount(0);
+        manager->DestroyColliders(colliders);
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) return 1;
+
+    Manager* manager = Singleton<Manager>::Get();
+    if (options.verify){
+        const size_t mismatches = Bench::Verify(*manager, {.scenes = options.verifyScenes, .seed = options.seed});
+        SingletonFinalizer::Finalize();
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    if (!options.record.empty()){
+        const bool recorded = Record(manager, options);
+        SingletonFinalizer::Finalize();
+        return recorded ? 0 : 1;
+    }
+
+    const Reporter reporter(options.csv);
+    reporter.Note("worker threads=" + std::to_string(manager->GetMaxThreadCount()) + " seed=" + std::to_string(options.seed));
+    if (!options.replay.empty()){
+        const bool replayed = Replay(manager, options, reporter);
+        SingletonFinalizer::Finalize();
+        return replayed ? 0 : 1;
+    }
+
+    for (const size_t count : options.counts){
+        for (const Bench::SceneKind kind : options.scenes){
+            Run(manager, options, kind, count, reporter);
+            std::fflush(stdout);
+        }
+    }
+
+    SingletonFinalizer::Finalize();
+    return 0;
+}
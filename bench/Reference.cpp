@@ -0,0 +1,643 @@
+#include "Reference.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <variant>
+
+#include "Collision/CompoundShape.h"
+#include "Collision/ConvexHull.h"
+#include "Collision/HeightField.h"
+#include "Collision/TriangleMesh.h"
+
+using namespace Collision;
+
+namespace Bench{
+    namespace{
+        using Convex = ReferenceShape::Convex;
+
+        constexpr double kInfinity = std::numeric_limits<double>::infinity();
+        // GJK でこれより近ければ芯同士が重なっているとみなす
+        constexpr double kOverlapDistance = 1e-9;
+        // これより浅い角度で三角形を掠めるレイは当たるとは限らない
+        constexpr double kGrazingCosine = 1e-3;
+        constexpr Vector kCoordinateAxes[] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+
+        Verdict Or(Verdict a, Verdict b) {
+            return std::max(a, b);
+        }
+
+        // 符号付きの隙間 (重なっていれば負) から判定する
+        Verdict FromGap(double gap) {
+            if (gap < -kReferenceTolerance) return Verdict::Hit;
+            if (kReferenceTolerance < gap) return Verdict::Miss;
+            return Verdict::Either;
+        }
+
+        // 外接AABB が許容誤差より離れているか
+        bool Separated(const Vector& minA, const Vector& maxA, const Vector& minB, const Vector& maxB) {
+            constexpr double t = kReferenceTolerance;
+            return maxA.x + t < minB.x || maxB.x + t < minA.x ||
+                maxA.y + t < minB.y || maxB.y + t < minA.y ||
+                maxA.z + t < minB.z || maxB.z + t < minA.z;
+        }
+
+        // 線分 origin + direction * [0, length] が AABB を通るか (スラブ判定)
+        bool SegmentHitsBox(const Vector& origin, const Vector& direction, double length, const Vector& min, const Vector& max) {
+            double enter = 0.0;
+            double exit = length;
+            const double o[3] = {origin.x, origin.y, origin.z};
+            const double d[3] = {direction.x, direction.y, direction.z};
+            const double lo[3] = {min.x, min.y, min.z};
+            const double hi[3] = {max.x, max.y, max.z};
+            for (int axis = 0; axis < 3; ++axis){
+                if (std::abs(d[axis]) < 1e-15){
+                    if (o[axis] < lo[axis] || hi[axis] < o[axis]) return false;
+                    continue;
+                }
+                double t1 = (lo[axis] - o[axis]) / d[axis];
+                double t2 = (hi[axis] - o[axis]) / d[axis];
+                if (t2 < t1) std::swap(t1, t2);
+                enter = std::max(enter, t1);
+                exit = std::min(exit, t2);
+                if (exit < enter) return false;
+            }
+            return true;
+        }
+
+        double MaxDot(const std::vector<Vector>& points, const Vector& direction) {
+            double best = -kInfinity;
+            for (const Vector& point : points){
+                best = std::max(best, point.Dot(direction));
+            }
+            return best;
+        }
+
+        const Vector& Support(const std::vector<Vector>& points, const Vector& direction) {
+            const Vector* best = &points[0];
+            double bestDot = best->Dot(direction);
+            for (const Vector& point : points){
+                const double dot = point.Dot(direction);
+                if (bestDot < dot){
+                    bestDot = dot;
+                    best = &point;
+                }
+            }
+            return *best;
+        }
+
+        // 向きの重複を除いて正規化した軸を加える (逆向きも同じ軸とみなす)
+        void AddAxis(std::vector<Vector>& axes, const Vector& axis) {
+            const double length = axis.Length();
+            if (length < 1e-12) return;
+            const Vector n = axis * (1.0 / length);
+            for (const Vector& other : axes){
+                if (1.0 - 1e-12 < std::abs(other.Dot(n))) return;
+            }
+            axes.push_back(n);
+        }
+
+        // 一般の点の集合から分離軸の候補を求める (面は3点を通る平面の片側に全点があるもの, 辺はすべての2点の向き)
+        void BuildAxes(Convex& part) {
+            const std::vector<Vector>& p = part.points;
+            double scale = 1.0;
+            for (const Vector& point : p){
+                scale = std::max({scale, std::abs(point.x), std::abs(point.y), std::abs(point.z)});
+            }
+            const double epsilon = 1e-9 * scale;
+
+            for (size_t i = 0; i < p.size(); ++i){
+                for (size_t j = i + 1; j < p.size(); ++j){
+                    AddAxis(part.edges, p[j] - p[i]);
+                    for (size_t k = j + 1; k < p.size(); ++k){
+                        Vector n = (p[j] - p[i]).Cross(p[k] - p[i]);
+                        const double length = n.Length();
+                        if (length < 1e-12) continue;
+                        n = n * (1.0 / length);
+                        double low = kInfinity;
+                        double high = -kInfinity;
+                        for (const Vector& q : p){
+                            const double d = n.Dot(q - p[i]);
+                            low = std::min(low, d);
+                            high = std::max(high, d);
+                        }
+                        if (high <= epsilon || -epsilon <= low) AddAxis(part.normals, n);
+                    }
+                }
+            }
+        }
+
+        // 連立一次方程式を部分ピボット選択のガウスの消去法で解く (m は n 行 n+1 列の拡大係数行列)
+        bool Solve(std::array<std::array<double, 4>, 3>& m, size_t n, std::array<double, 3>& x) {
+            double scale = 0.0;
+            for (size_t r = 0; r < n; ++r){
+                for (size_t c = 0; c < n; ++c) scale = std::max(scale, std::abs(m[r][c]));
+            }
+            for (size_t c = 0; c < n; ++c){
+                size_t pivot = c;
+                for (size_t r = c + 1; r < n; ++r){
+                    if (std::abs(m[pivot][c]) < std::abs(m[r][c])) pivot = r;
+                }
+                // 退化した単体 (点が重なる・一直線・同一平面)
+                if (std::abs(m[pivot][c]) <= 1e-13 * scale) return false;
+                std::swap(m[c], m[pivot]);
+                for (size_t r = c + 1; r < n; ++r){
+                    const double f = m[r][c] / m[c][c];
+                    for (size_t k = c; k <= n; ++k) m[r][k] -= f * m[c][k];
+                }
+            }
+            for (size_t c = n; c-- > 0;){
+                double value = m[c][n];
+                for (size_t k = c + 1; k < n; ++k) value -= m[c][k] * x[k];
+                x[c] = value / m[c][c];
+            }
+            return true;
+        }
+
+        // 単体上で原点に最も近い点を、すべての部分単体への射影を試して求める (単体は最も近い部分単体に縮める)
+        Vector ClosestOnSimplex(std::array<Vector, 4>& simplex, size_t& count) {
+            Vector best = simplex[0];
+            double bestLength = kInfinity;
+            uint32_t bestMask = 1;
+
+            for (uint32_t mask = 1; mask < (1u << count); ++mask){
+                std::array<Vector, 4> p;
+                size_t k = 0;
+                for (size_t i = 0; i < count; ++i){
+                    if (mask & (1u << i)) p[k++] = simplex[i];
+                }
+
+                // p0 + Σ mu_i (p_i - p0) を原点へ射影する正規方程式
+                const size_t n = k - 1;
+                std::array<std::array<double, 4>, 3> m {};
+                for (size_t i = 0; i < n; ++i){
+                    const Vector ei = p[i + 1] - p[0];
+                    for (size_t j = 0; j < n; ++j) m[i][j] = ei.Dot(p[j + 1] - p[0]);
+                    m[i][n] = -ei.Dot(p[0]);
+                }
+                std::array<double, 3> mu {};
+                if (!Solve(m, n, mu)) continue;
+
+                // 射影が部分単体の内側にあるものだけが候補
+                double sum = 0.0;
+                bool inside = true;
+                for (size_t i = 0; i < n; ++i){
+                    if (mu[i] < -1e-12) inside = false;
+                    sum += mu[i];
+                }
+                if (!inside || 1.0 + 1e-12 < sum) continue;
+
+                Vector point = p[0];
+                for (size_t i = 0; i < n; ++i) point = point + (p[i + 1] - p[0]) * mu[i];
+                const double length = point.Length();
+                if (length < bestLength){
+                    bestLength = length;
+                    best = point;
+                    bestMask = mask;
+                }
+            }
+
+            size_t kept = 0;
+            for (size_t i = 0; i < count; ++i){
+                if (bestMask & (1u << i)) simplex[kept++] = simplex[i];
+            }
+            count = kept;
+            return best;
+        }
+
+        // 芯 (半径を除いた点の凸包) 同士の距離を GJK で求める
+        double CoreDistance(const Convex& a, const Convex& b) {
+            std::array<Vector, 4> simplex;
+            size_t count = 0;
+            Vector v = a.points[0] - b.points[0];
+            for (int iteration = 0; iteration < 64; ++iteration){
+                const double vv = v.Dot(v);
+                if (vv < kOverlapDistance * kOverlapDistance) return 0.0;
+                const Vector w = Support(a.points, v * -1.0) - Support(b.points, v);
+                // 原点へ近づかなくなったら v が最近点
+                if (vv - v.Dot(w) <= 1e-12 * vv) break;
+                simplex[count++] = w;
+                v = ClosestOnSimplex(simplex, count);
+                // 四面体が原点を含む
+                if (count == 4) return 0.0;
+            }
+            return v.Length();
+        }
+
+        // 重なっている芯同士の入り込みの深さ (差の集合の面の法線、すなわち各面の法線と辺同士の外積の中での最小の重なり)
+        double CoreDepth(const Convex& a, const Convex& b) {
+            double depth = kInfinity;
+            auto test = [&](const Vector& axis){
+                const double length = axis.Length();
+                if (length < 1e-12) return;
+                const Vector n = axis * (1.0 / length);
+                depth = std::min(depth, MaxDot(a.points, n) + MaxDot(b.points, n * -1.0));
+                depth = std::min(depth, MaxDot(a.points, n * -1.0) + MaxDot(b.points, n));
+            };
+            for (const Vector& n : a.normals) test(n);
+            for (const Vector& n : b.normals) test(n);
+            for (const Vector& ea : a.edges){
+                for (const Vector& eb : b.edges) test(ea.Cross(eb));
+            }
+            // 点や線分のように差の集合が平たい場合にも、その面に沿う向きを候補に含める
+            for (const Vector& axis : kCoordinateAxes){
+                test(axis);
+                for (const Vector& e : a.edges) test(e.Cross(axis));
+                for (const Vector& e : b.edges) test(e.Cross(axis));
+            }
+            return std::max(depth, 0.0);
+        }
+
+        // 符号付きの隙間 (離れていれば表面同士の距離, 重なっていれば入り込みの深さの符号を反転したもの)
+        double Gap(const Convex& a, const Convex& b) {
+            const double distance = CoreDistance(a, b);
+            const double core = kOverlapDistance < distance ? distance : -CoreDepth(a, b);
+            return core - a.radius - b.radius;
+        }
+
+        Convex PointPart(const Vector& point) {
+            return {.points = {point}, .radius = 0.0, .center = point, .normals = {}, .edges = {}, .min = point, .max = point};
+        }
+
+        /**
+         * 下に凸な関数が threshold 以下になる最初の位置を [0, length] から探します。
+         * @return 見つからなければ無限大
+         */
+        template <typename F>
+        double FirstBelow(F&& f, double length, double threshold) {
+            if (f(0.0) <= threshold) return 0.0;
+
+            // 黄金分割で最小値を探す
+            constexpr double kRatio = 0.6180339887498949;
+            double lo = 0.0;
+            double hi = length;
+            double x1 = hi - kRatio * (hi - lo);
+            double x2 = lo + kRatio * (hi - lo);
+            double f1 = f(x1);
+            double f2 = f(x2);
+            for (int i = 0; i < 100 && 1e-9 < hi - lo; ++i){
+                if (f1 < f2){
+                    hi = x2;
+                    x2 = x1;
+                    f2 = f1;
+                    x1 = hi - kRatio * (hi - lo);
+                    f1 = f(x1);
+                } else{
+                    lo = x1;
+                    x1 = x2;
+                    f1 = f2;
+                    x2 = lo + kRatio * (hi - lo);
+                    f2 = f(x2);
+                }
+            }
+            double minimum = f1 < f2 ? x1 : x2;
+            if (f(length) <= std::min(f1, f2)) minimum = length;
+            if (threshold < f(minimum)) return kInfinity;
+
+            // 最小値までは単調に減るので二分法で境目を求める
+            lo = 0.0;
+            hi = minimum;
+            for (int i = 0; i < 100 && 1e-12 < hi - lo; ++i){
+                const double mid = (lo + hi) * 0.5;
+                if (f(mid) <= threshold) hi = mid;
+                else lo = mid;
+            }
+            return hi;
+        }
+
+        // レイが三角形の内側を確実に横切る距離 (掠める・辺の近く・原点の近くなら無限大)
+        double CrossTriangle(const Convex& triangle, const Vector& origin, const Vector& direction, double length) {
+            const Vector& a = triangle.points[0];
+            const Vector& b = triangle.points[1];
+            const Vector& c = triangle.points[2];
+            Vector n = (b - a).Cross(c - a);
+            const double area = n.Length();
+            if (area < 1e-12) return kInfinity;
+            n = n * (1.0 / area);
+
+            const double cosine = direction.Dot(n);
+            if (std::abs(cosine) < kGrazingCosine) return kInfinity;
+            const double t = (a - origin).Dot(n) / cosine;
+            if (t * std::abs(cosine) <= kReferenceTolerance || length - kReferenceTolerance < t) return kInfinity;
+
+            // 交点が各辺から内側へ許容誤差以上離れているか
+            const Vector p = origin + direction * t;
+            const Vector vertices[3] = {a, b, c};
+            for (int i = 0; i < 3; ++i){
+                const Vector& u = vertices[i];
+                const Vector& v = vertices[(i + 1) % 3];
+                const Vector& w = vertices[(i + 2) % 3];
+                Vector inward = n.Cross(v - u);
+                const double edge = inward.Length();
+                if (edge < 1e-12) return kInfinity;
+                inward = inward * (1.0 / edge);
+                if (inward.Dot(w - u) < 0.0) inward = inward * -1.0;
+                if (inward.Dot(p - u) < kReferenceTolerance) return kInfinity;
+            }
+            return t;
+        }
+    }
+
+    ReferenceShape ReferenceShape::Of(const Collider* collider) {
+        ReferenceShape shape;
+        const Vector translate = Vector::Of(collider->GetTranslate());
+        const auto& axes = collider->GetAxes();
+        const Vector x = Vector::Of(axes[0]);
+        const Vector y = Vector::Of(axes[1]);
+        const Vector z = Vector::Of(axes[2]);
+        const auto& size = collider->GetSize();
+
+        auto addBox = [&shape](const Vector& center, const Vector& ax, const Vector& ay, const Vector& az, const Vector& half){
+            std::vector<Vector> corners;
+            for (int i = 0; i < 8; ++i){
+                corners.push_back(center + ax * (i & 1 ? half.x : -half.x) + ay * (i & 2 ? half.y : -half.y) + az * (i & 4 ? half.z : -half.z));
+            }
+            Convex part {.points = std::move(corners), .radius = 0.0, .center = center, .normals = {}, .edges = {}, .min = {}, .max = {}};
+            // 面の法線も辺の向きもボックスの軸
+            for (const Vector& axis : {ax, ay, az}){
+                AddAxis(part.normals, axis);
+                AddAxis(part.edges, axis);
+            }
+            shape.parts_.push_back(std::move(part));
+        };
+
+        if (const auto* radius = std::get_if<float>(&size)){
+            shape.AddPart({translate}, *radius, translate);
+        } else if (const auto* extent = std::get_if<Vec3>(&size)){
+            // Vec3 の大きさは Type::OBB の場合だけ回転する
+            const Vector half = Vector::Of(*extent) * 0.5;
+            if (collider->GetType() == Type::OBB) addBox(translate, x, y, z, half);
+            else addBox(translate, kCoordinateAxes[0], kCoordinateAxes[1], kCoordinateAxes[2], half);
+        } else if (const auto* capsule = std::get_if<CapsuleSize>(&size)){
+            const Vector half = y * (capsule->height * 0.5);
+            shape.AddPart({translate - half, translate + half}, capsule->radius, translate);
+        } else if (const auto* mesh = std::get_if<std::shared_ptr<const TriangleMesh>>(&size)){
+            shape.kind_ = Kind::Mesh;
+            if (*mesh){
+                const TriangleMesh::Prebuilt prebuilt = (*mesh)->GetPrebuilt();
+                for (const auto& triangle : prebuilt.triangles){
+                    shape.AddTriangle(translate + Vector::Of(prebuilt.vertices[triangle[0]]),
+                                      translate + Vector::Of(prebuilt.vertices[triangle[1]]),
+                                      translate + Vector::Of(prebuilt.vertices[triangle[2]]));
+                }
+            }
+        } else if (const auto* field = std::get_if<std::shared_ptr<const HeightField>>(&size)){
+            shape.kind_ = Kind::HeightField;
+            if (*field){
+                const HeightField& f = **field;
+                shape.origin_ = translate;
+                shape.width_ = f.GetWidth();
+                shape.depth_ = f.GetDepth();
+                shape.cellSize_ = f.GetCellSize();
+                for (const uint16_t height : f.GetHeights()){
+                    shape.heights_.push_back(static_cast<double>(f.GetHeightOffset()) + static_cast<double>(height) * f.GetHeightScale());
+                }
+                auto vertex = [&shape](uint32_t ix, uint32_t iz){
+                    return shape.origin_ + Vector {ix * shape.cellSize_, shape.heights_[static_cast<size_t>(iz) * shape.width_ + ix], iz * shape.cellSize_};
+                };
+                // 各セルを (0,0)-(1,1) の対角線で2枚に分ける
+                for (uint32_t iz = 0; iz + 1 < shape.depth_; ++iz){
+                    for (uint32_t ix = 0; ix + 1 < shape.width_; ++ix){
+                        shape.AddTriangle(vertex(ix, iz), vertex(ix, iz + 1), vertex(ix + 1, iz + 1));
+                        shape.AddTriangle(vertex(ix, iz), vertex(ix + 1, iz + 1), vertex(ix + 1, iz));
+                    }
+                }
+                const double lowest = *std::ranges::min_element(shape.heights_);
+                const double horizontal = std::max(shape.width_ - 1, shape.depth_ - 1) * shape.cellSize_;
+                shape.bottom_ = translate.y + lowest - horizontal;
+            }
+        } else if (const auto* compound = std::get_if<std::shared_ptr<const CompoundShape>>(&size)){
+            if (*compound){
+                // 子は回転を持たない
+                for (const auto& child : (*compound)->GetChildren()){
+                    const Vector center = translate + Vector::Of(child.offset);
+                    if (const auto* childRadius = std::get_if<float>(&child.size)){
+                        shape.AddPart({center}, *childRadius, center);
+                    } else{
+                        addBox(center, kCoordinateAxes[0], kCoordinateAxes[1], kCoordinateAxes[2], Vector::Of(std::get<Vec3>(child.size)) * 0.5);
+                    }
+                }
+            }
+        } else if (const auto* hull = std::get_if<std::shared_ptr<const ConvexHull>>(&size)){
+            if (*hull){
+                std::vector<Vector> points;
+                Vector low {kInfinity, kInfinity, kInfinity};
+                Vector high = low * -1.0;
+                for (const Vec3& v : (*hull)->GetVertices()){
+                    points.push_back(translate + x * v.x + y * v.y + z * v.z);
+                    low = {std::min(low.x, static_cast<double>(v.x)), std::min(low.y, static_cast<double>(v.y)), std::min(low.z, static_cast<double>(v.z))};
+                    high = {std::max(high.x, static_cast<double>(v.x)), std::max(high.y, static_cast<double>(v.y)), std::max(high.z, static_cast<double>(v.z))};
+                }
+                // 地形の判定に使う中心は頂点の境界の中心
+                const Vector mid = (low + high) * 0.5;
+                shape.AddPart(std::move(points), 0.0, translate + x * mid.x + y * mid.y + z * mid.z);
+            }
+        }
+
+        shape.UpdateBounds();
+        return shape;
+    }
+
+    ReferenceShape ReferenceShape::Sphere(const Vector& center, double radius) {
+        ReferenceShape shape;
+        shape.AddPart({center}, radius, center);
+        shape.UpdateBounds();
+        return shape;
+    }
+
+    ReferenceShape ReferenceShape::Box(const Vector& min, const Vector& max) {
+        std::vector<Vector> corners;
+        for (int i = 0; i < 8; ++i){
+            corners.push_back({i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z});
+        }
+        ReferenceShape shape;
+        Convex part {.points = std::move(corners), .radius = 0.0, .center = (min + max) * 0.5, .normals = {}, .edges = {}, .min = {}, .max = {}};
+        for (const Vector& axis : kCoordinateAxes){
+            AddAxis(part.normals, axis);
+            AddAxis(part.edges, axis);
+        }
+        shape.parts_.push_back(std::move(part));
+        shape.UpdateBounds();
+        return shape;
+    }
+
+    ReferenceShape ReferenceShape::Polytope(std::span<const Vector> vertices) {
+        ReferenceShape shape;
+        if (vertices.empty()) return shape;
+        Vector center;
+        for (const Vector& v : vertices) center = center + v;
+        shape.AddPart({vertices.begin(), vertices.end()}, 0.0, center * (1.0 / static_cast<double>(vertices.size())));
+        shape.UpdateBounds();
+        return shape;
+    }
+
+    ReferenceShape::Kind ReferenceShape::GetKind() const {
+        return kind_;
+    }
+
+    const Vector& ReferenceShape::GetMin() const {
+        return min_;
+    }
+
+    const Vector& ReferenceShape::GetMax() const {
+        return max_;
+    }
+
+    Verdict ReferenceShape::Overlaps(const ReferenceShape& other) const {
+        if (parts_.empty() || other.parts_.empty()) return Verdict::Miss;
+        const bool surface = kind_ != Kind::Solid;
+        const bool otherSurface = other.kind_ != Kind::Solid;
+        // 静的な形状同士は判定しない
+        if (surface && otherSurface) return Verdict::Miss;
+        if (Separated(min_, max_, other.min_, other.max_)) return Verdict::Miss;
+        if (surface) return OverlapsSurface(other);
+        if (otherSurface) return other.OverlapsSurface(*this);
+
+        // 凸形状の和集合同士はいずれかの組が重なれば衝突
+        Verdict result = Verdict::Miss;
+        for (const Convex& a : parts_){
+            for (const Convex& b : other.parts_){
+                if (Separated(a.min, a.max, b.min, b.max)) continue;
+                result = Or(result, FromGap(Gap(a, b)));
+                if (result == Verdict::Hit) return result;
+            }
+        }
+        return result;
+    }
+
+    Verdict ReferenceShape::Contains(const Vector& point) const {
+        // メッシュは面のみで体積を持たない
+        if (kind_ == Kind::Mesh || parts_.empty()) return Verdict::Miss;
+        if (Separated(min_, max_, point, point)) return Verdict::Miss;
+        if (kind_ == Kind::HeightField) return Below(point, 0.0);
+        return Overlaps(Sphere(point, 0.0));
+    }
+
+    ReferenceShape::Range ReferenceShape::Distance(const Vector& point) const {
+        const Convex probe = PointPart(point);
+        double nearest = kInfinity;
+        for (const Convex& part : parts_){
+            nearest = std::min(nearest, std::max(0.0, Gap(part, probe)));
+        }
+        if (kind_ != Kind::HeightField) return {nearest, nearest};
+
+        // 地中の点は距離0
+        switch (Below(point, 0.0)){
+        case Verdict::Hit:
+            return {0.0, 0.0};
+        case Verdict::Either:
+            return {0.0, nearest};
+        default:
+            return {nearest, nearest};
+        }
+    }
+
+    ReferenceShape::RayRange ReferenceShape::RayCast(const Vector& origin, const Vector& direction, double length) const {
+        RayRange range {kInfinity, kInfinity};
+        const Vector margin {kReferenceTolerance, kReferenceTolerance, kReferenceTolerance};
+        if (parts_.empty() || !SegmentHitsBox(origin, direction, length, min_ - margin, max_ + margin)) return range;
+
+        for (const Convex& part : parts_){
+            if (!SegmentHitsBox(origin, direction, length, part.min - margin, part.max + margin)) continue;
+            Convex probe = PointPart(origin);
+            // 芯からの符号付きの隙間は直線上で下に凸
+            auto gapAt = [&](double t){
+                probe.points[0] = origin + direction * t;
+                return Gap(part, probe);
+            };
+            range.touch = std::min(range.touch, FirstBelow(gapAt, length, kReferenceTolerance));
+            // 中身のある形状は入り込んだ位置、面は三角形を横切る位置で確実に当たる (地形のレイは地表のみ)
+            const double enter = kind_ == Kind::Solid ? FirstBelow(gapAt, length, -kReferenceTolerance) : CrossTriangle(part, origin, direction, length);
+            range.enter = std::min(range.enter, enter);
+        }
+        return range;
+    }
+
+    bool ReferenceShape::Touches(const Vector& point) const {
+        const Convex probe = PointPart(point);
+        for (const Convex& part : parts_){
+            if (Separated(part.min, part.max, point, point)) continue;
+            if (Gap(part, probe) <= kReferenceTolerance) return true;
+        }
+        return false;
+    }
+
+    void ReferenceShape::AddPart(std::vector<Vector> points, double radius, const Vector& center) {
+        Convex part {.points = std::move(points), .radius = radius, .center = center, .normals = {}, .edges = {}, .min = {}, .max = {}};
+        BuildAxes(part);
+        parts_.push_back(std::move(part));
+    }
+
+    void ReferenceShape::AddTriangle(const Vector& a, const Vector& b, const Vector& c) {
+        AddPart({a, b, c}, 0.0, (a + b + c) * (1.0 / 3.0));
+    }
+
+    void ReferenceShape::UpdateBounds() {
+        min_ = {kInfinity, kInfinity, kInfinity};
+        max_ = min_ * -1.0;
+        for (Convex& part : parts_){
+            part.min = {kInfinity, kInfinity, kInfinity};
+            part.max = part.min * -1.0;
+            for (const Vector& p : part.points){
+                part.min = {std::min(part.min.x, p.x), std::min(part.min.y, p.y), std::min(part.min.z, p.z)};
+                part.max = {std::max(part.max.x, p.x), std::max(part.max.y, p.y), std::max(part.max.z, p.z)};
+            }
+            const Vector extent {part.radius, part.radius, part.radius};
+            part.min = part.min - extent;
+            part.max = part.max + extent;
+            min_ = {std::min(min_.x, part.min.x), std::min(min_.y, part.min.y), std::min(min_.z, part.min.z)};
+            max_ = {std::max(max_.x, part.max.x), std::max(max_.y, part.max.y), std::max(max_.z, part.max.z)};
+        }
+        // 地形は中身の下端までを範囲とする
+        if (kind_ == Kind::HeightField && !parts_.empty()) min_.y = std::min(min_.y, bottom_);
+    }
+
+    Verdict ReferenceShape::Below(const Vector& point, double extent) const {
+        constexpr double t = kReferenceTolerance;
+        const double x = point.x - origin_.x;
+        const double z = point.z - origin_.z;
+        const double maxX = (width_ - 1) * cellSize_;
+        const double maxZ = (depth_ - 1) * cellSize_;
+        if (x < -t || maxX + t < x || z < -t || maxZ + t < z) return Verdict::Miss;
+
+        // 点の下の三角形の平面での地表の高さ
+        const double cx = std::clamp(x, 0.0, maxX);
+        const double cz = std::clamp(z, 0.0, maxZ);
+        const uint32_t ix = std::min(static_cast<uint32_t>(cx / cellSize_), width_ - 2);
+        const uint32_t iz = std::min(static_cast<uint32_t>(cz / cellSize_), depth_ - 2);
+        const double fx = cx / cellSize_ - ix;
+        const double fz = cz / cellSize_ - iz;
+        auto h = [&](uint32_t dx, uint32_t dz){
+            return heights_[static_cast<size_t>(iz + dz) * width_ + ix + dx];
+        };
+        // (0,0)-(0,1)-(1,1) と (0,0)-(1,1)-(1,0) の三角形の重心座標で補間する
+        const double height = fx <= fz ?
+            h(0, 0) * (1.0 - fz) + h(0, 1) * (fz - fx) + h(1, 1) * fx :
+            h(0, 0) * (1.0 - fx) + h(1, 0) * (fx - fz) + h(1, 1) * fz;
+        const double y = point.y - origin_.y;
+        if (height + t < y) return Verdict::Miss;
+
+        const bool edge = x < t || maxX - t < x || z < t || maxZ - t < z;
+        // 相手の上端が中身の下端に届かない位置は、ブロードフェーズの境界 (ライブラリは大きめに取りうる) と重なるかが決まらない
+        const bool deep = point.y + extent < bottom_ + t;
+        return edge || height - t < y || deep ? Verdict::Either : Verdict::Hit;
+    }
+
+    Verdict ReferenceShape::OverlapsSurface(const ReferenceShape& solid) const {
+        Verdict result = Verdict::Miss;
+        for (const Convex& part : solid.parts_){
+            // 地形は形状の中心が地表より下なら三角形と交差していなくても衝突
+            if (kind_ == Kind::HeightField){
+                result = Or(result, Below(part.center, part.max.y - part.center.y));
+                if (result == Verdict::Hit) return result;
+            }
+            for (const Convex& triangle : parts_){
+                if (Separated(triangle.min, triangle.max, part.min, part.max)) continue;
+                result = Or(result, FromGap(Gap(triangle, part)));
+                if (result == Verdict::Hit) return result;
+            }
+        }
+        return result;
+    }
+}
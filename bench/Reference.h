@@ -0,0 +1,159 @@
+#pragma once
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "Collision/Collider.h"
+
+namespace Bench{
+    // 丸め誤差を見込んで、判定がどちらにもなりうるとみなす境界からの距離
+    // (ライブラリの float の誤差・凸包のマージン・GJK の接触距離を含む)
+    constexpr double kReferenceTolerance = 1e-3;
+
+    // 境界付近の結果を区別した判定結果 (大小の順に並べ、和集合は大きい方を取る)
+    enum class Verdict{
+        Miss,
+        // 境界から kReferenceTolerance 以内で、どちらの結果も正しい
+        Either,
+        Hit
+    };
+
+    // 倍精度のベクトル (ライブラリの float の計算とは独立に求める)
+    struct Vector{
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+
+        Vector operator+(const Vector& other) const { return {x + other.x, y + other.y, z + other.z}; }
+        Vector operator-(const Vector& other) const { return {x - other.x, y - other.y, z - other.z}; }
+        Vector operator*(double scale) const { return {x * scale, y * scale, z * scale}; }
+        double Dot(const Vector& other) const { return x * other.x + y * other.y + z * other.z; }
+        Vector Cross(const Vector& other) const { return {y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x}; }
+        double Length() const { return std::sqrt(Dot(*this)); }
+
+        static Vector Of(const Collision::Vec3& v) { return {v.x, v.y, v.z}; }
+    };
+
+    /// @brief
+    /// 検証用の形状
+    /// ライブラリの狭域判定を通さず、点の凸包を半径だけ膨らませた凸形状の和集合として表し、
+    /// GJK の距離と分離軸の重なりだけで判定する。複合形状は子ごと、メッシュと地形は三角形ごとの凸形状を持つ。
+    ///
+    /// 地形は地表より下を中身とし、その深さはブロードフェーズの境界 (Bounds::Of) と同じく水平方向の広さまでとする。
+    /// それより深い位置はライブラリがブロードフェーズで拾うかどうかが形状の大きさで変わるため Either とする。
+    class ReferenceShape{
+    public:
+        enum class Kind{
+            // 中身の詰まった凸形状の和集合
+            Solid,
+            // 面のみで体積を持たない三角形の集合
+            Mesh,
+            // 地表より下が詰まった三角形の集合
+            HeightField
+        };
+
+        // 点の凸包を radius だけ膨らませた凸形状
+        struct Convex{
+            std::vector<Vector> points;
+            double radius = 0.0;
+            // 地形の判定に使う中心 (球・カプセル・ボックスの中心, 凸包は頂点の境界の中心)
+            Vector center;
+            // 分離軸の候補 (面の法線と辺の向き, 正規化済み)
+            std::vector<Vector> normals;
+            std::vector<Vector> edges;
+            // 外接AABB (radius を含む)
+            Vector min;
+            Vector max;
+        };
+
+    private:
+        Kind kind_ = Kind::Solid;
+        std::vector<Convex> parts_;
+        // 地形の格子 (ワールド座標の原点, サンプル数, 間隔, 行優先の高さ)
+        Vector origin_;
+        uint32_t width_ = 0;
+        uint32_t depth_ = 0;
+        double cellSize_ = 0.0;
+        std::vector<double> heights_;
+        // 地形の中身の下端
+        double bottom_ = 0.0;
+        // 外接AABB (地形は中身の下端まで)
+        Vector min_;
+        Vector max_;
+
+    public:
+        /**
+         * コライダーの形状を作ります (Collider.h の Type と大きさの説明のとおりに解釈します)。
+         * @param collider 対象のコライダー (Type::None と Type::Ray は空の形状)
+         */
+        static ReferenceShape Of(const Collision::Collider* collider);
+        static ReferenceShape Sphere(const Vector& center, double radius);
+        static ReferenceShape Box(const Vector& min, const Vector& max);
+        /// 頂点の凸包 (QueryPlanes の領域など)
+        static ReferenceShape Polytope(std::span<const Vector> vertices);
+
+        Kind GetKind() const;
+        const Vector& GetMin() const;
+        const Vector& GetMax() const;
+
+        /**
+         * 形状同士の重なりを判定します。メッシュと地形の組は常に Miss です。
+         * @param other 相手の形状
+         * @return 判定結果
+         */
+        Verdict Overlaps(const ReferenceShape& other) const;
+
+        /**
+         * 点を含むかを判定します (QueryPoint と同じくメッシュは常に Miss)。
+         * @param point 判定する点
+         * @return 判定結果
+         */
+        Verdict Contains(const Vector& point) const;
+
+        // 距離の範囲 (境界付近で結果が決まらない場合は幅を持つ)
+        struct Range{
+            double min;
+            double max;
+        };
+
+        /**
+         * 点から形状までの距離を求めます (中身の内部なら0)。
+         * @param point 基準点
+         * @return 距離の範囲
+         */
+        Range Distance(const Vector& point) const;
+
+        // レイが当たる距離の範囲 (無ければ無限大)
+        struct RayRange{
+            // 形状に許容誤差まで近づく最初の距離 (これより手前で当たってはいけない)
+            double touch;
+            // 確実に当たる最初の距離 (これより奥で当たってはいけない)
+            double enter;
+        };
+
+        /**
+         * レイと形状を判定します。中身のある形状は原点が内部なら距離0、メッシュと地形は三角形との交点のみを返す前提です。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param length レイの長さ
+         * @return 当たる距離の範囲
+         */
+        RayRange RayCast(const Vector& origin, const Vector& direction, double length) const;
+
+        /**
+         * 点が形状の表面 (中身のある形状は内部も含む) から許容誤差以内にあるかを判定します (レイの交点の確認用)。
+         * @param point 判定する点
+         * @return 許容誤差以内ならtrue
+         */
+        bool Touches(const Vector& point) const;
+
+    private:
+        void AddPart(std::vector<Vector> points, double radius, const Vector& center);
+        void AddTriangle(const Vector& a, const Vector& b, const Vector& c);
+        void UpdateBounds();
+        // 地形の中身 (中心が地表より下にある) の判定 (extent は中心から形状の上端までの高さ, 複合形状は子ごと)
+        Verdict Below(const Vector& point, double extent) const;
+        // 相手が中身のある形状の場合の、三角形の集合との判定
+        Verdict OverlapsSurface(const ReferenceShape& solid) const;
+    };
+}
@@ -0,0 +1,160 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+using namespace Collision;
+
+namespace Bench{
+    namespace{
+        // 物体1つあたりの空間の一辺 (密度を数によらず一定に保つ)
+        constexpr float kSpacing = 4.f;
+        // 塊1つあたりの物体の数
+        constexpr size_t kClusterSize = 2000;
+
+        Vec3 UniformPoint(Random& random, float extent) {
+            return {random.Uniform(-extent, extent), random.Uniform(-extent, extent), random.Uniform(-extent, extent)};
+        }
+
+        Vec3 RandomVelocity(Random& random) {
+            return {random.Uniform(-5.f, 5.f), random.Uniform(-5.f, 5.f), random.Uniform(-5.f, 5.f)};
+        }
+
+        // 中心付近に集まる [-1, 1] の乱数 (一様乱数3つの平均)
+        float Bell(Random& random) {
+            return (random.Uniform(-1.f, 1.f) + random.Uniform(-1.f, 1.f) + random.Uniform(-1.f, 1.f)) / 3.f;
+        }
+
+        // 大きさ scale の形状を種類に応じて作る
+        void SetShape(Body& body, Type type, float scale, Random& random) {
+            body.type = type;
+            switch (type){
+            case Type::Sphere:
+                body.size = scale * 0.5f;
+                break;
+            case Type::Capsule:
+                body.size = CapsuleSize {scale * 0.25f, scale * 0.5f};
+                body.rotate = {random.Uniform(0.f, std::numbers::pi_v<float>), random.Uniform(0.f, std::numbers::pi_v<float>), 0.f};
+                break;
+            case Type::OBB:
+                body.rotate = {random.Uniform(0.f, std::numbers::pi_v<float>), random.Uniform(0.f, std::numbers::pi_v<float>), 0.f};
+                [[fallthrough]];
+            default:
+                body.size = Vec3(random.Uniform(0.5f, 1.f), random.Uniform(0.5f, 1.f), random.Uniform(0.5f, 1.f)) * scale;
+                break;
+            }
+        }
+
+        void SetFilter(Body& body, Random& random) {
+            body.attribute = 1u << random.Below(4);
+            body.ignore = random.Chance(0.25f) ? 1u << random.Below(4) : 0u;
+        }
+    }
+
+    uint64_t Random::Next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float Random::Uniform(float min, float max) {
+        // 上位24ビットから [0, 1) を作る
+        const float t = static_cast<float>(Next() >> 40) * (1.f / 16777216.f);
+        return min + (max - min) * t;
+    }
+
+    uint32_t Random::Below(uint32_t count) {
+        return static_cast<uint32_t>(((Next() >> 32) * count) >> 32);
+    }
+
+    bool Random::Chance(float probability) {
+        return Uniform(0.f, 1.f) < probability;
+    }
+
+    Scene GenerateScene(SceneKind kind, size_t count, uint64_t seed) {
+        Random random(seed ^ (static_cast<uint64_t>(kind) << 56));
+        Scene scene;
+        scene.extent = 0.5f * std::cbrt(static_cast<float>(std::max<size_t>(count, 1))) * kSpacing;
+        scene.bodies.resize(count);
+
+        std::vector<Vec3> clusters;
+        if (kind == SceneKind::Clustered){
+            clusters.resize(std::max<size_t>(4, count / kClusterSize));
+            for (auto& center : clusters) center = UniformPoint(random, scene.extent * 0.8f);
+        }
+        // 塊の広がり (塊の中は一様なシーンのおよそ8倍の密度)
+        const float clusterRadius = std::cbrt(static_cast<float>(kClusterSize)) * kSpacing * 0.25f;
+
+        for (uint32_t i = 0; i < count; ++i){
+            Body& body = scene.bodies[i];
+            switch (kind){
+            case SceneKind::Clustered:{
+                const Vec3& center = clusters[random.Below(static_cast<uint32_t>(clusters.size()))];
+                body.translate = center + Vec3(Bell(random), Bell(random), Bell(random)) * clusterRadius;
+                SetShape(body, random.Chance(0.5f) ? Type::Sphere : Type::AABB, random.Uniform(1.f, 2.f), random);
+                break;
+            }
+            case SceneKind::MixedSize:{
+                constexpr Type kTypes[] = {Type::Sphere, Type::AABB, Type::OBB, Type::Capsule};
+                body.translate = UniformPoint(random, scene.extent);
+                // 0.1 から 20 の対数一様
+                const float scale = std::exp(random.Uniform(std::log(0.1f), std::log(20.f)));
+                SetShape(body, kTypes[random.Below(4)], scale, random);
+                break;
+            }
+            default:
+                body.translate = UniformPoint(random, scene.extent);
+                SetShape(body, random.Chance(0.5f) ? Type::Sphere : Type::AABB, random.Uniform(1.f, 3.f), random);
+                break;
+            }
+            SetFilter(body, random);
+
+            const bool moves = kind != SceneKind::MostlyStatic || random.Chance(0.05f);
+            if (moves){
+                body.velocity = RandomVelocity(random);
+                scene.dynamic.push_back(i);
+            }
+        }
+        return scene;
+    }
+
+    void StepScene(Scene& scene, float deltaTime) {
+        const float extent = scene.extent;
+        auto bounce = [extent](float& position, float& velocity){
+            if (position < -extent || extent < position){
+                position = std::clamp(position, -extent, extent);
+                velocity = -velocity;
+            }
+        };
+
+        for (const uint32_t i : scene.dynamic){
+            Body& body = scene.bodies[i];
+            body.translate += body.velocity * deltaTime;
+            bounce(body.translate.x, body.velocity.x);
+            bounce(body.translate.y, body.velocity.y);
+            bounce(body.translate.z, body.velocity.z);
+        }
+    }
+
+    const char* ToString(SceneKind kind) {
+        switch (kind){
+        case SceneKind::Uniform: return "uniform";
+        case SceneKind::Clustered: return "clustered";
+        case SceneKind::MixedSize: return "mixed";
+        case SceneKind::MostlyStatic: return "static";
+        }
+        return "unknown";
+    }
+
+    bool Parse(std::string_view text, SceneKind& kind) {
+        for (const SceneKind candidate : {SceneKind::Uniform, SceneKind::Clustered, SceneKind::MixedSize, SceneKind::MostlyStatic}){
+            if (text == ToString(candidate)){
+                kind = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+}
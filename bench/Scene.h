@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Collision/Collider.h"
+
+namespace Bench{
+    // 計測用シーンの種類
+    enum class SceneKind{
+        // 一様な密度に散らばった小さな物体 (すべて動く)
+        Uniform,
+        // 少数の塊に密集した物体
+        Clustered,
+        // 大きさが 0.1 から 20 まで対数一様にばらつく物体
+        MixedSize,
+        // ほとんどが静止した物体 (動くのは 5%)
+        MostlyStatic
+    };
+
+    /// @brief
+    /// 種から決まる乱数 (SplitMix64)
+    /// 標準の分布は実装ごとに結果が異なるため、どの環境でも同じシーンになるよう自前で変換する
+    class Random{
+        uint64_t state_;
+
+    public:
+        explicit Random(uint64_t seed) :state_(seed) {
+        }
+
+        uint64_t Next();
+        /// [min, max) の一様乱数
+        float Uniform(float min, float max);
+        /// [0, count) の整数
+        uint32_t Below(uint32_t count);
+        /// 確率 probability で true
+        bool Chance(float probability);
+    };
+
+    struct Body{
+        Collision::Type type;
+        Collision::Collider::Size size;
+        Collision::Vec3 translate;
+        Collision::Vec3 rotate;
+        // 静止している物体はゼロ
+        Collision::Vec3 velocity;
+        uint32_t attribute = 0;
+        uint32_t ignore = 0;
+    };
+
+    struct Scene{
+        std::vector<Body> bodies;
+        // 動く物体の番号
+        std::vector<uint32_t> dynamic;
+        // 世界の半分の大きさ (物体は [-extent, extent] に収まる)
+        float extent = 0.f;
+    };
+
+    /**
+     * シーンを生成します。同じ引数からは常に同じシーンが生成されます。
+     * @param kind シーンの種類
+     * @param count 物体の数
+     * @param seed 乱数の種
+     * @return 生成したシーン
+     */
+    Scene GenerateScene(SceneKind kind, size_t count, uint64_t seed);
+
+    /**
+     * 動く物体を進め、世界の端で跳ね返します。
+     * @param scene 対象のシーン
+     * @param deltaTime 経過時間
+     */
+    void StepScene(Scene& scene, float deltaTime);
+
+    const char* ToString(SceneKind kind);
+    bool Parse(std::string_view text, SceneKind& kind);
+}
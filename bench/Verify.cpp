@@ -0,0 +1,935 @@
+#include "Verify.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <thread>
+#include <unordered_map>
+
+#include "Collision/CompoundShape.h"
+#include "Collision/ConvexHull.h"
+#include "Collision/HeightField.h"
+#include "Collision/Snapshot.h"
+#include "Collision/TriangleMesh.h"
+#include "Collision/WorkerPool.h"
+#include "Collision/WorldStreamer.h"
+#include "src/Collision/OrientedBox.h"
+
+#include "Reference.h"
+#include "Scene.h"
+
+using namespace Collision;
+
+namespace Bench{
+    namespace{
+        constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+        // Manager::Filter と同じ条件 (無効なコライダーは呼び出し側で除く)
+        bool Filter(const Data& data, const Data& other) {
+            if (data.id == other.id) return false;
+            if (data.type == Type::None || other.type == Type::None) return false;
+            if (data.attribute & other.ignore || data.ignore & other.attribute) return false;
+            return true;
+        }
+
+        PairIds MakePair(uint64_t a, uint64_t b) {
+            return a < b ? PairIds {a, b} : PairIds {b, a};
+        }
+
+        ReferencePairSet PairsOf(std::span<Collider* const> colliders, std::span<const ReferenceShape> shapes) {
+            ReferencePairSet pairs;
+            for (size_t i = 0; i < colliders.size(); ++i){
+                const Collider* c1 = colliders[i];
+                if (!c1->IsEnabled()) continue;
+                for (size_t j = i + 1; j < colliders.size(); ++j){
+                    const Collider* c2 = colliders[j];
+                    if (!c2->IsEnabled() || !Filter(c1->GetData(), c2->GetData())) continue;
+                    switch (shapes[i].Overlaps(shapes[j])){
+                    case Verdict::Hit:
+                        pairs.hits.push_back(MakePair(c1->GetId(), c2->GetId()));
+                        break;
+                    case Verdict::Either:
+                        pairs.boundaries.push_back(MakePair(c1->GetId(), c2->GetId()));
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+            std::ranges::sort(pairs.hits);
+            std::ranges::sort(pairs.boundaries);
+            return pairs;
+        }
+
+        bool Contains(const std::vector<PairIds>& pairs, const PairIds& ids) {
+            return std::ranges::binary_search(pairs, ids);
+        }
+
+        struct ExpectedEvent{
+            EventType type;
+            PairIds ids;
+
+            auto operator<=>(const ExpectedEvent&) const = default;
+        };
+
+        // コールバックモードで受け取ったイベント (受け取ったコライダーと相手)
+        struct ReceivedEvent{
+            EventType type;
+            uint64_t self;
+            uint64_t other;
+
+            auto operator<=>(const ReceivedEvent&) const = default;
+        };
+
+        // 検証用シーンの作り方
+        struct CaseStyle{
+            // 0.5 刻みの格子に置き、境界がちょうど接する配置を作る
+            bool lattice;
+            float extent;
+            bool generateContacts;
+            // コールバックモードで購読したイベントだけを受け取る
+            bool callback;
+            // 球・ボックス・カプセルの大きさの倍率 (中心が遠く離れていても重なる組を作る)
+            float scale;
+        };
+
+        Vec3 RandomDirection(Random& random) {
+            Vec3 direction(random.Uniform(-1.f, 1.f), random.Uniform(-1.f, 1.f), random.Uniform(-1.f, 1.f));
+            if (direction.Length() < 1e-3f) direction = Vec3(1.f, 0.f, 0.f);
+            direction.Normalize();
+            return direction;
+        }
+
+        class Verifier{
+            Manager& manager_;
+            const VerifyOptions& options_;
+            std::array<std::shared_ptr<const ConvexHull>, 2> hulls_;
+            std::array<std::shared_ptr<const TriangleMesh>, 2> meshes_;
+            std::array<std::shared_ptr<const HeightField>, 2> fields_;
+            std::array<std::shared_ptr<const CompoundShape>, 2> compounds_;
+            std::vector<ReceivedEvent> received_;
+            size_t mismatches_ = 0;
+            size_t pairsChecked_ = 0;
+            size_t raysChecked_ = 0;
+            size_t queriesChecked_ = 0;
+            size_t boxesChecked_ = 0;
+
+        public:
+            Verifier(Manager& manager, const VerifyOptions& options) :manager_(manager), options_(options) {
+                const std::array<Vec3, 8> cube {
+                    Vec3(-0.5f, -0.5f, -0.5f), Vec3(0.5f, -0.5f, -0.5f), Vec3(-0.5f, 0.5f, -0.5f), Vec3(0.5f, 0.5f, -0.5f),
+                    Vec3(-0.5f, -0.5f, 0.5f), Vec3(0.5f, -0.5f, 0.5f), Vec3(-0.5f, 0.5f, 0.5f), Vec3(0.5f, 0.5f, 0.5f)
+                };
+                const std::array<Vec3, 4> tetrahedron {Vec3(0.f, 0.8f, 0.f), Vec3(-0.6f, -0.4f, -0.4f), Vec3(0.6f, -0.4f, -0.4f), Vec3(0.f, -0.4f, 0.7f)};
+                hulls_ = {std::make_shared<const ConvexHull>(cube), std::make_shared<const ConvexHull>(tetrahedron)};
+
+                // 閉じた箱の表面と、起伏のある格子状の面
+                const std::array<uint32_t, 36> boxIndices {
+                    0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                    2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5
+                };
+                Random random(options.seed);
+                std::vector<Vec3> patch;
+                std::vector<uint32_t> patchIndices;
+                constexpr uint32_t kPatch = 5;
+                for (uint32_t z = 0; z < kPatch; ++z){
+                    for (uint32_t x = 0; x < kPatch; ++x){
+                        patch.emplace_back(x * 0.5f - 1.f, random.Uniform(-0.2f, 0.2f), z * 0.5f - 1.f);
+                    }
+                }
+                for (uint32_t z = 0; z + 1 < kPatch; ++z){
+                    for (uint32_t x = 0; x + 1 < kPatch; ++x){
+                        const uint32_t v = z * kPatch + x;
+                        patchIndices.insert(patchIndices.end(), {v, v + kPatch, v + 1, v + 1, v + kPatch, v + kPatch + 1});
+                    }
+                }
+                meshes_ = {std::make_shared<const TriangleMesh>(cube, boxIndices), std::make_shared<const TriangleMesh>(patch, patchIndices)};
+
+                // 正方形と長方形の地形
+                auto field = [&random](uint32_t width, uint32_t depth, float cellSize, float heightScale, float heightOffset, uint32_t range){
+                    std::vector<uint16_t> heights(static_cast<size_t>(width) * depth);
+                    for (uint16_t& height : heights) height = static_cast<uint16_t>(random.Below(range));
+                    return std::make_shared<const HeightField>(width, depth, cellSize, heightScale, heightOffset, heights);
+                };
+                fields_ = {field(6, 6, 0.5f, 0.002f, -0.3f, 300), field(4, 5, 1.f, 0.01f, 0.f, 100)};
+
+                // 球とAABBを組み合わせた形状
+                const std::array<CompoundShape::Child, 3> dumbbell {{
+                    {Vec3(-0.6f, 0.f, 0.f), 0.4f}, {Vec3(0.6f, 0.f, 0.f), 0.4f}, {Vec3(0.f, 0.5f, 0.f), Vec3(0.5f, 0.3f, 0.5f)}
+                }};
+                const std::array<CompoundShape::Child, 3> table {{
+                    {Vec3(0.f, 0.f, 0.f), Vec3(1.f, 0.2f, 1.f)}, {Vec3(0.f, -0.6f, 0.f), Vec3(0.2f, 1.f, 0.2f)}, {Vec3(0.5f, 0.5f, 0.5f), 0.25f}
+                }};
+                compounds_ = {std::make_shared<const CompoundShape>(dumbbell), std::make_shared<const CompoundShape>(table)};
+            }
+
+            void Run() {
+                const Manager::EventMode previousMode = manager_.GetEventMode();
+
+                for (size_t s = 0; s < options_.scenes; ++s){
+                    RunCase(s);
+                }
+                CheckMeshInput();
+                RunWorlds();
+                RunStreaming();
+
+                manager_.SetEventMode(previousMode);
+                manager_.SetThreadCount(0);
+                manager_.SetGenerateContacts(false);
+                std::printf("verify: scenes=%zu pairs=%zu rays=%zu queries=%zu boxes=%zu mismatches=%zu\n",
+                            options_.scenes, pairsChecked_, raysChecked_, queriesChecked_, boxesChecked_, mismatches_);
+            }
+
+            size_t GetMismatchCount() const {
+                return mismatches_;
+            }
+
+        private:
+            void RunCase(size_t index) {
+                Random random(options_.seed * 0x9E3779B97F4A7C15ull + index);
+                constexpr float kExtents[] = {4.f, 20.f, 150.f};
+                const bool lattice = random.Chance(0.4f);
+                const bool large = !lattice && random.Chance(0.1f);
+                const CaseStyle style {lattice, large ? 400.f : kExtents[random.Below(3)], random.Chance(0.5f), random.Chance(0.5f), large ? 100.f : 1.f};
+                const uint32_t count = 1 + random.Below(options_.maxColliders);
+
+                // ストリームは全ペアのイベントを、コールバックは購読の絞り込みと受け取る側を確かめる
+                manager_.SetEventMode(style.callback ? Manager::EventMode::Callback : Manager::EventMode::Stream);
+
+                std::vector<Collider*> colliders(count);
+                manager_.CreateColliders(colliders);
+                for (Collider* collider : colliders){
+                    Setup(collider, style, random);
+                }
+                manager_.SetGenerateContacts(style.generateContacts);
+
+                ReferencePairSet previous;
+                std::vector<PairIds> previousActual;
+                constexpr int kFrames = 3;
+                for (int frame = 0; frame < kFrames; ++frame){
+                    if (frame == 1) MoveBatch(colliders, style, random);
+                    if (frame == 2) MoveEach(colliders, style, random);
+
+                    // 1スレッドとすべてのワーカーを交互に使う
+                    manager_.SetThreadCount((index + frame) % 2 ? 1 : 0);
+                    received_.clear();
+                    manager_.Detect();
+                    manager_.ProcessEvent();
+
+                    std::vector<ReferenceShape> shapes;
+                    shapes.reserve(colliders.size());
+                    for (const Collider* collider : colliders) shapes.push_back(ReferenceShape::Of(collider));
+
+                    ReferencePairSet current = PairsOf(colliders, shapes);
+                    if (style.callback) CheckCallbacks(index, frame, colliders, previous, current);
+                    else CheckEvents(index, frame, manager_, colliders, current, previousActual);
+                    CheckRays(index, frame, colliders, shapes, style, random);
+                    CheckQueries(index, frame, colliders, shapes, style, random);
+                    previous = std::move(current);
+                }
+                CheckBoxes(index, style, random);
+
+                manager_.DestroyColliders(colliders);
+                // 解除を反映して次のシーンに前回のペアを持ち越さない
+                manager_.Detect();
+                manager_.ProcessEvent();
+                received_.clear();
+            }
+
+            // 頂点番号が3の倍数個でないか頂点の範囲外を指すメッシュは、三角形を持たない空のメッシュになるか
+            void CheckMeshInput() {
+                const std::span<const Vec3> vertices = meshes_[0]->GetPrebuilt().vertices;
+                const uint32_t outside = static_cast<uint32_t>(vertices.size());
+                const std::array<std::vector<uint32_t>, 3> invalid {std::vector<uint32_t> {0, 1}, std::vector<uint32_t> {0, 1, 2, 3}, std::vector<uint32_t> {0, 1, 2, 2, 1, outside}};
+                for (const auto& indices : invalid){
+                    const TriangleMesh mesh(vertices, indices);
+                    if ((TriangleMesh::IsValid(vertices, indices) || mesh.GetTriangleCount() != 0) && CountMismatch()){
+                        std::printf("mismatch TriangleMesh accepted %zu invalid indices\n", indices.size());
+                    }
+                }
+                const std::array<uint32_t, 3> valid {0, 1, outside - 1};
+                if ((!TriangleMesh::IsValid(vertices, valid) || TriangleMesh(vertices, valid).GetTriangleCount() != 1) && CountMismatch()){
+                    std::printf("mismatch TriangleMesh rejected valid indices\n");
+                }
+            }
+
+            /**
+             * 共有プールを使う2つのワールドで Detect を同時に走らせ、それぞれの結果が自分のコライダーだけの総当たりと合うか確かめます。
+             * 相手のワールドのコライダーを含むイベントは総当たりにないので不一致になります。
+             * 番号は通常のシーンの続きで数えます。
+             */
+            void RunWorlds() {
+                constexpr size_t kRounds = 20;
+                constexpr int kFrames = 3;
+                const std::shared_ptr<WorkerPool> pool = WorkerPool::GetShared();
+                std::array<std::unique_ptr<Manager>, 2> worlds {std::make_unique<Manager>(pool), std::make_unique<Manager>(pool)};
+
+                for (size_t round = 0; round < kRounds; ++round){
+                    const size_t index = options_.scenes + round;
+                    Random random(options_.seed * 0x9E3779B97F4A7C15ull + index);
+                    const CaseStyle style {false, 20.f, random.Chance(0.5f), false, 1.f};
+
+                    std::array<std::vector<Collider*>, 2> colliders;
+                    std::array<std::vector<PairIds>, 2> previousActual;
+                    for (size_t w = 0; w < worlds.size(); ++w){
+                        // 同じ範囲に置き、別のワールドなら重なっていても衝突しないことを確かめる
+                        colliders[w].resize(1 + random.Below(options_.maxColliders));
+                        worlds[w]->CreateColliders(colliders[w]);
+                        for (Collider* collider : colliders[w]) Setup(collider, style, random);
+                        worlds[w]->SetEventMode(Manager::EventMode::Stream);
+                        worlds[w]->SetGenerateContacts(style.generateContacts);
+                    }
+
+                    for (int frame = 0; frame < kFrames; ++frame){
+                        if (frame > 0){
+                            for (const auto& list : colliders) MoveEach(list, style, random);
+                        }
+
+                        // もう1つのワールドは別のスレッドから同時に判定する
+                        std::thread other([&worlds](){
+                            worlds[1]->Detect();
+                            worlds[1]->ProcessEvent();
+                        });
+                        worlds[0]->Detect();
+                        worlds[0]->ProcessEvent();
+                        other.join();
+
+                        for (size_t w = 0; w < worlds.size(); ++w){
+                            CheckEvents(index, frame, *worlds[w], colliders[w], ReferencePairs(colliders[w]), previousActual[w]);
+                        }
+                    }
+
+                    for (size_t w = 0; w < worlds.size(); ++w){
+                        worlds[w]->DestroyColliders(colliders[w]);
+                        worlds[w]->Detect();
+                        worlds[w]->ProcessEvent();
+                    }
+                }
+            }
+
+            /**
+             * 2つのセルのスナップショットを書き出し、注目点を動かしながら WorldStreamer のセルの状態と登録されたコライダー数を確かめます。
+             * 読み込みと破棄の半径の間・1回の登録数の上限・開けないファイル (Failed)・読み込みスレッドでの準備 (Preparing) を通ります。
+             */
+            void RunStreaming() {
+                using CellState = WorldStreamer::CellState;
+                const std::filesystem::path directory = std::filesystem::temp_directory_path();
+                const std::array<std::string, 2> paths {(directory / "collision_verify_cell0.snap").string(), (directory / "collision_verify_cell1.snap").string()};
+                constexpr float kCellSize = 10.f;
+                Random random(options_.seed);
+
+                // セルの範囲に球と箱を置いたスナップショット (すべて有効)
+                const std::shared_ptr<WorkerPool> pool = WorkerPool::GetShared();
+                std::array<size_t, 2> counts {};
+                {
+                    Manager source(pool);
+                    for (size_t c = 0; c < paths.size(); ++c){
+                        std::vector<Collider*> colliders(1 + random.Below(20));
+                        source.CreateColliders(colliders);
+                        for (Collider* collider : colliders){
+                            const Vec3 offset(random.Uniform(0.f, kCellSize), random.Uniform(0.f, kCellSize), random.Uniform(0.f, kCellSize));
+                            collider->SetType(random.Chance(0.5f) ? Type::Sphere : Type::AABB)->SetTranslate(Vec3(kCellSize * c, 0.f, 0.f) + offset);
+                            if (collider->GetType() == Type::Sphere) collider->SetSize(random.Uniform(0.2f, 2.f));
+                            else collider->SetSize(Vec3(random.Uniform(0.2f, 2.f), random.Uniform(0.2f, 2.f), random.Uniform(0.2f, 2.f)));
+                            collider->Enable();
+                        }
+                        counts[c] = colliders.size();
+                        if (!SnapshotWriter(colliders).Write(paths[c]) && CountMismatch()) std::printf("mismatch streaming failed to write %s\n", paths[c].c_str());
+                        source.DestroyColliders(colliders);
+                    }
+                }
+
+                Manager world(pool);
+                std::vector<Collider*> out(64);
+                // 直近の Detect で登録されたコライダーの数
+                auto registered = [&](){
+                    world.Detect();
+                    world.ProcessEvent();
+                    return world.QueryAABB(Vec3(0.f, 0.f, 0.f), Vec3(1e6f, 1e6f, 1e6f), out);
+                };
+                int step = 0;
+                auto expect = [&](bool ok, const char* what){
+                    if (!ok && CountMismatch()) std::printf("mismatch streaming step=%d %s\n", step, what);
+                };
+
+                // A と B はファイルあり、F は存在しないファイル
+                const Vec3i a(0, 0, 0), b(1, 0, 0), f(-1, 0, 0);
+                {
+                    WorldStreamer streamer(world, {.cellSize = kCellSize, .loadRadius = 1, .unloadRadius = 2, .maxActivationsPerUpdate = 1});
+                    expect(streamer.AddCell(a, paths[0]) && streamer.AddCell(b, paths[1]) && streamer.AddCell(f, (directory / "collision_verify_missing.snap").string()), "AddCell");
+                    // 読み込みスレッドの準備が終わるまで待つ
+                    auto settle = [&](){
+                        for (int i = 0; i < 5000; ++i){
+                            if (streamer.GetState(a) != CellState::Preparing && streamer.GetState(b) != CellState::Preparing && streamer.GetState(f) != CellState::Preparing) return;
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        expect(false, "loader did not finish");
+                    };
+                    auto update = [&](const Vec3& point){
+                        ++step;
+                        streamer.Update(std::span(&point, 1));
+                    };
+                    auto pending = [](CellState state){ return state == CellState::Preparing || state == CellState::Prepared; };
+
+                    // 最初の Update は準備を依頼するだけで、同じ Update では登録しない
+                    update(Vec3(5.f, 5.f, 5.f));
+                    expect(streamer.CellOf(Vec3(5.f, 5.f, 5.f)) == a && streamer.CellOf(Vec3(-0.5f, 5.f, 5.f)) == f, "CellOf");
+                    expect(pending(streamer.GetState(a)) && pending(streamer.GetState(b)), "cells are not being prepared");
+                    expect(streamer.GetState(f) == CellState::Preparing || streamer.GetState(f) == CellState::Failed, "missing file is not being prepared");
+                    expect(streamer.GetActiveCellCount() == 0 && registered() == 0, "registered before prepared");
+                    settle();
+                    expect(streamer.GetState(a) == CellState::Prepared && streamer.GetState(b) == CellState::Prepared, "cells are not prepared");
+                    expect(streamer.GetState(f) == CellState::Failed, "missing file did not fail");
+
+                    // 1回に1セルずつ登録する (座標の小さい A から)
+                    update(Vec3(5.f, 5.f, 5.f));
+                    expect(streamer.GetState(a) == CellState::Active && streamer.GetState(b) == CellState::Prepared, "maxActivationsPerUpdate");
+                    expect(streamer.GetColliders(a).size() == counts[0] && streamer.GetColliders(b).empty() && registered() == counts[0], "registered count after A");
+                    update(Vec3(5.f, 5.f, 5.f));
+                    expect(streamer.GetState(b) == CellState::Active && streamer.GetActiveCellCount() == 2, "B is not active");
+                    expect(streamer.GetColliders(b).size() == counts[1] && registered() == counts[0] + counts[1], "registered count after B");
+
+                    // 境界を越えて A が読み込み半径の外へ出ても、破棄半径の内側なら残す
+                    update(Vec3(25.f, 5.f, 5.f));
+                    expect(streamer.GetState(a) == CellState::Active && streamer.GetState(b) == CellState::Active, "hysteresis");
+                    expect(registered() == counts[0] + counts[1], "registered count inside the unload radius");
+
+                    // 破棄半径を越えたら A だけを解除する
+                    update(Vec3(35.f, 5.f, 5.f));
+                    expect(streamer.GetState(a) == CellState::Unloaded && streamer.GetState(b) == CellState::Active, "A is not unloaded");
+                    expect(streamer.GetColliders(a).empty() && registered() == counts[1], "registered count after unloading A");
+
+                    // 戻ると A を読み込み直し、開けなかった F は再試行しない
+                    update(Vec3(5.f, 5.f, 5.f));
+                    settle();
+                    update(Vec3(5.f, 5.f, 5.f));
+                    expect(streamer.GetState(a) == CellState::Active && streamer.GetState(f) == CellState::Failed, "reload");
+                    expect(registered() == counts[0] + counts[1], "registered count after reloading A");
+
+                    // 割り当て直すと F も読み込む
+                    expect(streamer.AddCell(f, paths[0]) && streamer.GetState(f) == CellState::Unloaded, "AddCell after failure");
+                    update(Vec3(5.f, 5.f, 5.f));
+                    settle();
+                    update(Vec3(5.f, 5.f, 5.f));
+                    expect(streamer.GetState(f) == CellState::Active && streamer.GetActiveCellCount() == 3, "F is not active");
+                    expect(registered() == counts[0] * 2 + counts[1], "registered count after F");
+                }
+                // 破棄するとすべてのセルのコライダーを解除する
+                ++step;
+                expect(registered() == 0, "colliders left after destroying the streamer");
+
+                for (const std::string& path : paths) std::filesystem::remove(path);
+            }
+
+            void Setup(Collider* collider, const CaseStyle& style, Random& random) {
+                constexpr Type kTypes[] = {Type::Sphere, Type::AABB, Type::OBB, Type::Capsule, Type::ConvexHull, Type::Compound, Type::Mesh, Type::HeightField};
+                const Type type = random.Chance(0.05f) ? Type::None : kTypes[random.Below(8)];
+                // 大きさゼロの形状も混ぜる
+                const float scale = random.Chance(0.05f) ? 0.f : style.lattice ? 1.f : random.Uniform(0.2f, 3.f) * style.scale;
+
+                collider->SetType(type)->SetTranslate(RandomPoint(style, random));
+                switch (type){
+                case Type::Sphere:
+                case Type::None:
+                    collider->SetSize(scale * 0.5f);
+                    break;
+                case Type::Capsule:
+                    collider->SetSize(CapsuleSize {scale * 0.25f, scale * 0.5f});
+                    break;
+                case Type::ConvexHull:
+                    collider->SetSize(hulls_[random.Below(2)]);
+                    break;
+                case Type::Compound:
+                    collider->SetSize(compounds_[random.Below(2)]);
+                    break;
+                case Type::Mesh:
+                    collider->SetSize(meshes_[random.Below(2)]);
+                    break;
+                case Type::HeightField:
+                    collider->SetSize(fields_[random.Below(2)]);
+                    break;
+                default:
+                    collider->SetSize(style.lattice ? Vec3(scale, scale, scale) : Vec3(random.Uniform(0.f, 1.f), random.Uniform(0.f, 1.f), random.Uniform(0.f, 1.f)) * scale);
+                    break;
+                }
+                // 回転は OBB・カプセル・凸包以外では無視されるはずなので、すべての形状に設定する
+                // 格子では回転なしか直角の回転にして接触を保つ
+                const float step = std::numbers::pi_v<float> * 0.5f;
+                collider->SetRotate(style.lattice
+                                    ? Vec3(step * random.Below(4), step * random.Below(4), 0.f)
+                                    : Vec3(random.Uniform(0.f, 6.3f), random.Uniform(0.f, 6.3f), random.Uniform(0.f, 6.3f)));
+
+                if (random.Chance(0.5f)) collider->AddAttribute(1u << random.Below(3));
+                if (random.Chance(0.3f)) collider->AddIgnore(1u << random.Below(3));
+                if (random.Chance(0.9f)) collider->Enable();
+
+                // プールから再利用されたコライダーに前のシーンのコールバックを残さない
+                for (const EventType event : {EventType::Trigger, EventType::Stay, EventType::Exit}){
+                    if (style.callback && random.Chance(0.5f)){
+                        collider->SetEvent(event, [this, collider](const Event& e){
+                            received_.push_back({e.GetType(), collider->GetId(), e.GetOther()->GetId()});
+                        });
+                    } else{
+                        collider->SetEvent(event, nullptr);
+                    }
+                }
+            }
+
+            Vec3 RandomPoint(const CaseStyle& style, Random& random) const {
+                if (!style.lattice){
+                    return {random.Uniform(-style.extent, style.extent), random.Uniform(-style.extent, style.extent), random.Uniform(-style.extent, style.extent)};
+                }
+                const uint32_t cells = static_cast<uint32_t>(std::min(style.extent, 6.f) * 2.f) + 1;
+                auto axis = [&](){ return (static_cast<float>(random.Below(cells * 2)) - static_cast<float>(cells)) * 0.5f; };
+                return {axis(), axis(), axis()};
+            }
+
+            // UpdateTransforms でまとめて動かす (ブロードフェーズの境界の更新を通る)
+            void MoveBatch(std::span<Collider* const> colliders, const CaseStyle& style, Random& random) {
+                std::vector<Collider*> moved;
+                std::vector<Vec3> translates;
+                for (Collider* collider : colliders){
+                    if (!random.Chance(0.5f)) continue;
+                    moved.push_back(collider);
+                    translates.push_back(RandomPoint(style, random));
+                }
+                manager_.UpdateTransforms(moved, translates);
+            }
+
+            // 1つずつ動かし、有効・無効と属性も切り替える
+            void MoveEach(std::span<Collider* const> colliders, const CaseStyle& style, Random& random) {
+                for (Collider* collider : colliders){
+                    if (random.Chance(0.3f)) collider->SetTranslate(RandomPoint(style, random));
+                    if (random.Chance(0.1f)){
+                        if (collider->IsEnabled()) collider->Disable();
+                        else collider->Enable();
+                    }
+                    if (random.Chance(0.1f)) collider->AddIgnore(1u << random.Below(3));
+                }
+            }
+
+            // ストリームモード: 衝突中のペアが総当たりの結果と合い、イベントの種類が前回のペアとの差分と合うか
+            void CheckEvents(size_t index, int frame, const Manager& manager, std::span<Collider* const> colliders, const ReferencePairSet& reference,
+                             std::vector<PairIds>& previousActual) {
+                std::vector<ExpectedEvent> actual;
+                std::vector<PairIds> current;
+                for (const auto& event : manager.GetEvents()){
+                    const PairIds ids = MakePair(event.collider->GetId(), event.other->GetId());
+                    actual.push_back({event.type, ids});
+                    if (event.type != EventType::Exit) current.push_back(ids);
+                }
+                std::ranges::sort(current);
+                pairsChecked_ += reference.hits.size() + reference.boundaries.size();
+
+                for (const PairIds& ids : reference.hits){
+                    if (!Contains(current, ids)) ReportPair(index, frame, "missing", EventType::Stay, ids, colliders);
+                }
+                for (const PairIds& ids : current){
+                    if (!Contains(reference.hits, ids) && !Contains(reference.boundaries, ids)) ReportPair(index, frame, "unexpected", EventType::Stay, ids, colliders);
+                }
+
+                // 境界のペアはライブラリの前回の結果に従って Trigger・Stay・Exit が決まる
+                std::vector<ExpectedEvent> expected;
+                for (const PairIds& ids : current){
+                    expected.push_back({Contains(previousActual, ids) ? EventType::Stay : EventType::Trigger, ids});
+                }
+                for (const PairIds& ids : previousActual){
+                    if (!Contains(current, ids)) expected.push_back({EventType::Exit, ids});
+                }
+                CompareEvents(index, frame, expected, actual, colliders);
+                previousActual = std::move(current);
+            }
+
+            // コールバックモード: 購読したコライダーだけが、購読した種類のイベントを受け取るか
+            void CheckCallbacks(size_t index, int frame, std::span<Collider* const> colliders, const ReferencePairSet& previous, const ReferencePairSet& current) {
+                // 前回か今回が境界のペアは、ライブラリがどちらと判定したかで種類が変わるので比べない
+                auto undecided = [&](const PairIds& ids){
+                    return Contains(previous.boundaries, ids) || Contains(current.boundaries, ids);
+                };
+                std::unordered_map<uint64_t, const Collider*> byId;
+                for (const Collider* collider : colliders) byId[collider->GetId()] = collider;
+
+                std::vector<ReceivedEvent> expected;
+                auto deliver = [&](EventType type, const PairIds& ids){
+                    if (undecided(ids)) return;
+                    if (byId[ids.first]->IsSubscribed(type)) expected.push_back({type, ids.first, ids.second});
+                    if (byId[ids.second]->IsSubscribed(type)) expected.push_back({type, ids.second, ids.first});
+                };
+                for (const PairIds& ids : current.hits){
+                    deliver(Contains(previous.hits, ids) ? EventType::Stay : EventType::Trigger, ids);
+                }
+                for (const PairIds& ids : previous.hits){
+                    if (!Contains(current.hits, ids)) deliver(EventType::Exit, ids);
+                }
+
+                std::vector<ReceivedEvent> actual;
+                for (const ReceivedEvent& event : received_){
+                    if (!undecided(MakePair(event.self, event.other))) actual.push_back(event);
+                }
+                std::ranges::sort(expected);
+                std::ranges::sort(actual);
+                pairsChecked_ += current.hits.size() + current.boundaries.size();
+
+                std::vector<ReceivedEvent> missing, extra;
+                std::ranges::set_difference(expected, actual, std::back_inserter(missing));
+                std::ranges::set_difference(actual, expected, std::back_inserter(extra));
+                for (const auto& event : missing) ReportPair(index, frame, "missing callback", event.type, {event.self, event.other}, colliders);
+                for (const auto& event : extra) ReportPair(index, frame, "unexpected callback", event.type, {event.self, event.other}, colliders);
+            }
+
+            void CompareEvents(size_t index, int frame, std::vector<ExpectedEvent>& expected, std::vector<ExpectedEvent>& actual, std::span<Collider* const> colliders) {
+                std::ranges::sort(expected);
+                std::ranges::sort(actual);
+                std::vector<ExpectedEvent> missing, extra;
+                std::ranges::set_difference(expected, actual, std::back_inserter(missing));
+                std::ranges::set_difference(actual, expected, std::back_inserter(extra));
+                for (const auto& event : missing) ReportPair(index, frame, "missing event", event.type, event.ids, colliders);
+                for (const auto& event : extra) ReportPair(index, frame, "unexpected event", event.type, event.ids, colliders);
+            }
+
+            void CheckRays(size_t index, int frame, std::span<Collider* const> colliders, std::span<const ReferenceShape> shapes, const CaseStyle& style, Random& random) {
+                constexpr int kRays = 8;
+                for (int r = 0; r < kRays; ++r){
+                    Vec3 direction;
+                    if (random.Chance(0.3f)){
+                        // 軸に平行なレイ (スラブ判定でゼロ除算になる向き)
+                        const float sign = random.Chance(0.5f) ? 1.f : -1.f;
+                        const uint32_t axis = random.Below(3);
+                        direction = Vec3(axis == 0 ? sign : 0.f, axis == 1 ? sign : 0.f, axis == 2 ? sign : 0.f);
+                    } else{
+                        direction = RandomDirection(random);
+                    }
+                    // 形状の内部から始まるレイも混ぜる
+                    const Vec3 origin = random.Chance(0.3f) ? colliders[random.Below(static_cast<uint32_t>(colliders.size()))]->GetTranslate() : RandomPoint(style, random);
+                    Ray ray(origin, direction, random.Uniform(0.f, style.extent * 2.f));
+                    if (random.Chance(0.3f)) ray.AddIgnore(1u << random.Below(3));
+
+                    const Manager::RayHitData actual = manager_.RayCast(&ray);
+                    ++raysChecked_;
+
+                    const Vector o = Vector::Of(ray.GetOrigin());
+                    const Vector d = Vector::Of(ray.GetDirection());
+                    const double length = ray.GetLength();
+                    double touch = kInfinity;
+                    double enter = kInfinity;
+                    const ReferenceShape* hitShape = nullptr;
+                    for (size_t i = 0; i < colliders.size(); ++i){
+                        if (!colliders[i]->IsEnabled() || !Filter(ray.GetData(), colliders[i]->GetData())) continue;
+                        const ReferenceShape::RayRange range = shapes[i].RayCast(o, d, length);
+                        touch = std::min(touch, range.touch);
+                        enter = std::min(enter, range.enter);
+                        if (colliders[i]->GetId() == actual.id) hitShape = &shapes[i];
+                    }
+
+                    if (actual.id == 0){
+                        if (enter != kInfinity) ReportRay(index, frame, "missing", actual, touch, enter);
+                        continue;
+                    }
+                    // 当たったコライダーの表面にあり、触れうる最初の距離と確実に当たる最初の距離の間にあるか
+                    const double t = actual.distance;
+                    const bool valid = hitShape && hitShape->Touches(o + d * t) &&
+                        touch - kReferenceTolerance <= t && t <= std::min(enter, length) + kReferenceTolerance;
+                    if (!valid) ReportRay(index, frame, hitShape ? "wrong distance" : "unexpected", actual, touch, enter);
+                }
+
+                // Detect の後に呼んだ RayCast の回数が統計に写る
+                const uint32_t counted = manager_.GetStats().rayCasts;
+                if (COLLISION_ENABLE_STATS && counted != kRays && CountMismatch()) std::printf("mismatch scene=%zu frame=%d stats rayCasts=%u expected=%d\n", index, frame, counted, kRays);
+            }
+
+            // OBB同士の分離軸判定で、SSE の経路と常にコンパイルされるスカラーの経路が同じ結果になるか
+            void CheckBoxes(size_t index, const CaseStyle& style, Random& random) {
+                auto box = [&](){
+                    OrientedBox result {RandomPoint(style, random), {Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f)}, {}};
+                    // 格子では軸平行 (平行な辺の外積がゼロになる軸を通る)
+                    if (!style.lattice){
+                        const Vec3 a = RandomDirection(random);
+                        Vec3 b = Vec3::Cross(a, RandomDirection(random));
+                        if (b.Length() < 1e-3f) b = Vec3::Cross(a, std::abs(a.x) < 0.9f ? Vec3(1.f, 0.f, 0.f) : Vec3(0.f, 1.f, 0.f));
+                        b.Normalize();
+                        result.axes = {a, b, Vec3::Cross(a, b)};
+                    }
+                    const float scale = style.lattice ? 0.5f : random.Uniform(0.1f, 3.f) * style.scale;
+                    result.half = random.Chance(0.05f) ? Vec3() : Vec3(random.Uniform(0.f, 1.f), random.Uniform(0.f, 1.f), random.Uniform(0.f, 1.f)) * scale;
+                    return result;
+                };
+
+                constexpr int kBoxes = 16;
+                for (int k = 0; k < kBoxes; ++k){
+                    const OrientedBox a = box();
+                    OrientedBox b = box();
+                    // 近くに置いて重なる組と離れる組を半々にする
+                    if (random.Chance(0.5f)) b.center = a.center + RandomDirection(random) * random.Uniform(0.f, (a.half + b.half).Length());
+                    ++boxesChecked_;
+
+                    const bool scalar = Intersection::OBBOBBScalar(a, b);
+                    if (Intersection::OBBOBB(a, b) == scalar) continue;
+                    // 演算の順序の違いで丸めが変わる境界の組は、少し縮めても広げても同じ結果にならない
+                    OrientedBox shrunk = b, grown = b;
+                    shrunk.half *= 1.f - 1e-4f;
+                    grown.half *= 1.f + 1e-4f;
+                    if (Intersection::OBBOBBScalar(a, shrunk) != Intersection::OBBOBBScalar(a, grown)) continue;
+                    if (CountMismatch()){
+                        std::printf("mismatch scene=%zu OBBOBB scalar=%d center=(%g,%g,%g)-(%g,%g,%g)\n", index, scalar ? 1 : 0,
+                                    a.center.x, a.center.y, a.center.z, b.center.x, b.center.y, b.center.z);
+                    }
+                }
+            }
+
+            void CheckQueries(size_t index, int frame, std::span<Collider* const> colliders, std::span<const ReferenceShape> shapes, const CaseStyle& style, Random& random) {
+                std::vector<Collider*> out(colliders.size());
+                auto mask = [&random](){ return random.Chance(0.3f) ? 1u << random.Below(3) : 0u; };
+                constexpr int kQueries = 2;
+
+                for (int q = 0; q < kQueries; ++q){
+                    const Vec3 center = RandomPoint(style, random);
+                    const float radius = random.Chance(0.1f) ? 0.f : random.Uniform(0.f, 3.f);
+                    const uint32_t attribute = mask();
+                    const uint32_t ignore = mask();
+                    const size_t found = manager_.QuerySphere(center, radius, out, attribute, ignore);
+                    const ReferenceShape sphere = ReferenceShape::Sphere(Vector::Of(center), radius);
+                    CheckSet(index, frame, "QuerySphere", colliders, std::span(out).first(std::min(found, out.size())), found, attribute, ignore, [&](size_t i){
+                        return shapes[i].Overlaps(sphere);
+                    });
+                }
+
+                for (int q = 0; q < kQueries; ++q){
+                    const Vec3 center = RandomPoint(style, random);
+                    const Vec3 size = style.lattice ? Vec3(1.f, 1.f, 1.f) * static_cast<float>(random.Below(4)) : Vec3(random.Uniform(0.f, 4.f), random.Uniform(0.f, 4.f), random.Uniform(0.f, 4.f));
+                    const uint32_t attribute = mask();
+                    const uint32_t ignore = mask();
+                    const size_t found = manager_.QueryAABB(center, size, out, attribute, ignore);
+                    const Vector half = Vector::Of(size) * 0.5;
+                    const ReferenceShape box = ReferenceShape::Box(Vector::Of(center) - half, Vector::Of(center) + half);
+                    CheckSet(index, frame, "QueryAABB", colliders, std::span(out).first(std::min(found, out.size())), found, attribute, ignore, [&](size_t i){
+                        return shapes[i].Overlaps(box);
+                    });
+                }
+
+                for (int q = 0; q < kQueries; ++q){
+                    // 形状の中心や格子点を多く選び、内部と境界の点を含める
+                    const Vec3 point = random.Chance(0.5f) ? colliders[random.Below(static_cast<uint32_t>(colliders.size()))]->GetTranslate() : RandomPoint(style, random);
+                    const uint32_t attribute = mask();
+                    const uint32_t ignore = mask();
+                    const size_t found = manager_.QueryPoint(point, out, attribute, ignore);
+                    CheckSet(index, frame, "QueryPoint", colliders, std::span(out).first(std::min(found, out.size())), found, attribute, ignore, [&](size_t i){
+                        return shapes[i].Contains(Vector::Of(point));
+                    });
+                }
+
+                for (int q = 0; q < kQueries; ++q){
+                    CheckNearest(index, frame, colliders, shapes, RandomPoint(style, random), random.Uniform(0.f, style.extent), 1 + random.Below(8), mask(), mask());
+                }
+
+                CheckPlanes(index, frame, colliders, shapes, style, random, mask(), mask());
+            }
+
+            // クエリの対象になるコライダー (直近の Detect で登録済み・有効で、属性のマスクを通るもの)
+            static bool IsCandidate(const Collider* collider, uint32_t attribute, uint32_t ignore) {
+                if (!collider->IsEnabled() || collider->GetType() == Type::None) return false;
+                return !(attribute & collider->GetIgnore() || ignore & collider->GetAttribute());
+            }
+
+            /**
+             * 結果の集合を総当たりの判定と比べます。
+             * Hit の候補はすべて含まれ、Miss の候補と対象外のコライダーは含まれないことを確かめます。
+             */
+            template <typename Test>
+            void CheckSet(size_t index, int frame, const char* query, std::span<Collider* const> colliders, std::span<Collider* const> results, size_t found,
+                          uint32_t attribute, uint32_t ignore, Test&& test) {
+                ++queriesChecked_;
+                if (found != results.size()){
+                    if (CountMismatch()) std::printf("mismatch scene=%zu frame=%d %s returned %zu for a buffer of %zu\n", index, frame, query, found, results.size());
+                    return;
+                }
+                std::vector<uint64_t> returned;
+                for (const Collider* collider : results) returned.push_back(collider->GetId());
+                std::ranges::sort(returned);
+                if (std::ranges::adjacent_find(returned) != returned.end()){
+                    if (CountMismatch()) std::printf("mismatch scene=%zu frame=%d %s returned a collider twice\n", index, frame, query);
+                }
+
+                for (size_t i = 0; i < colliders.size(); ++i){
+                    const Collider* collider = colliders[i];
+                    const bool included = std::ranges::binary_search(returned, collider->GetId());
+                    if (!IsCandidate(collider, attribute, ignore)){
+                        if (included) ReportQuery(index, frame, query, "filtered", collider);
+                        continue;
+                    }
+                    const Verdict verdict = test(i);
+                    if (verdict == Verdict::Hit && !included) ReportQuery(index, frame, query, "missing", collider);
+                    if (verdict == Verdict::Miss && included) ReportQuery(index, frame, query, "unexpected", collider);
+                }
+            }
+
+            void CheckNearest(size_t index, int frame, std::span<Collider* const> colliders, std::span<const ReferenceShape> shapes, const Vec3& point, float maxRadius,
+                              uint32_t k, uint32_t attribute, uint32_t ignore) {
+                ++queriesChecked_;
+                std::vector<Manager::NearestHit> out(k);
+                const size_t found = manager_.QueryNearest(point, maxRadius, out, attribute, ignore);
+                const Vector p = Vector::Of(point);
+                constexpr double t = kReferenceTolerance;
+
+                std::unordered_map<uint64_t, size_t> indices;
+                for (size_t i = 0; i < colliders.size(); ++i) indices[colliders[i]->GetId()] = i;
+
+                // 返された要素は対象で、距離が総当たりの範囲に入り、近い順に並ぶ
+                std::vector<bool> returned(colliders.size(), false);
+                for (size_t j = 0; j < found; ++j){
+                    const auto itr = indices.find(out[j].collider->GetId());
+                    if (itr == indices.end() || returned[itr->second] || !IsCandidate(out[j].collider, attribute, ignore)){
+                        ReportQuery(index, frame, "QueryNearest", "filtered", out[j].collider);
+                        continue;
+                    }
+                    returned[itr->second] = true;
+                    const ReferenceShape::Range range = shapes[itr->second].Distance(p);
+                    const double distance = out[j].distance;
+                    if (distance < range.min - t || range.max + t < distance || maxRadius + t < distance ||
+                        (j && distance < out[j - 1].distance)){
+                        if (CountMismatch()){
+                            std::printf("mismatch scene=%zu frame=%d QueryNearest distance=%g expected=[%g, %g] rank=%zu\n", index, frame, distance, range.min, range.max, j);
+                            Describe(out[j].collider);
+                        }
+                    }
+                }
+
+                // 返されなかった対象は、最後の要素 (k 件に満たなければ探索半径) より確実に近いものではない
+                const double cutoff = found < k ? maxRadius : out[found - 1].distance;
+                for (size_t i = 0; i < colliders.size(); ++i){
+                    if (returned[i] || !IsCandidate(colliders[i], attribute, ignore)) continue;
+                    const ReferenceShape::Range range = shapes[i].Distance(p);
+                    if (range.max < cutoff - t) ReportQuery(index, frame, "QueryNearest", "missing", colliders[i]);
+                }
+            }
+
+            void CheckPlanes(size_t index, int frame, std::span<Collider* const> colliders, std::span<const ReferenceShape> shapes, const CaseStyle& style, Random& random,
+                             uint32_t attribute, uint32_t ignore) {
+                // 向きを持つ箱の6面と、それを斜めに切る平面 (最大8枚)
+                const Vec3 center = RandomPoint(style, random);
+                std::array<Vec3, 3> axes {Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f)};
+                if (!style.lattice){
+                    const Vec3 a = RandomDirection(random);
+                    Vec3 b = Vec3::Cross(a, RandomDirection(random));
+                    if (b.Length() < 1e-3f) b = Vec3::Cross(a, std::abs(a.x) < 0.9f ? Vec3(1.f, 0.f, 0.f) : Vec3(0.f, 1.f, 0.f));
+                    b.Normalize();
+                    axes = {a, b, Vec3::Cross(a, b)};
+                }
+                std::vector<Plane> planes;
+                for (int i = 0; i < 3; ++i){
+                    const float half = style.lattice ? 0.5f * (1 + random.Below(4)) : random.Uniform(0.1f, std::min(style.extent, 10.f));
+                    for (const float sign : {1.f, -1.f}){
+                        const Vec3 normal = axes[i] * -sign;
+                        planes.push_back({normal, -normal.Dot(center + axes[i] * (sign * half))});
+                    }
+                }
+                const uint32_t cuts = random.Below(3);
+                for (uint32_t c = 0; c < cuts; ++c){
+                    const Vec3 normal = RandomDirection(random);
+                    const Vec3 through = center + RandomDirection(random) * random.Uniform(0.f, 1.f);
+                    planes.push_back({normal, -normal.Dot(through)});
+                }
+
+                std::vector<Collider*> out(colliders.size());
+                const size_t found = manager_.QueryPlanes(planes, out, attribute, ignore);
+
+                // 平面の3枚ずつの交点のうち、すべての平面の内側にあるものが領域の頂点
+                auto inside = [&](const Vector& p, double margin){
+                    for (const Plane& plane : planes){
+                        if (Vector::Of(plane.normal).Dot(p) + plane.distance < -margin) return false;
+                    }
+                    return true;
+                };
+                std::vector<Vector> vertices;
+                for (size_t i = 0; i < planes.size(); ++i){
+                    for (size_t j = i + 1; j < planes.size(); ++j){
+                        for (size_t k = j + 1; k < planes.size(); ++k){
+                            const Vector n1 = Vector::Of(planes[i].normal);
+                            const Vector n2 = Vector::Of(planes[j].normal);
+                            const Vector n3 = Vector::Of(planes[k].normal);
+                            const double det = n1.Dot(n2.Cross(n3));
+                            if (std::abs(det) < 1e-9) continue;
+                            const Vector p = (n2.Cross(n3) * -planes[i].distance + n3.Cross(n1) * -planes[j].distance + n1.Cross(n2) * -planes[k].distance) * (1.0 / det);
+                            if (inside(p, 1e-6)) vertices.push_back(p);
+                        }
+                    }
+                }
+                const ReferenceShape region = ReferenceShape::Polytope(vertices);
+
+                // 境界で判定するので領域と重なるものは必ず含み、1枚の平面の完全に外側にある境界のものは含まない
+                // (地形は中心が地表より下かどうかではなく、中身の下端まで伸ばした境界と領域が重なれば含む)
+                CheckSet(index, frame, "QueryPlanes", colliders, std::span(out).first(std::min(found, out.size())), found, attribute, ignore, [&](size_t i){
+                    const Vector& min = shapes[i].GetMin();
+                    const Vector& max = shapes[i].GetMax();
+                    if (vertices.size() >= 4){
+                        const bool field = shapes[i].GetKind() == ReferenceShape::Kind::HeightField;
+                        if (region.Overlaps(field ? ReferenceShape::Box(min, max) : shapes[i]) == Verdict::Hit) return Verdict::Hit;
+                    }
+                    for (const Plane& plane : planes){
+                        const Vector n = Vector::Of(plane.normal);
+                        const double farthest = plane.distance + std::max(n.x * min.x, n.x * max.x) + std::max(n.y * min.y, n.y * max.y) + std::max(n.z * min.z, n.z * max.z);
+                        if (farthest < -kReferenceTolerance) return Verdict::Miss;
+                    }
+                    return Verdict::Either;
+                });
+
+                // 上限を超える平面は判定せずに0を返す
+                planes.resize(Manager::kMaxQueryPlanes + 1, planes.front());
+                ++queriesChecked_;
+                const size_t rejected = manager_.QueryPlanes(planes, out, attribute, ignore);
+                if (rejected != 0 && CountMismatch()) std::printf("mismatch scene=%zu frame=%d QueryPlanes returned %zu for %zu planes\n", index, frame, rejected, planes.size());
+            }
+
+            // 不一致を数え、詳しく出力する件数の範囲内なら true を返す
+            bool CountMismatch() {
+                return mismatches_++ < options_.maxReports;
+            }
+
+            static void Describe(const Collider* collider) {
+                const Vec3 t = collider->GetTranslate();
+                std::printf("  id=%llu type=%d enabled=%d attribute=%u ignore=%u translate=(%g,%g,%g)\n",
+                            static_cast<unsigned long long>(collider->GetId()), static_cast<int>(collider->GetType()), collider->IsEnabled() ? 1 : 0,
+                            collider->GetAttribute(), collider->GetIgnore(), t.x, t.y, t.z);
+            }
+
+            void ReportPair(size_t index, int frame, const char* kind, EventType type, const PairIds& ids, std::span<Collider* const> colliders) {
+                if (!CountMismatch()) return;
+                std::printf("mismatch scene=%zu frame=%d %s event=%d pair=(%llu,%llu)\n", index, frame, kind, static_cast<int>(type),
+                            static_cast<unsigned long long>(ids.first), static_cast<unsigned long long>(ids.second));
+                for (const Collider* collider : colliders){
+                    if (collider->GetId() == ids.first || collider->GetId() == ids.second) Describe(collider);
+                }
+            }
+
+            void ReportRay(size_t index, int frame, const char* kind, const Manager::RayHitData& actual, double touch, double enter) {
+                if (!CountMismatch()) return;
+                std::printf("mismatch scene=%zu frame=%d ray %s actual=(%llu, %g) expected=[%g, %g]\n", index, frame, kind,
+                            static_cast<unsigned long long>(actual.id), actual.id ? actual.distance : 0.f, touch, enter);
+            }
+
+            void ReportQuery(size_t index, int frame, const char* query, const char* kind, const Collider* collider) {
+                if (!CountMismatch()) return;
+                std::printf("mismatch scene=%zu frame=%d %s %s\n", index, frame, query, kind);
+                Describe(collider);
+            }
+        };
+    }
+
+    ReferencePairSet ReferencePairs(std::span<Collider* const> colliders) {
+        std::vector<ReferenceShape> shapes;
+        shapes.reserve(colliders.size());
+        for (const Collider* collider : colliders) shapes.push_back(ReferenceShape::Of(collider));
+        return PairsOf(colliders, shapes);
+    }
+
+    size_t Verify(Manager& manager, const VerifyOptions& options) {
+        Verifier verifier(manager, options);
+        verifier.Run();
+        return verifier.GetMismatchCount();
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Collision/CollisionManager.h"
+
+namespace Bench{
+    // (小さいID, 大きいID) の順に並べた衝突ペア
+    using PairIds = std::pair<uint64_t, uint64_t>;
+
+    // 総当たりで求めた衝突ペア (どちらもソート済み)
+    struct ReferencePairSet{
+        // 必ず衝突するペア
+        std::vector<PairIds> hits;
+        // 境界が許容誤差以内で接していて、衝突してもしなくてもよいペア
+        std::vector<PairIds> boundaries;
+    };
+
+    /**
+     * Detect と同じ結果になるべき衝突ペアを総当たりで求めます。
+     * ライブラリの狭域判定・ブロードフェーズ・並列化を通さず、すべての組を ReferenceShape (Reference.h) で判定します。
+     * @param colliders 登録済みのコライダー
+     * @return 衝突するペアと境界で接するペア
+     */
+    ReferencePairSet ReferencePairs(std::span<Collision::Collider* const> colliders);
+
+    struct VerifyOptions{
+        // 検証するシーンの数
+        size_t scenes = 2000;
+        // シーンあたりのコライダーの最大数
+        uint32_t maxColliders = 200;
+        uint64_t seed = 1;
+        // 不一致を詳しく出力する件数
+        size_t maxReports = 20;
+    };
+
+    /**
+     * ランダムなシーンで Detect・ProcessEvent・RayCast・Query 系を総当たりの結果と比較します。
+     * シーンにはすべての形状 (メッシュ・地形・複合形状を含む) を混ぜ、スレッド数・接触情報の生成・
+     * 位置の更新方法・イベントモード (コールバックでは購読するイベントも) を切り替えます。
+     * 境界の接触・大きさゼロ・無効・属性のマスク・内部から始まるレイといった端の条件も含めます。
+     * OBB同士の分離軸判定は、SSE の経路とスカラーの経路の結果も比べます。
+     * 最後に共有プールを使う2つのワールドを別々のスレッドから同時に判定し、結果が混ざらないことを確かめます。
+     * WorldStreamer についても、書き出した2つのセルを注目点の移動で読み込み・破棄し、セルの状態と登録数を確かめます。
+     * @param manager 検証する Manager
+     * @param options 検証の設定
+     * @return 不一致の件数
+     */
+    size_t Verify(Collision::Manager& manager, const VerifyOptions& options);
+}
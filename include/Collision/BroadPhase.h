@@ -0,0 +1,310 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Mathematics.h"
+
+namespace Collision{
+    class Collider;
+
+    // 領域に対する包含関係
+    enum class Containment{
+        Outside,
+        Intersect,
+        Inside
+    };
+
+    // 軸平行境界ボックス (ブロードフェーズ用)
+    struct Bounds{
+        Vec3 min;
+        Vec3 max;
+
+        bool Overlaps(const Bounds& other) const;
+        bool Contains(const Vec3& point) const;
+        float SquaredDistance(const Vec3& point) const;
+        Bounds Merge(const Bounds& other) const;
+        Vec3 Center() const;
+
+        static Bounds Of(const Collider* collider);
+    };
+
+    /// @brief
+    /// 有効なコライダーを包む平坦配列のBVH
+    /// Manager::Detect で毎フレーム再構築され、ペア列挙と領域クエリに使用される
+    ///
+    /// プロキシは (attribute, ignore) の組ごとのレイヤーに分けられ、レイヤー毎に木を持つ。
+    /// レイヤー同士が衝突しうるかは構築時に 32x32 の行列として求めておくため、
+    /// 衝突しない組み合わせのレイヤーは走査自体を行わない。
+    class BroadPhase{
+    public:
+        static constexpr uint32_t kMaxLayers = 32;
+        // レイヤー数が上限を超えた場合の受け皿 (全レイヤーと衝突しうるものとして扱う)
+        static constexpr uint32_t kMixedLayer = kMaxLayers - 1;
+
+        struct Proxy{
+            Bounds bounds;
+            Collider* collider;
+            uint32_t attribute;
+            uint32_t ignore;
+            // コールバックが設定されているイベントのビット (Collider::GetSubscribedEvents)
+            uint8_t events;
+            // 所属レイヤー (Build で設定される)
+            uint8_t layer;
+            // 狭域判定の形状の種類 (Type の値)
+            uint8_t shape;
+        };
+
+        struct Node{
+            Bounds bounds;
+            // 葉なら proxies_ の先頭, 節なら右の子のインデックス (左の子は常に直後)
+            uint32_t index;
+            // 葉に含まれるプロキシ数 (0なら節)
+            uint32_t count;
+        };
+
+        struct Layer{
+            uint32_t attribute;
+            uint32_t ignore;
+            // 木の根 (プロキシが無ければ UINT32_MAX)
+            uint32_t root;
+        };
+
+    private:
+        static constexpr uint32_t kLeafSize = 4;
+        static constexpr uint32_t kMaxDepth = 64;
+
+        std::vector<Proxy> proxies_;
+        std::vector<Node> nodes_;
+        std::vector<Layer> layers_;
+        // matrix_[i] の jビット目が立っていればレイヤー i と j は衝突しうる
+        std::array<uint32_t, kMaxLayers> matrix_ {};
+        // プロキシの境界が書き換えられ、ノードの境界が古くなっているか
+        std::atomic<bool> dirty_ {false};
+
+    public:
+        /**
+         * プロキシ配列からツリーを構築します。
+         * 構築後のプロキシはレイヤー順に並べ替えられます。
+         * @param proxies 構築に使用するプロキシ
+         */
+        void Build(std::vector<Proxy> proxies);
+        void Clear();
+
+        /**
+         * プロキシを無効化します。ツリーの形は変えず、以降の走査で読み飛ばされます。
+         * @param index 無効化するプロキシのインデックス
+         * @param collider インデックスの指すコライダー (一致しない場合は何もしない)
+         */
+        void Invalidate(uint32_t index, const Collider* collider);
+
+        /**
+         * プロキシの境界を書き換えます。ノードの境界は Refit まで更新されません。
+         * 異なるプロキシであれば複数のスレッドから同時に呼び出せます。
+         * @param index 書き換えるプロキシのインデックス
+         * @param collider インデックスの指すコライダー (一致しない場合は何もしない)
+         * @param bounds 新しい境界
+         */
+        void UpdateBounds(uint32_t index, const Collider* collider, const Bounds& bounds);
+
+        /// UpdateBounds 後のノードの境界を葉から順に再計算します (木の形は変えない)
+        void Refit();
+        bool IsDirty() const;
+
+        const std::vector<Proxy>& GetProxies() const;
+        bool IsEmpty() const;
+
+        /**
+         * 指定レイヤーと衝突しうるレイヤーの集合を取得します。
+         * @param layer レイヤー
+         * @return レイヤーのビット集合
+         */
+        uint32_t GetCollidableLayers(uint32_t layer) const;
+
+        /**
+         * 属性とignoreの組と衝突しうるレイヤーの集合を取得します (クエリ用)。
+         * @param attribute 属性
+         * @param ignore 無視する属性
+         * @return レイヤーのビット集合
+         */
+        uint32_t GetCollidableLayers(uint32_t attribute, uint32_t ignore) const;
+
+        /**
+         * 境界と重なるプロキシを列挙します。
+         * @param bounds 検索範囲
+         * @param layers 走査するレイヤーのビット集合
+         * @param fn プロキシのインデックスを受け取る関数
+         */
+        template <typename Fn>
+        void Query(const Bounds& bounds, uint32_t layers, Fn&& fn) const;
+
+        /**
+         * 包含判定でノードを分類しながらプロキシを列挙します。
+         * 内側と判定されたノード以下は再判定せずに列挙されます。
+         * @param layers 走査するレイヤーのビット集合
+         * @param classify 境界の包含関係を返す関数
+         * @param fn プロキシのインデックスと、完全に内側かどうかを受け取る関数
+         */
+        template <typename Classify, typename Fn>
+        void Cull(uint32_t layers, Classify&& classify, Fn&& fn) const;
+
+        /**
+         * 点に近い順にプロキシを探索します (最良優先探索)。
+         * @param point 基準点
+         * @param maxDistance 探索半径
+         * @param layers 走査するレイヤーのビット集合
+         * @param out 結果 (距離, プロキシのインデックス) の書き込み先。要素数が取得数の上限となる
+         * @param distance プロキシまでの距離を返す関数 (対象外なら負の値)
+         * @return 書き込んだ件数 (距離の昇順)
+         */
+        template <typename Distance>
+        size_t Nearest(const Vec3& point, float maxDistance, uint32_t layers, std::span<std::pair<float, uint32_t>> out, Distance&& distance) const;
+
+    private:
+        uint32_t BuildRecursive(uint32_t begin, uint32_t end, uint32_t depth);
+
+        // layers に含まれる各レイヤーの根を順に渡す
+        template <typename Fn>
+        void ForEachRoot(uint32_t layers, Fn&& fn) const;
+    };
+
+    template <typename Fn>
+    void BroadPhase::ForEachRoot(uint32_t layers, Fn&& fn) const {
+        layers &= layers_.size() >= kMaxLayers ? UINT32_MAX : (1u << layers_.size()) - 1;
+        while (layers){
+            const uint32_t layer = static_cast<uint32_t>(std::countr_zero(layers));
+            layers &= layers - 1;
+            if (layers_[layer].root != UINT32_MAX){
+                fn(layers_[layer].root);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void BroadPhase::Query(const Bounds& bounds, uint32_t layers, Fn&& fn) const {
+        ForEachRoot(layers, [&](uint32_t root){
+            uint32_t stack[kMaxDepth * 2];
+            uint32_t top = 0;
+            stack[top++] = root;
+
+            while (top){
+                const uint32_t nodeIndex = stack[--top];
+                const Node& node = nodes_[nodeIndex];
+                if (!node.bounds.Overlaps(bounds)) continue;
+
+                if (node.count){
+                    for (uint32_t i = node.index; i < node.index + node.count; ++i){
+                        if (proxies_[i].collider && proxies_[i].bounds.Overlaps(bounds)){
+                            fn(i);
+                        }
+                    }
+                    continue;
+                }
+
+                stack[top++] = node.index;
+                stack[top++] = nodeIndex + 1;
+            }
+        });
+    }
+
+    template <typename Classify, typename Fn>
+    void BroadPhase::Cull(uint32_t layers, Classify&& classify, Fn&& fn) const {
+        ForEachRoot(layers, [&](uint32_t root){
+            // ノード番号と、祖先が完全に内側だったか
+            std::pair<uint32_t, bool> stack[kMaxDepth * 2];
+            uint32_t top = 0;
+            stack[top++] = {root, false};
+
+            while (top){
+                const auto [nodeIndex, parentInside] = stack[--top];
+                const Node& node = nodes_[nodeIndex];
+
+                bool inside = parentInside;
+                if (!inside){
+                    const Containment containment = classify(node.bounds);
+                    if (containment == Containment::Outside) continue;
+                    inside = containment == Containment::Inside;
+                }
+
+                if (node.count){
+                    for (uint32_t i = node.index; i < node.index + node.count; ++i){
+                        if (proxies_[i].collider){
+                            fn(i, inside);
+                        }
+                    }
+                    continue;
+                }
+
+                stack[top++] = {node.index, inside};
+                stack[top++] = {nodeIndex + 1, inside};
+            }
+        });
+    }
+
+    template <typename Distance>
+    size_t BroadPhase::Nearest(const Vec3& point, float maxDistance, uint32_t layers, std::span<std::pair<float, uint32_t>> out, Distance&& distance) const {
+        if (nodes_.empty() || out.empty()) return 0;
+
+        // 結果は out 上の最大ヒープ (先頭が現在のk番目)
+        size_t found = 0;
+        auto limit = [&]{
+            return found < out.size() ? maxDistance : out[0].first;
+        };
+
+        // 未探索ノードの最小ヒープ (ノードまでの二乗距離, ノード番号)
+        using Entry = std::pair<float, uint32_t>;
+        std::vector<Entry> frontier;
+        frontier.reserve(kMaxDepth);
+        ForEachRoot(layers, [&](uint32_t root){
+            frontier.emplace_back(nodes_[root].bounds.SquaredDistance(point), root);
+        });
+        std::make_heap(frontier.begin(), frontier.end(), std::greater<>());
+
+        while (!frontier.empty()){
+            std::pop_heap(frontier.begin(), frontier.end(), std::greater<>());
+            const auto [nodeDistance, nodeIndex] = frontier.back();
+            frontier.pop_back();
+
+            const float bound = limit();
+            if (bound * bound < nodeDistance) break;
+
+            const Node& node = nodes_[nodeIndex];
+            if (node.count){
+                for (uint32_t i = node.index; i < node.index + node.count; ++i){
+                    if (!proxies_[i].collider) continue;
+
+                    const float d = distance(i);
+                    if (d < 0.f || limit() < d) continue;
+
+                    if (found < out.size()){
+                        out[found++] = {d, i};
+                        std::push_heap(out.begin(), out.begin() + found);
+                    } else{
+                        std::pop_heap(out.begin(), out.end());
+                        out.back() = {d, i};
+                        std::push_heap(out.begin(), out.end());
+                    }
+                }
+                continue;
+            }
+
+            for (const uint32_t child : {nodeIndex + 1, node.index}){
+                const float childDistance = nodes_[child].bounds.SquaredDistance(point);
+                const float childBound = limit();
+                if (childBound * childBound < childDistance) continue;
+
+                frontier.emplace_back(childDistance, child);
+                std::push_heap(frontier.begin(), frontier.end(), std::greater<>());
+            }
+        }
+
+        std::sort_heap(out.begin(), out.begin() + found);
+        return found;
+    }
+}
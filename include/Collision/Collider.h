@@ -1,18 +1,38 @@
 #pragma once
 #include <array>
-#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <shared_mutex>
+#include <type_traits>
 #include <variant>
 
+#include "Delegate.h"
 #include "Mathematics.h"
 
 namespace Collision{
 	class Manager;
 	class Collider;
+	class TriangleMesh;
+	class HeightField;
+	class CompoundShape;
+	class ConvexHull;
 
 	enum class Type{
 		Sphere,
 		AABB,
+		// 有向境界ボックス (サイズは Vec3, 向きは SetRotate で指定)
+		OBB,
+		// カプセル (サイズは CapsuleSize, 軸はローカルY軸)
+		Capsule,
+		// 静的な三角形メッシュ (サイズは shared_ptr<const TriangleMesh>)
+		Mesh,
+		// 地形 (サイズは shared_ptr<const HeightField>)
+		HeightField,
+		// 球とAABBを組み合わせた複合形状 (サイズは shared_ptr<const CompoundShape>)
+		Compound,
+		// 凸包 (サイズは shared_ptr<const ConvexHull>, 向きは SetRotate で指定)
+		ConvexHull,
 		Ray,
 
 		None
@@ -24,18 +44,49 @@ namespace Collision{
 		Exit
 	};
 
+	// 接触情報 (法線は自身から相手へ向かう向き)
+	struct Contact{
+		Vec3 normal;
+		float depth = 0.f;
+		Vec3 point;
+	};
+
+	// カプセルの大きさ
+	struct CapsuleSize{
+		float radius = 0.f;
+		// 両端の半球を除いた線分の長さ
+		float height = 0.f;
+	};
+
 	class Event{
+		public:
+		// 複合形状でない場合の子の番号
+		static constexpr uint32_t kNoChild = UINT32_MAX;
+
+		private:
 		EventType type_;
 		const Collider* other_;
+		Contact contact_ {};
+		bool hasContact_ = false;
+		uint32_t child_ = kNoChild;
+		uint32_t otherChild_ = kNoChild;
 
 		public:
-		Event(EventType, const Collider*);
+		Event(EventType, const Collider*, uint32_t _child = kNoChild, uint32_t _otherChild = kNoChild);
+		Event(EventType, const Collider*, const Contact&, uint32_t _child = kNoChild, uint32_t _otherChild = kNoChild);
 		EventType GetType() const;
 		const Collider* GetOther() const;
+		/// 接触情報 (Manager::SetGenerateContacts が無効、または Exit の場合は nullptr)
+		const Contact* GetContact() const;
+		/// 接触した自身の子の番号 (Type::Compound 以外は kNoChild, Exit では最後に接触していた子)
+		uint32_t GetChildIndex() const;
+		/// 接触した相手の子の番号
+		uint32_t GetOtherChildIndex() const;
 	};
 
 	 struct Data{
-		std::string uuid;
+		// プロセス内で一意な ID (UUID 形式の文字列は GetUniqueId で生成する)
+		uint64_t id = 0;
 		Type type = Type::None;
 		uint32_t attribute = 0b0;
 		uint32_t ignore = 0b0;
@@ -43,24 +94,50 @@ namespace Collision{
 	};
 
 	class Collider{
-		using Size = std::variant<float, Vec3>;
-		using CBFunc = std::function<void(const Collider*)>;
+	public:
+		using Size = std::variant<float, Vec3, CapsuleSize, std::shared_ptr<const TriangleMesh>, std::shared_ptr<const HeightField>, std::shared_ptr<const CompoundShape>, std::shared_ptr<const ConvexHull>>;
+
+	private:
+		// ヒープ確保をしないコールバック (捕捉は Delegate のバッファに収まる大きさまで)
+		using EventCBFunc = Delegate<void(const Event&)>;
 
 		std::atomic<bool> enable_ = false;
 		std::atomic<bool> registered_ = false;
 		std::shared_mutex mutex_;
 
 		Vec3 translate_ {};
+		// オイラー角 (ラジアン, X→Y→Zの順に適用)
+		Vec3 rotate_ {};
+		// 回転後のローカル軸 (rotate_ から求めたワールド空間の X, Y, Z 軸)
+		std::array<Vec3, 3> axes_ {Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f)};
 		Size size_ {};
 
 		Data data_ {};
 
 		Manager* manager_ = nullptr;
 
-		std::array<CBFunc, 3> onCollisions_;
+		// 相手のコライダーだけを受け取るコールバックも Event を受け取る形に包んで格納する
+		std::array<EventCBFunc, 3> onCollisionEvents_;
+		// コールバックが設定されているイベントのビット (1 << EventType)
+		std::atomic<uint8_t> subscribedEvents_ = 0;
+
+		// ブロードフェーズ上のプロキシ番号 (Managerが管理)
+		uint32_t proxyIndex_ = UINT32_MAX;
+		friend class Manager;
+		friend class ColliderPool;
+
+		// 登録を呼び出し側でまとめて行う場合の生成 (ColliderPool 用)
+		struct Deferred{};
+		Collider(Deferred, Manager* _manager);
 
 	public:
+		/// 既定のワールド (Singleton<Manager>) に登録されたコライダーを作ります
 		Collider();
+		/**
+		 * 指定したワールドに登録されたコライダーを作ります。
+		 * @param _manager 登録先のワールド (コライダーより長く生存すること)
+		 */
+		explicit Collider(Manager& _manager);
 		~Collider();
 		void Enable();
 		void Disable();
@@ -70,31 +147,78 @@ namespace Collision{
 
 		bool IsRegistered() const;
 
+		// 形状を変える Set 系はワールドのクエリにすぐ反映されるため、クエリや Detect と同時には呼ばないでください
 		Collider* SetType(const Type _type);
 		Collider* SetTranslate(const Vec3& _translate);
 		Collider* SetSize(const Size _size);
-		Collider* SetEvent(EventType _event, std::function<void(const Collider*)> _callback);
+		/**
+		 * 回転を設定します (Type::OBB, Type::Capsule, Type::ConvexHull の判定に使用されます)。
+		 * @param _rotate オイラー角 (ラジアン, X→Y→Zの順に適用)
+		 * @return this
+		 */
+		Collider* SetRotate(const Vec3& _rotate);
+		/**
+		 * 衝突イベントのコールバックを設定します (nullptr を渡すと解除)。
+		 * イベントごとにコールバックは1つで、後から設定したものに置き換わります。
+		 * コールバックはその場で呼び出されるため、コールバック内から同じイベントのコールバックを差し替えないでください。
+		 * @param _event イベントの種類
+		 * @param _callback 相手のコライダーを受け取る関数 (ラムダ式・関数オブジェクト・関数ポインタ)
+		 * @return this
+		 */
+		template <typename F>
+			requires (std::is_invocable_v<std::decay_t<F>&, const Collider*> && !std::is_invocable_v<std::decay_t<F>&, const Event&>)
+		Collider* SetEvent(EventType _event, F&& _callback) {
+			using Target = std::decay_t<F>;
+			// 空の関数ポインタなどは解除として扱う
+			if constexpr (std::is_constructible_v<bool, const Target&>){
+				if (!static_cast<bool>(_callback)) return SetEvent(_event, nullptr);
+			}
+			return SetEvent(_event, EventCBFunc([callback = Target(std::forward<F>(_callback))](const Event& _e) mutable {
+				callback(_e.GetOther());
+			}));
+		}
+		// 接触情報などイベントの詳細を受け取る版
+		Collider* SetEvent(EventType _event, EventCBFunc _callback);
+		// コールバックを解除する
+		Collider* SetEvent(EventType _event, std::nullptr_t);
 		Collider* AddAttribute(uint32_t _attribute);
 		Collider* RemoveAttribute(uint32_t _attribute);
 		Collider* AddIgnore(uint32_t _ignore);
 		Collider* RemoveIgnore(uint32_t _ignore);
 		Collider* SetOwner(void* _owner);
 
-		void OnCollision(Event _event) const;
+		void OnCollision(const Event& _event) const;
+
+		/// コールバックが設定されているイベントのビット集合 (1 << EventType)
+		uint8_t GetSubscribedEvents() const;
+		bool IsSubscribed(EventType _event) const;
 
 		const Data& GetData() const;
 
+		/// プロセス内で一意な ID
+		uint64_t GetId() const;
+		/// ID から生成した UUID 形式の文字列 (呼び出すたびに生成する)
 		std::string GetUniqueId() const;
 		Type GetType() const;
 		uint32_t GetAttribute() const;
 		uint32_t GetIgnore() const;
-		Size GetSize() const;
+		/// 形状の参照 (共有形状の参照カウントを増やさない。SetSize までの間だけ有効)
+		const Size& GetSize() const;
 		Vec3 GetTranslate() const;
+		Vec3 GetRotate() const;
+		/// 回転後のローカル軸 (ワールド空間, 正規直交)
+		const std::array<Vec3, 3>& GetAxes() const;
 		void* GetOwner() const;
+		/// 登録先のワールド
+		Manager* GetManager() const;
 
-		bool operator==(const std::string& other) const {
-			return data_.uuid == other;
-		}
+		/// UUID 形式の文字列と比較します (文字列から ID を取り出して比べる)
+		bool operator==(const std::string& other) const;
+
+	private:
+		void UpdateSubscribedEvents(EventType _event);
+		// 形状の変更をワールドのブロードフェーズへ反映する
+		void RefitProxy() const;
 	};
 
 	/// @brief
@@ -104,7 +228,6 @@ namespace Collision{
 		Vec3 origin_;
 		Vec3 direction_;
 		float length_;
-		Manager* manager_ = nullptr;
 		Data data_ {};
 	public:
 		Ray();
@@ -129,6 +252,7 @@ namespace Collision{
 		const Vec3& GetDirection() const;
 		const float& GetLength() const;
 
+		uint64_t GetId() const;
 		std::string GetUniqueId() const;
 		Type GetType() const;
 		uint32_t GetAttribute() const;
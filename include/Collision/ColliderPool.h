@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "Collider.h"
+
+namespace Collision{
+    /// @brief
+    /// コライダーを固定長のスラブから確保するプール (Manager が所有する)
+    /// 解放したスロットは空きリストで再利用するため、確保と解放は O(1) で
+    /// スラブが足りている間はコライダー本体のためのヒープ確保が起きない
+    class ColliderPool{
+        static constexpr uint32_t kSlabSize = 256;
+
+        struct Slot{
+            union{
+                // 空きスロットなら次の空きスロット
+                Slot* next;
+                alignas(Collider) std::byte storage[sizeof(Collider)];
+            };
+            bool live = false;
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> slabs_;
+        Slot* free_ = nullptr;
+        // 遅延解除が終わるまで再利用しないスロット
+        Slot* retired_ = nullptr;
+        size_t liveCount_ = 0;
+        std::mutex mutex_;
+        // 生成したコライダーを登録する Manager
+        Manager* manager_;
+
+    public:
+        explicit ColliderPool(Manager* manager);
+        ColliderPool(const ColliderPool&) = delete;
+        ColliderPool& operator=(const ColliderPool&) = delete;
+        ~ColliderPool();
+
+        /**
+         * コライダーを生成します (Manager への登録は呼び出し側で行う)。
+         * @return 生成したコライダー
+         */
+        Collider* Create();
+
+        /**
+         * コライダーを破棄してスロットを返却します。
+         * @param collider このプールの Create で生成したコライダー
+         * @param retire true なら Release を呼ぶまでスロットを再利用しない (遅延解除中のアドレスを残すため)
+         * @return 破棄済みのコライダーならfalse
+         */
+        bool Destroy(Collider* collider, bool retire = false);
+
+        /// 再利用を保留していたスロットを空きリストに戻します
+        void Release();
+
+        /// 指定数のコライダーを確保なしで生成できるようスラブを追加します
+        void Reserve(size_t count);
+
+        /// 生存中のコライダーをすべて破棄します
+        void Clear();
+
+        size_t GetLiveCount();
+        size_t GetCapacity();
+
+    private:
+        void AddSlab();
+        /// このプールのスロットか (デバッグ時の確認用)
+        bool Owns(const Slot* slot) const;
+    };
+}
@@ -1,39 +1,131 @@
 ﻿#pragma once
+#include <functional>
 #include <shared_mutex>
-#include <thread>
+#include <algorithm>
 #include <atomic>
 #include <queue>
+#include <span>
 #include <vector>
 
+#include "BroadPhase.h"
 #include "Collider.h"
+#include "ColliderPool.h"
+#include "Stats.h"
+#include "Tracer.h"
+#include "WorkerPool.h"
 #include <map>
 
 namespace Collision{
+    /// @brief
+    /// 衝突判定のワールド
+    /// コライダーの登録・ブロードフェーズ・イベントはワールドごとに独立しており、ロックも共有しない。
+    /// 複数のワールドを作る場合は同じ WorkerPool を渡すことで、ワーカースレッドだけを共有できる。
     class Manager{
     public:
         struct RayHitData{
-	        std::string uuid;
+            // 交差したコライダーの ID (交差しなければ0)
+            uint64_t id = 0;
             Vec3 hitPoint;
+            float distance = 0.f;
+            // 交差した複合形状の子の番号 (複合形状でなければ Event::kNoChild)
+            uint32_t child = Event::kNoChild;
+
+            /// 交差したコライダーの UUID 形式の文字列 (呼び出すたびに生成し, 交差しなければ空)
+            std::string GetUniqueId() const;
+        };
+
+        enum class EventMode{
+            // Collider::SetEvent で登録したコールバックを呼び出す
+            // コールバックが設定されていない種類のイベントは生成されない
+            Callback,
+            // コールバックは呼ばず、GetEvents で一括取得する (全種類のイベントを生成)
+            Stream
+        };
+
+        // ProcessEvent で生成される衝突イベント (1ペアにつき1件)
+        struct ContactEvent{
+            EventType type;
+            Collider* collider;
+            Collider* other;
+            void* owner;
+            void* otherOwner;
+            // collider から other への接触情報 (SetGenerateContacts が無効、または Exit の場合はゼロ)
+            Contact contact;
+            // 接触した複合形状の子の番号 (複合形状でなければ Event::kNoChild)
+            uint32_t child = Event::kNoChild;
+            uint32_t otherChild = Event::kNoChild;
+        };
+
+        struct NearestHit{
+            Collider* collider;
+            // 基準点から表面までの距離 (内部なら0)
             float distance;
         };
 
+        // 狭域判定の出力先 (nullptr の項目は求めない)
+        struct DetectOutput{
+            // c1 から c2 への接触情報
+            Contact* contact = nullptr;
+            // 接触した複合形状の子の番号 (c1, c2 の順)
+            std::array<uint32_t, 2>* children = nullptr;
+            // 凸包の判定を始める分離軸 (c1 から c2 へ向かう向き)。判定後の分離軸を書き戻す
+            Vec3* axis = nullptr;
+        };
+
+        /**
+         * 形状の組ごとの狭域判定関数。
+         * @param c1 1つ目のコライダー
+         * @param c2 2つ目のコライダー
+         * @param output 出力先
+         * @return 衝突している場合はtrue
+         */
+        using Kernel = bool(*)(const Collider* c1, const Collider* c2, const DetectOutput& output);
+
+        // 狭域判定の形状の種類の数 (Type::Ray より前が形状)
+        static constexpr size_t kShapeCount = static_cast<size_t>(Type::Ray);
+        // [c1 の形状][c2 の形状] で引く狭域判定の表
+        using KernelTable = std::array<std::array<Kernel, kShapeCount>, kShapeCount>;
+        // QueryPlanes に渡せる平面の上限
+        static constexpr size_t kMaxQueryPlanes = 8;
+
     private:
-    	using Pair = std::pair<std::string, std::string>;
-        // 登録済みコライダー情報
-        std::unordered_map<std::string, Collider*> colliders_;
+        // 位置・大きさの変更をブロードフェーズへ反映させるため
+        friend class Collider;
+
+    	using Pair = std::pair<uint64_t, uint64_t>;
+        struct DetectedPair{
+            Pair ids;
+            // ids.first から ids.second への接触情報
+            Contact contact;
+            // ids の順に並べた、接触した複合形状の子の番号
+            std::array<uint32_t, 2> children {Event::kNoChild, Event::kNoChild};
+        };
+        // 登録済みコライダー情報 (ID で引く)
+        std::unordered_map<uint64_t, Collider*> colliders_;
         // 衝突確認済みペア
-        std::vector<Pair> detectedPair_;
-        std::vector<Pair> prePair_;
+        std::vector<DetectedPair> detectedPair_;
+        std::vector<DetectedPair> prePair_;
 
-        std::shared_mutex mutex_;
-        uint32_t maxThreadCount_ {std::thread::hardware_concurrency()};
+        // 凸包を含むペアで前回の判定が終えた分離軸 (GJK の初期方向に使う)
+        // コライダーのアドレスで引くため、解放されたアドレスが再利用されても初期方向がずれるだけで結果は変わらない
+        struct SeparatingAxis{
+            std::pair<const Collider*, const Collider*> colliders;
+            // colliders.first から colliders.second へ向かう向き
+            Vec3 axis;
+        };
+        // colliders の順にソート済み
+        std::vector<SeparatingAxis> separatingAxes_;
+        // 狭域判定で接触情報を生成するか
+        bool generateContacts_ = false;
+        // 形状の組ごとの狭域判定 (既定はコンパイル時に生成した表)
+        KernelTable kernels_;
 
-        // スレッドプール関連
-        std::vector<std::thread> threadPool_;
-        std::queue<std::function<void()>>tasks_;
-        std::mutex taskMutex_;
-        std::condition_variable taskCondition_;
-        std::atomic<bool> running_ {true};
+        std::shared_mutex mutex_;
+        // 他のワールドと共有しうるスレッドプール
+        std::shared_ptr<WorkerPool> workerPool_;
+        uint32_t maxThreadCount_;
+        // Detect でタスクを割り当てるワーカーの数 (maxThreadCount_ 以下)
+        uint32_t activeThreadCount_;
 
         // 直接登録するためのフラグ
         std::atomic<bool> isProcessingCollisions_ {false};
@@ -44,8 +136,37 @@ namespace Collision{
 
         std::vector<RayHitData> hitRays_;
         std::map<float, RayHitData> hitRaysOrderedByDistance_;
+
+        // ProcessEvent で生成したイベント (毎回再利用)
+        std::vector<ContactEvent> events_;
+        EventMode eventMode_ = EventMode::Callback;
+
+        // Detect毎に再構築されるブロードフェーズ
+        BroadPhase broadPhase_;
+
+        // CreateCollider で生成するコライダーのプール
+        ColliderPool colliderPool_;
+
+        // 直近のフレームの統計
+        FrameStats stats_;
+        // ワーカースレッドごとのこのワールドのタスク実行時間 (ナノ秒, Detect の終了時に stats_ へ写す)
+        std::unique_ptr<std::atomic<uint64_t>[]> workerBusy_;
+        // RayCast の回数と所要時間 (並行に呼ばれるため stats_ とは別に積み、GetStats で写す)
+        std::atomic<uint32_t> rayCasts_ {0};
+        std::atomic<uint64_t> rayCastNanoseconds_ {0};
+        // SetTracing で有効にするトレース
+        Tracer tracer_;
     public:
+        /// プロセスで共有する既定のスレッドプール (WorkerPool::GetShared) を使うワールドを作ります
         Manager();
+
+        /**
+         * 指定したスレッドプールを使うワールドを作ります。
+         * @param workerPool Detect のタスクを実行するプール (他のワールドと共有できる)
+         */
+        explicit Manager(std::shared_ptr<WorkerPool> workerPool);
+        Manager(const Manager&) = delete;
+        Manager& operator=(const Manager&) = delete;
         ~Manager();
 
         /**
@@ -55,6 +176,13 @@ namespace Collision{
          */
         bool Register(Collider* collider);
 
+        /**
+         * コライダーをまとめて登録します (ロックは1回だけ取る)。
+         * @param colliders 登録するコライダー (nullptr は無視する)
+         * @return 登録成功時はtrue
+         */
+        bool RegisterMany(std::span<Collider* const> colliders);
+
         /**
          * コライダーの登録を解除します。
          * @param collider 登録解除するコライダー
@@ -62,6 +190,66 @@ namespace Collision{
          */
         bool Unregister(const Collider* collider);
 
+        /**
+         * コライダーの登録をまとめて解除します (ロックは1回だけ取る)。
+         * 解除したコライダーは破棄時に改めて解除されません。
+         * @param colliders 登録解除するコライダー (nullptr は無視する)
+         * @return 解除成功時はtrue
+         */
+        bool UnregisterMany(std::span<Collider* const> colliders);
+
+        /**
+         * Manager が所有するプールからコライダーを生成します (登録済みの状態で返す)。
+         * 生成したコライダーは delete せず DestroyCollider で破棄してください。
+         * @return 生成したコライダー
+         */
+        Collider* CreateCollider();
+
+        /**
+         * コライダーをまとめて生成し、まとめて登録します。
+         * @param out 生成したコライダーの出力先 (要素数だけ生成する)
+         */
+        void CreateColliders(std::span<Collider*> out);
+
+        /**
+         * CreateCollider で生成したコライダーを破棄します。
+         * 衝突処理中に破棄した場合、スロットは次の Detect まで再利用されません。
+         * @param collider 破棄するコライダー
+         * @return 破棄済みのコライダーならfalse
+         */
+        bool DestroyCollider(Collider* collider);
+
+        /**
+         * コライダーをまとめて破棄します。
+         * @param colliders CreateCollider で生成したコライダー
+         */
+        void DestroyColliders(std::span<Collider* const> colliders);
+
+        /**
+         * 指定数のコライダーをヒープ確保なしで生成できるようプールを拡張します。
+         * @param count 生存させるコライダーの数
+         */
+        void ReserveColliders(size_t count);
+
+        /**
+         * コライダーの位置をまとめて更新します。
+         * 直近の Detect で構築したブロードフェーズの境界も書き換え、次のクエリの前に木を再調整します。
+         * ロックを取らないので、重ならない範囲に分けて複数のスレッドから同時に呼び出せます。
+         * その代わり書き込みは保護されないため、Detect や Query 系 (ワーカースレッドからのものを含む) と同時には呼ばないでください。
+         * @param colliders 更新するコライダー
+         * @param translates 位置 (colliders と同じ要素数)
+         */
+        void UpdateTransforms(std::span<Collider* const> colliders, std::span<const Vec3> translates);
+
+        /**
+         * コライダーの位置と大きさをまとめて更新します。
+         * 同時に呼び出せる条件は位置だけを更新する版と同じです。
+         * @param colliders 更新するコライダー
+         * @param translates 位置 (colliders と同じ要素数)
+         * @param sizes 大きさ (colliders と同じ要素数)
+         */
+        void UpdateTransforms(std::span<Collider* const> colliders, std::span<const Vec3> translates, std::span<const Collider::Size> sizes);
+
         /**
          * 衝突検出を実行します。
          * この処理はスレッドプールを使用して並列に実行されます。
@@ -74,40 +262,217 @@ namespace Collision{
          */
         void ProcessEvent();
 
+        /**
+         * イベントの受け取り方を設定します。
+         * @param _mode Callback: コールバック呼び出し / Stream: GetEvents で一括取得
+         */
+        void SetEventMode(EventMode _mode);
+        EventMode GetEventMode() const;
+
+        /**
+         * 直近の ProcessEvent で生成されたイベントを取得します。
+         * 次の ProcessEvent まで有効です。
+         * @return 連続したイベント配列 (Trigger/Stay の後に Exit が並ぶ)
+         */
+        std::span<const ContactEvent> GetEvents() const;
+
+        /**
+         * 狭域判定で接触情報 (法線・めり込み量・接触点) を生成するか設定します。
+         * 有効にすると Event::GetContact と ContactEvent::contact から参照できます。
+         * @param _generate 生成する場合はtrue
+         */
+        void SetGenerateContacts(bool _generate);
+
+        /**
+         * Detect でタスクを割り当てるワーカーの数を制限します (スレッド数ごとの性能の比較用)。
+         * スレッドプール自体の大きさは変わりません。Detect の実行中には呼ばないでください。
+         * @param _count ワーカーの数 (0 ならすべてのワーカー)
+         */
+        void SetThreadCount(uint32_t _count);
+        /// Detect でタスクを割り当てるワーカーの数
+        uint32_t GetThreadCount() const;
+        /// スレッドプールのワーカーの数
+        uint32_t GetMaxThreadCount() const;
+        /// Detect のタスクを実行するスレッドプール
+        const std::shared_ptr<WorkerPool>& GetWorkerPool() const;
+
+        /**
+         * 直近のフレームの統計を取得します。
+         * Detect の開始時にリセットされ、ProcessEvent と RayCast の分も次の Detect まで積み上がります。
+         * RayCast の回数と所要時間は、呼び出した時点までの分を写します。
+         * COLLISION_ENABLE_STATS が 0 の場合は常にゼロです。
+         * @return 統計の写し
+         */
+        FrameStats GetStats() const;
+
+        /**
+         * トレースの記録を開始・停止します。
+         * 記録中はワーカーが実行したタスク、Detect と ProcessEvent の各段階、RayCast の区間をスレッドごとに記録します。
+         * @param _enable 記録する場合はtrue
+         */
+        void SetTracing(bool _enable);
+        bool IsTracing() const;
+
+        /**
+         * 記録したトレースを Chrome trace 形式 (JSON) で書き出します。Perfetto や chrome://tracing で読み込めます。
+         * Detect・ProcessEvent・RayCast と同時には呼ばないでください。
+         * @param path 書き出し先
+         * @return 書き出しに成功した場合はtrue
+         */
+        bool WriteTrace(const std::string& path) const;
+
+        /// 記録したトレースを破棄します
+        void ClearTrace();
+
+        /**
+         * 形状の組の狭域判定を差し替えます。
+         * Detect の実行中には呼ばないでください。逆順の組 (b, a) は別に登録する必要があります。
+         * @param a c1 の形状
+         * @param b c2 の形状
+         * @param kernel 判定関数 (nullptr なら既定の判定に戻す)
+         * @return 形状の種類が範囲外の場合はfalse
+         */
+        bool RegisterKernel(Type a, Type b, Kernel kernel);
+
         RayHitData RayCast(const Ray* _ray);
         RayHitData GetNextClosestHitData(float _distance);
 
+        /**
+         * 2つのコライダーをブロードフェーズを通さずに狭域判定します (総当たりの検証用)。
+         * 有効・無効や属性のフィルターは見ません。分離軸の引き継ぎも使いません。
+         * @param c1 1つ目のコライダー
+         * @param c2 2つ目のコライダー
+         * @param contact c1 から c2 への接触情報の出力先 (nullptr なら求めない)
+         * @return 衝突している場合はtrue
+         */
+        bool TestPair(const Collider* c1, const Collider* c2, Contact* contact = nullptr) const;
+
+        /**
+         * レイと1つのコライダーだけを判定します (総当たりの検証用)。
+         * 有効・無効や属性のフィルターは見ません。RayCast と同時には呼ばないでください。
+         * @param _ray レイ
+         * @param _collider 判定するコライダー
+         * @return 最も近い交点 (交差しなければ id が0)
+         */
+        RayHitData TestRay(const Ray* _ray, const Collider* _collider);
+
         Collider* Get(const std::string& uuid);
+        Collider* Get(uint64_t id);
+
+        /**
+         * 球と重なるコライダーを即座に取得します。
+         * 位置・大きさ・回転の変更はすぐに反映されますが、直近の Detect より後に登録したコライダーと属性の変更は次の Detect から反映されます。
+         * クエリ同士はワーカースレッドから同時に呼び出せますが、UpdateTransforms・Detect と同時には呼ばないでください。
+         * @param center 球の中心
+         * @param radius 球の半径
+         * @param out 結果を書き込むバッファ (収まらない分は書き込まれない)
+         * @param attribute クエリの属性 (相手のignoreと一致すると除外)
+         * @param ignore 無視する属性
+         * @return 条件に一致したコライダーの総数
+         */
+        size_t QuerySphere(const Vec3& center, float radius, std::span<Collider*> out, uint32_t attribute = 0, uint32_t ignore = 0);
+
+        /**
+         * AABBと重なるコライダーを即座に取得します。
+         * 位置・大きさ・回転の変更はすぐに反映されますが、直近の Detect より後に登録したコライダーと属性の変更は次の Detect から反映されます。
+         * クエリ同士はワーカースレッドから同時に呼び出せますが、UpdateTransforms・Detect と同時には呼ばないでください。
+         * @param center AABBの中心
+         * @param size AABBの大きさ
+         * @param out 結果を書き込むバッファ (収まらない分は書き込まれない)
+         * @param attribute クエリの属性 (相手のignoreと一致すると除外)
+         * @param ignore 無視する属性
+         * @return 条件に一致したコライダーの総数
+         */
+        size_t QueryAABB(const Vec3& center, const Vec3& size, std::span<Collider*> out, uint32_t attribute = 0, uint32_t ignore = 0);
+
+        /**
+         * 点を含むコライダーを即座に取得します。
+         * 位置・大きさ・回転の変更はすぐに反映されますが、直近の Detect より後に登録したコライダーと属性の変更は次の Detect から反映されます。
+         * クエリ同士はワーカースレッドから同時に呼び出せますが、UpdateTransforms・Detect と同時には呼ばないでください。
+         * @param point 判定する点
+         * @param out 結果を書き込むバッファ (収まらない分は書き込まれない)
+         * @param attribute クエリの属性 (相手のignoreと一致すると除外)
+         * @param ignore 無視する属性
+         * @return 条件に一致したコライダーの総数
+         */
+        size_t QueryPoint(const Vec3& point, std::span<Collider*> out, uint32_t attribute = 0, uint32_t ignore = 0);
+
+        /**
+         * 点に近いコライダーを近い順に取得します (k近傍)。
+         * 位置・大きさ・回転の変更はすぐに反映されますが、直近の Detect より後に登録したコライダーと属性の変更は次の Detect から反映されます。
+         * クエリ同士はワーカースレッドから同時に呼び出せますが、UpdateTransforms・Detect と同時には呼ばないでください。
+         * @param point 基準点
+         * @param maxRadius 探索半径
+         * @param out 結果を書き込むバッファ (要素数が取得数kとなる)
+         * @param attribute クエリの属性 (相手のignoreと一致すると除外)
+         * @param ignore 無視する属性
+         * @return 書き込んだ件数
+         */
+        size_t QueryNearest(const Vec3& point, float maxRadius, std::span<NearestHit> out, uint32_t attribute = 0, uint32_t ignore = 0);
+
+        /**
+         * 平面の集合で囲まれた凸領域 (視錐台など) と重なるコライダーを取得します。
+         * 位置・大きさ・回転の変更はすぐに反映されますが、直近の Detect より後に登録したコライダーと属性の変更は次の Detect から反映されます。
+         * クエリ同士はワーカースレッドから同時に呼び出せますが、UpdateTransforms・Detect と同時には呼ばないでください。
+         * 平面が kMaxQueryPlanes 枚を超える場合は判定せずに0を返します (領域を分けて呼び出してください)。
+         * @param planes 領域を囲む平面 (kMaxQueryPlanes 枚まで, 法線は内側向き)
+         * @param out 結果を書き込むバッファ (収まらない分は書き込まれない)
+         * @param attribute クエリの属性 (相手のignoreと一致すると除外)
+         * @param ignore 無視する属性
+         * @return 条件に一致したコライダーの総数 (平面が多すぎる場合は0)
+         */
+        size_t QueryPlanes(std::span<const Plane> planes, std::span<Collider*> out, uint32_t attribute = 0, uint32_t ignore = 0);
     private:
 
         void  ProcessPendingRegistrations();
-        void AddTask(std::function<void()> task);
-        void WaitForTasks();
-
-    	/**
-         * スレッドプールを初期化します。
+        /// UpdateTransforms で書き換えたブロードフェーズの境界を木に反映します
+        void RefitBroadPhase();
+        /// コライダーの現在の形状でブロードフェーズの境界を書き換えます (木への反映は次のクエリの前)
+        void RefitProxy(const Collider* collider);
+        /**
+         * タスクをスレッドプールに積みます。実行時間をこのワールドの統計とトレースに記録します。
+         * @param task タスク
+         * @param completed 記録まで終えたら増やす数 (これを待てば Manager を破棄してよい)
          */
-        void InitThreadPool();
-        void WorkerThread();
+        void AddTask(std::function<void()> task, std::atomic<uint32_t>& completed);
 
         /**
          * ペアがフィルター条件に一致するか確認します。
-         * @param pair 確認するペア
+         * @param p1 1つ目のプロキシ
+         * @param p2 2つ目のプロキシ
          * @return フィルター条件に一致する場合はtrue
          */
-        bool Filter(const Pair& pair) const;
+        static bool Filter(const BroadPhase::Proxy& p1, const BroadPhase::Proxy& p2);
 
 	    static bool Filter(const Data& data, const Data& other);
 
         /**
-         * 2つのコライダー間の衝突を検出します。
-         * @param c1 1つ目のコライダー
-         * @param c2 2つ目のコライダー
-         * @return 衝突している場合はtrue
+         * 候補ペアを形状の組ごとにまとめて狭域判定します。
+         * @param candidates proxies のインデックスの組 (並べ替えられる)
+         * @param results 衝突したペアの出力先
+         * @param axes 凸包を含むペアの分離軸の出力先
          */
-        static bool Detect(const Collider* c1, const Collider* c2);
+        void DetectCandidates(std::vector<std::pair<uint32_t, uint32_t>>& candidates, std::vector<DetectedPair>& results, std::vector<SeparatingAxis>& axes) const;
 	    void Detect(const Ray* ray, const Collider* collider);
         void RayAABB(const Ray* ray, const Collider* collider);
+        void RayOBB(const Ray* ray, const Collider* collider);
+        void RayCapsule(const Ray* ray, const Collider* collider);
+        void RayHull(const Ray* ray, const Collider* collider);
+        void RayMesh(const Ray* ray, const Collider* collider);
+        void RayHeightField(const Ray* ray, const Collider* collider);
+        void RayCompound(const Ray* ray, const Collider* collider);
         void RaySphere(const Ray* ray, const Collider* collider);
+
+        /**
+         * ブロードフェーズを走査して領域クエリを実行します。
+         * @param bounds 検索範囲
+         * @param out 結果を書き込むバッファ
+         * @param attribute クエリの属性
+         * @param ignore 無視する属性
+         * @param test 候補に対する詳細判定
+         * @return 条件に一致したコライダーの総数
+         */
+        template <typename Test>
+        size_t Query(const Bounds& bounds, std::span<Collider*> out, uint32_t attribute, uint32_t ignore, Test&& test);
     };
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include "BroadPhase.h"
+#include "Mathematics.h"
+
+namespace Collision{
+    /// @brief
+    /// 複数の子形状をまとめた複合形状 (Type::Compound のコライダーの形状)
+    /// 子形状は球とAABBで、子の境界を包む平坦配列の小さなBVHを持つ
+    ///
+    /// 子の位置はコライダーの translate からのオフセットで、回転は持たない。
+    /// ブロードフェーズには全体の境界だけが登録され、衝突イベントは接触した子の番号を返す。
+    /// イベントはコライダー単位で生成されるため、接触する子が入れ替わっても Stay のまま続く。
+    class CompoundShape{
+    public:
+        struct Child{
+            // コライダーの translate からのオフセット
+            Vec3 offset;
+            // 球の半径 (float) または AABBの大きさ (Vec3)
+            std::variant<float, Vec3> size;
+        };
+
+    private:
+        static constexpr uint32_t kLeafSize = 2;
+        static constexpr uint32_t kMaxDepth = 32;
+
+        struct Node{
+            Bounds bounds;
+            // 葉: order_ 上の先頭 / 節: 右の子のインデックス (左の子は常に直後)
+            uint32_t index;
+            // 葉の子形状の数 (節なら0)
+            uint32_t count;
+        };
+
+        std::vector<Child> children_;
+        // 子形状ごとのローカル座標での境界
+        std::vector<Bounds> childBounds_;
+        // BVHの葉の順に並べた子形状の番号
+        std::vector<uint32_t> order_;
+        std::vector<Node> nodes_;
+        Bounds bounds_ {};
+
+    public:
+        /**
+         * 子形状の配列から複合形状を構築します。
+         * @param children 子形状 (配列上の位置がイベントで返される子の番号となる)
+         */
+        explicit CompoundShape(std::span<const Child> children);
+
+        /// ローカル座標での境界
+        const Bounds& GetBounds() const;
+        std::span<const Child> GetChildren() const;
+        /// 子形状のローカル座標での境界
+        const Bounds& GetChildBounds(uint32_t index) const;
+
+        /**
+         * レイと最も近い子形状との交点を求めます (ローカル座標)。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param maxDistance レイの長さ
+         * @param t 交点までの距離の出力先
+         * @param child 交差した子の番号の出力先
+         * @return 交差する場合はtrue
+         */
+        bool RayCast(const Vec3& origin, const Vec3& direction, float maxDistance, float& t, uint32_t& child) const;
+
+        /**
+         * 境界と重なる子形状を列挙します (ローカル座標)。
+         * @param bounds 検索範囲
+         * @param fn 子の番号を受け取る関数 (false を返すと列挙を打ち切る)
+         */
+        template <typename Fn>
+        void Query(const Bounds& bounds, Fn&& fn) const;
+    };
+
+    template <typename Fn>
+    void CompoundShape::Query(const Bounds& bounds, Fn&& fn) const {
+        if (nodes_.empty() || !bounds_.Overlaps(bounds)) return;
+
+        uint32_t stack[kMaxDepth * 2];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top){
+            const uint32_t nodeIndex = stack[--top];
+            const Node& node = nodes_[nodeIndex];
+            if (!node.bounds.Overlaps(bounds)) continue;
+
+            if (node.count){
+                for (uint32_t i = node.index; i < node.index + node.count; ++i){
+                    const uint32_t child = order_[i];
+                    if (childBounds_[child].Overlaps(bounds) && !fn(child)) return;
+                }
+                continue;
+            }
+
+            stack[top++] = node.index;
+            stack[top++] = nodeIndex + 1;
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <span>
+#include <vector>
+
+#include "BroadPhase.h"
+#include "Mathematics.h"
+
+namespace Collision{
+    /// @brief
+    /// 頂点の凸包で表す形状 (Type::ConvexHull のコライダーの形状)
+    /// 狭域判定は頂点のサポート写像を使った GJK/EPA で行う
+    ///
+    /// 頂点はコライダーの translate を原点とするローカル座標で保持し、向きは SetRotate で指定する。
+    /// 凸包の内側にある点は判定結果に影響しないが、サポート写像の走査対象になる。
+    class ConvexHull{
+        std::vector<Vec3> vertices_;
+        Bounds bounds_ {};
+
+    public:
+        /**
+         * 頂点から凸包を構築します。
+         * @param vertices 頂点 (ローカル座標, 1つ以上)
+         */
+        explicit ConvexHull(std::span<const Vec3> vertices);
+
+        /// ローカル座標での境界
+        const Bounds& GetBounds() const;
+        std::span<const Vec3> GetVertices() const;
+
+        /// 方向に最も遠い頂点 (ローカル座標)
+        const Vec3& Support(const Vec3& direction) const;
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Collision{
+    template <typename Signature, size_t Capacity = 64>
+    class Delegate;
+
+    /// @brief
+    /// ヒープ確保をしない呼び出し可能オブジェクト (衝突コールバック用)
+    /// 呼び出し対象は内部の固定長バッファに直接構築し、収まらないものはコンパイルエラーとなる
+    ///
+    /// 呼び出しは間接呼び出し1回で、対象をコピーせずにその場で呼ぶ。
+    /// 移動のみ可能 (コピーすると捕捉した値の確保が起きうるため)。
+    template <typename R, typename... Args, size_t Capacity>
+    class Delegate<R(Args...), Capacity>{
+        enum class Operation{
+            Move,
+            Destroy
+        };
+
+        using Invoke = R(*)(void* target, Args... args);
+        using Manage = void(*)(Operation operation, void* target, void* source);
+
+        alignas(std::max_align_t) std::byte storage_[Capacity];
+        Invoke invoke_ = nullptr;
+        Manage manage_ = nullptr;
+
+        // 関数ポインタと任意の文脈の組
+        struct Bound{
+            R (*function)(void*, Args...);
+            void* context;
+
+            R operator()(Args... args) const {
+                return function(context, std::forward<Args>(args)...);
+            }
+        };
+
+    public:
+        Delegate() = default;
+
+        Delegate(std::nullptr_t) {
+        }
+
+        /**
+         * 呼び出し可能オブジェクトを格納します。
+         * @param function ラムダ式・関数オブジェクト・関数ポインタ
+         */
+        template <typename F>
+            requires (!std::is_same_v<std::remove_cvref_t<F>, Delegate> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+        Delegate(F&& function) {
+            using Target = std::decay_t<F>;
+            static_assert(sizeof(Target) <= Capacity, "コールバックの捕捉が Delegate のバッファに収まりません");
+            static_assert(alignof(Target) <= alignof(std::max_align_t), "コールバックのアラインメントが大きすぎます");
+            static_assert(std::is_nothrow_move_constructible_v<Target>, "コールバックは例外を投げずに移動できる必要があります");
+
+            // 空の関数ポインタや std::function は空の Delegate とする
+            if constexpr (std::is_constructible_v<bool, const Target&>){
+                if (!static_cast<bool>(function)) return;
+            }
+
+            ::new(static_cast<void*>(storage_)) Target(std::forward<F>(function));
+            invoke_ = [](void* target, Args... args) -> R {
+                return std::invoke(*static_cast<Target*>(target), std::forward<Args>(args)...);
+            };
+            manage_ = [](Operation operation, void* target, void* source){
+                if (operation == Operation::Move){
+                    ::new(target) Target(std::move(*static_cast<Target*>(source)));
+                }
+                static_cast<Target*>(operation == Operation::Move ? source : target)->~Target();
+            };
+        }
+
+        /**
+         * 関数ポインタと文脈の組を格納します。
+         * @param function 文脈を第1引数に受け取る関数
+         * @param context function に渡す文脈
+         */
+        Delegate(R (*function)(void*, Args...), void* context)
+            :Delegate(function ? Delegate(Bound {function, context}) : Delegate()) {
+        }
+
+        Delegate(Delegate&& other) noexcept {
+            MoveFrom(other);
+        }
+
+        Delegate& operator=(Delegate&& other) noexcept {
+            if (this != &other){
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+
+        Delegate(const Delegate&) = delete;
+        Delegate& operator=(const Delegate&) = delete;
+
+        ~Delegate() {
+            Reset();
+        }
+
+        explicit operator bool() const {
+            return invoke_ != nullptr;
+        }
+
+        /// 格納した対象をその場で呼び出します (空なら未定義)
+        R operator()(Args... args) const {
+            return invoke_(const_cast<std::byte*>(storage_), std::forward<Args>(args)...);
+        }
+
+        void Reset() {
+            if (manage_) manage_(Operation::Destroy, storage_, nullptr);
+            invoke_ = nullptr;
+            manage_ = nullptr;
+        }
+
+    private:
+        void MoveFrom(Delegate& other) {
+            if (!other.invoke_) return;
+            other.manage_(Operation::Move, storage_, other.storage_);
+            invoke_ = other.invoke_;
+            manage_ = other.manage_;
+            other.invoke_ = nullptr;
+            other.manage_ = nullptr;
+        }
+    };
+}
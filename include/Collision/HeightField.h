@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BroadPhase.h"
+#include "Mathematics.h"
+
+namespace Collision{
+    /// @brief
+    /// 等間隔格子の高さで表す地形 (Type::HeightField のコライダーの形状)
+    /// 高さは16bitで保持し、各セルは (0,0)-(1,1) の対角線で2枚の三角形に分割される
+    ///
+    /// ローカル座標の原点が格子の (0, 0) の角で、X と Z の正の向きへ広がる。
+    /// 地表より下は中身が詰まっているものとして扱う。
+    class HeightField{
+        uint32_t width_ = 0;
+        uint32_t depth_ = 0;
+        float cellSize_ = 1.f;
+        float heightScale_ = 1.f;
+        float heightOffset_ = 0.f;
+        // 自身で保持する場合の高さ (外部のメモリを参照する場合は空)
+        std::vector<uint16_t> heightStorage_;
+        // 外部のメモリを参照する場合にその寿命を保つ
+        std::shared_ptr<const void> external_;
+        // depth_ 行 x width_ 列 (行優先)
+        std::span<const uint16_t> heights_;
+        Bounds bounds_ {};
+
+    public:
+        /**
+         * 高さの配列から地形を構築します。
+         * @param width X方向のサンプル数 (2以上)
+         * @param depth Z方向のサンプル数 (2以上)
+         * @param cellSize サンプルの間隔
+         * @param heightScale 高さの1目盛りの大きさ
+         * @param heightOffset 高さ0のときのY座標
+         * @param heights width * depth 個の高さ (行優先, Z方向に進むごとに width 個)
+         */
+        HeightField(uint32_t width, uint32_t depth, float cellSize, float heightScale, float heightOffset, std::span<const uint16_t> heights);
+
+        /**
+         * 高さの配列をコピーせずに参照して地形を作ります。
+         * @param external heights を含むメモリの寿命を保つポインタ
+         */
+        HeightField(uint32_t width, uint32_t depth, float cellSize, float heightScale, float heightOffset, std::span<const uint16_t> heights, std::shared_ptr<const void> external);
+
+        // 高さを自身の vector で持つ場合に参照がずれるため
+        HeightField(const HeightField&) = delete;
+        HeightField& operator=(const HeightField&) = delete;
+
+        /// ローカル座標での境界
+        const Bounds& GetBounds() const;
+        uint32_t GetWidth() const;
+        uint32_t GetDepth() const;
+        float GetCellSize() const;
+        float GetHeightScale() const;
+        float GetHeightOffset() const;
+        /// 高さの配列 (行優先, スナップショットへの書き出し用)
+        std::span<const uint16_t> GetHeights() const;
+
+        /**
+         * 地表の高さを取得します (ローカル座標)。
+         * @param x X座標
+         * @param z Z座標
+         * @param height 高さの出力先
+         * @return 格子の範囲内ならtrue
+         */
+        bool GetHeight(float x, float z, float& height) const;
+
+        /// 点が地表より下にあるか (格子の範囲外ならfalse)
+        bool IsBelow(const Vec3& point) const;
+
+        /**
+         * レイと地表との交点を求めます (ローカル座標)。
+         * 格子上をDDAで辿り、レイが通るセルのみを判定します。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param maxDistance レイの長さ
+         * @param t 交点までの距離の出力先
+         * @return 交差する場合はtrue
+         */
+        bool RayCast(const Vec3& origin, const Vec3& direction, float maxDistance, float& t) const;
+
+        bool OverlapSphere(const Vec3& center, float radius) const;
+        bool OverlapAABB(const Vec3& min, const Vec3& max) const;
+
+        /**
+         * 点に最も近い地表上の点を求めます (ローカル座標)。
+         * @param point 基準点
+         * @param maxDistance 探索半径
+         * @param closest 最近点の出力先
+         * @return 最近点までの距離 (探索半径内に無ければ負の値)
+         */
+        float ClosestPoint(const Vec3& point, float maxDistance, Vec3& closest) const;
+
+        /**
+         * 境界の下にあるセルの三角形を列挙します (ローカル座標)。
+         * @param bounds 検索範囲
+         * @param fn 三角形の3頂点を受け取る関数 (false を返すと列挙を打ち切る)
+         */
+        template <typename Fn>
+        void Query(const Bounds& bounds, Fn&& fn) const;
+
+    private:
+        void ComputeBounds();
+        float Sample(uint32_t x, uint32_t z) const;
+        Vec3 Vertex(uint32_t x, uint32_t z) const;
+
+        // セルの範囲 (境界が格子の外なら false)
+        bool CellRange(const Bounds& bounds, uint32_t& x0, uint32_t& z0, uint32_t& x1, uint32_t& z1) const;
+
+        // セルの2枚の三角形を渡す (false を返したら打ち切り)
+        template <typename Fn>
+        bool ForEachCellTriangle(uint32_t x, uint32_t z, Fn&& fn) const;
+    };
+
+    template <typename Fn>
+    bool HeightField::ForEachCellTriangle(uint32_t x, uint32_t z, Fn&& fn) const {
+        const Vec3 v00 = Vertex(x, z);
+        const Vec3 v10 = Vertex(x + 1, z);
+        const Vec3 v01 = Vertex(x, z + 1);
+        const Vec3 v11 = Vertex(x + 1, z + 1);
+        // どちらも法線が +Y を向く巻き順
+        return fn(v00, v01, v11) && fn(v00, v11, v10);
+    }
+
+    template <typename Fn>
+    void HeightField::Query(const Bounds& bounds, Fn&& fn) const {
+        uint32_t x0, z0, x1, z1;
+        if (!CellRange(bounds, x0, z0, x1, z1)) return;
+
+        for (uint32_t z = z0; z <= z1; ++z){
+            for (uint32_t x = x0; x <= x1; ++x){
+                // セルの高さの範囲と重ならなければ三角形を作らない
+                const float h00 = Sample(x, z);
+                const float h10 = Sample(x + 1, z);
+                const float h01 = Sample(x, z + 1);
+                const float h11 = Sample(x + 1, z + 1);
+                if (std::max({h00, h10, h01, h11}) < bounds.min.y || bounds.max.y < std::min({h00, h10, h01, h11})) continue;
+
+                if (!ForEachCellTriangle(x, z, fn)) return;
+            }
+        }
+    }
+}
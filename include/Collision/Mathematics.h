@@ -74,6 +74,12 @@ namespace Collision {// 3次元ベクトル
 		bool operator!=(const Vec3i& other) const;
 	};
 
+	// 平面 (normal・p + distance >= 0 の側を内側とする)
+	struct Plane{
+		Vec3 normal;
+		float distance;
+	};
+
 	// 外部ストリーム出力演算子
 	inline std::ostream& operator<<(std::ostream& os, const Vec3& v) {
 		os << "(" << v.x << ", " << v.y << ", " << v.z << ")";
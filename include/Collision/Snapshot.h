@@ -0,0 +1,191 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "BroadPhase.h"
+#include "Collider.h"
+
+namespace Collision{
+    class Manager;
+
+    /// @brief
+    /// コライダーの集合を書き出したバイナリファイル (スナップショット) をメモリマップで読み込む
+    ///
+    /// ファイルはコライダーの配列、共有形状の表、形状の配列、記録したフレームの更新からなる。
+    /// 三角形メッシュは構築済みの BVH ごと、地形は高さの配列を書き出し、読み込み時はマップした
+    /// メモリをコピーせずに参照するため、Open の直後から再構築なしで使える。
+    /// ファイルは書き出した環境と同じエンディアン・同じビルドで読み込む前提で、内容の検証は範囲の確認のみ行う。
+    class Snapshot{
+    public:
+        static constexpr uint32_t kMagic = 0x4E534C43; // "CLSN"
+        static constexpr uint32_t kVersion = 1;
+
+        // ファイルの先頭 (各配列の位置はファイル先頭からのバイト数)
+        struct Header{
+            uint32_t magic;
+            uint32_t version;
+            uint32_t colliderCount;
+            uint32_t shapeCount;
+            uint32_t frameCount;
+            uint32_t updateCount;
+            uint64_t collidersOffset;
+            uint64_t shapesOffset;
+            uint64_t framesOffset;
+            uint64_t updatesOffset;
+            uint64_t fileSize;
+        };
+
+        // 形状を持たない場合の ColliderRecord::shape
+        static constexpr uint32_t kNoShape = UINT32_MAX;
+
+        struct ColliderRecord{
+            Vec3 translate;
+            Vec3 rotate;
+            // float: 半径 / Vec3: 大きさ / CapsuleSize: 半径と長さ
+            float size[3];
+            // 共有形状の表の番号 (float, Vec3, CapsuleSize なら kNoShape)
+            uint32_t shape;
+            uint32_t attribute;
+            uint32_t ignore;
+            // Type の値
+            uint8_t type;
+            // Collider::Size の variant の番号
+            uint8_t sizeIndex;
+            uint8_t enabled;
+            uint8_t padding;
+        };
+
+        // 共有形状 (TriangleMesh, HeightField, CompoundShape, ConvexHull)
+        struct ShapeRecord{
+            // Collider::Size の variant の番号
+            uint32_t sizeIndex;
+            // メッシュ: 頂点数, 三角形数, ノード数 / 地形: 幅, 奥行き / 複合形状: 子の数 / 凸包: 頂点数
+            uint32_t counts[3];
+            // counts の配列の位置
+            uint64_t offsets[3];
+            // 地形: セルの大きさ, 高さの倍率, 高さのオフセット
+            float parameters[3];
+            uint32_t padding;
+            // メッシュのローカル座標での境界
+            Bounds bounds;
+        };
+
+        // 複合形状の子 (ShapeRecord::offsets[0] に並ぶ)
+        struct ChildRecord{
+            Vec3 offset;
+            float size[3];
+            // 0: 球 / 1: AABB
+            uint32_t kind;
+        };
+
+        // 1フレームの更新 (FrameRecord::first から count 個)
+        struct FrameRecord{
+            uint32_t first;
+            uint32_t count;
+        };
+
+        // 変化したコライダーの更新
+        struct UpdateRecord{
+            // コライダーの番号 (ColliderRecord の順)
+            uint32_t collider;
+            // kRotate | kEnable
+            uint32_t flags;
+            Vec3 translate;
+            Vec3 rotate;
+        };
+        // UpdateRecord::flags: 回転も変化した
+        static constexpr uint32_t kRotate = 1u << 0;
+        // UpdateRecord::flags: 有効である
+        static constexpr uint32_t kEnable = 1u << 1;
+
+    private:
+        // マップしたファイル (解放するとマップを解除する)
+        std::shared_ptr<const std::byte> mapping_;
+        size_t size_ = 0;
+        const Header* header_ = nullptr;
+        // 表の順に復元した共有形状 (メッシュと地形はマップを参照する)
+        std::vector<Collider::Size> shapes_;
+
+        // ApplyFrame で毎回使う作業領域
+        std::vector<Collider*> moved_;
+        std::vector<Vec3> translates_;
+
+    public:
+        /**
+         * ファイルをメモリマップで開きます。メッシュと地形はコピーせずに参照します。
+         * @param path 読み込むファイル
+         * @return 形式が正しく開けた場合はtrue
+         */
+        bool Open(const std::string& path);
+
+        /// マップを解放します (読み込んだ形状を参照するコライダーがあれば、その形状が破棄されるまで残る)
+        void Close();
+        bool IsOpen() const;
+
+        size_t GetColliderCount() const;
+        size_t GetFrameCount() const;
+        std::span<const ColliderRecord> GetColliders() const;
+        /// 記録したフレームの更新
+        std::span<const UpdateRecord> GetFrame(size_t frame) const;
+
+        /**
+         * スナップショットのコライダーをプールからまとめて生成し、まとめて登録します。
+         * ID は生成し直され、owner とコールバックは設定されません。
+         * @param manager 登録先
+         * @param out 生成したコライダーの出力先 (GetColliderCount 個, ファイルと同じ順)
+         */
+        void Load(Manager& manager, std::span<Collider*> out) const;
+
+        /**
+         * 記録したフレームの更新を Load で生成したコライダーに適用します。
+         * 位置は Manager::UpdateTransforms でまとめて更新します。
+         * @param manager Load で登録した Manager
+         * @param frame フレームの番号
+         * @param colliders Load で生成したコライダー
+         */
+        void ApplyFrame(Manager& manager, size_t frame, std::span<Collider* const> colliders);
+
+    private:
+        // 配列がファイルに収まっていれば先頭を返す
+        template <typename T>
+        const T* Section(uint64_t offset, uint64_t count) const;
+        bool LoadShapes();
+        // コライダーの形状の種類と共有形状の番号が範囲内か
+        bool ValidateColliders() const;
+    };
+
+    /// @brief
+    /// コライダーの集合を Snapshot の形式で書き出す
+    /// 生成時の状態を初期状態とし、RecordFrame のたびに前回から変化したコライダーを記録する。
+    class SnapshotWriter{
+        std::vector<Collider*> colliders_;
+        std::vector<Snapshot::ColliderRecord> records_;
+        // 共有形状 (records_ の shape の順)
+        std::vector<Collider::Size> shapes_;
+        std::vector<Snapshot::FrameRecord> frames_;
+        std::vector<Snapshot::UpdateRecord> updates_;
+        // 直前に記録したコライダーの状態
+        std::vector<Snapshot::UpdateRecord> last_;
+
+    public:
+        /**
+         * コライダーの現在の状態を初期状態として取り込みます。
+         * @param colliders 書き出すコライダー (RecordFrame を呼ぶ間は生存していること)
+         */
+        explicit SnapshotWriter(std::span<Collider* const> colliders);
+
+        /// 前回の記録から位置・回転・有効状態が変化したコライダーを1フレームとして記録します
+        void RecordFrame();
+
+        /**
+         * ファイルに書き出します。
+         * @param path 書き出し先
+         * @return 書き出しに成功した場合はtrue
+         */
+        bool Write(const std::string& path) const;
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// 0 を定義すると統計の計測をコンパイル時に取り除く (GetStats は常にゼロを返す)
+#ifndef COLLISION_ENABLE_STATS
+#define COLLISION_ENABLE_STATS 1
+#endif
+
+namespace Collision{
+    // 統計を計測する処理の段階
+    enum class Phase{
+        // 遅延登録・遅延解除の適用
+        Registration,
+        // ブロードフェーズの再構築
+        BroadPhase,
+        // 候補ペアの列挙と狭域判定 (全タスクの完了待ちまで)
+        NarrowPhase,
+        // スレッドごとの結果のマージとソート
+        Merge,
+        // 前回の結果との差分によるイベント生成
+        EventDiff,
+        // コールバックの呼び出し
+        Dispatch,
+        // RayCast (フレーム内の合計)
+        RayCast,
+
+        Count
+    };
+
+    /// @brief
+    /// 1フレーム分の統計 (Detect の開始時にリセットされ、次の Detect まで値が積み上がる)
+    struct FrameStats{
+        // 段階ごとの所要時間 (ナノ秒, Phase の順)
+        std::array<uint64_t, static_cast<size_t>(Phase::Count)> phaseNanoseconds {};
+        // ブロードフェーズで重なりフィルターを通過したペア数
+        uint64_t candidatePairs = 0;
+        // 狭域判定で衝突が確定したペア数
+        uint64_t confirmedPairs = 0;
+        // ブロードフェーズに登録したプロキシ数
+        uint32_t proxies = 0;
+        // 生成したイベント数 (EventType の順)
+        std::array<uint32_t, 3> events {};
+        uint32_t rayCasts = 0;
+        // ワーカースレッドごとのこのワールドのタスク実行時間 (ナノ秒, Detect 内の合計。共有プールでは他のワールドの分を含まない。最後の要素は Detect を呼んだスレッドが手伝った分)
+        std::vector<uint64_t> workerBusyNanoseconds;
+
+        uint64_t GetPhaseNanoseconds(Phase phase) const {
+            return phaseNanoseconds[static_cast<size_t>(phase)];
+        }
+    };
+}
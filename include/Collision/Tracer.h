@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Collision{
+    /// @brief
+    /// スレッドごとの区間 (開始・終了時刻) を記録し、Chrome trace 形式の JSON に書き出すトレーサー
+    ///
+    /// 区間は記録したスレッド専用のリングバッファに書き込むため、記録時にロックは取らない
+    /// (ロックを取るのは各スレッドがこの Tracer に最初に記録するときだけ。多数の Tracer を行き来するスレッドでは取り直すことがある)。
+    /// バッファが一杯になると古い区間から上書きされる。
+    class Tracer{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // スレッドごとに保持する区間の数
+        static constexpr uint32_t kCapacity = 1u << 14;
+
+        // 区間に添える数値 (name が nullptr なら無し, {} で無しになる)
+        struct Arg{
+            const char* name;
+            uint64_t value;
+        };
+
+        struct Span{
+            // 静的な文字列 (ポインタのまま保持する)
+            const char* name;
+            // Clock の起点からのナノ秒
+            uint64_t begin;
+            uint64_t end;
+            std::array<Arg, 2> args;
+        };
+
+    private:
+        struct Buffer{
+            std::thread::id thread;
+            // 書き出し時のスレッド番号 (登録順)
+            uint32_t index;
+            // スレッドの表示名 (空なら番号から作る)
+            std::string name;
+            std::unique_ptr<Span[]> spans;
+            // これまでに書き込んだ区間の総数 (書き込むのは所有スレッドのみ)
+            std::atomic<uint64_t> written {0};
+        };
+
+        // thread_local のキャッシュを Tracer ごとに区別するための番号
+        const uint64_t serial_;
+        std::atomic<bool> enabled_ {false};
+        std::vector<std::unique_ptr<Buffer>> buffers_;
+        mutable std::mutex mutex_;
+
+    public:
+        Tracer();
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        void SetEnabled(bool enabled);
+        bool IsEnabled() const {
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * 呼び出したスレッドのバッファに区間を記録します。
+         * @param name 区間の名前 (静的な文字列)
+         * @param begin 開始時刻
+         * @param end 終了時刻
+         * @param args 区間に添える数値
+         */
+        void Record(const char* name, Clock::time_point begin, Clock::time_point end, std::array<Arg, 2> args = {});
+
+        /**
+         * 呼び出したスレッドの表示名を設定します。
+         * すべての Tracer で共通で、このスレッドが初めて記録するときのバッファに使われます
+         * (ワーカーは複数の Manager のタスクを実行するため、スレッド側で名前を持つ)。
+         * @param name 表示名
+         */
+        static void SetThreadName(std::string name);
+
+        /**
+         * 記録した区間を Chrome trace 形式 (JSON) で書き出します。
+         * 記録中のスレッドがあると書き出し中に上書きされた区間が混ざることがあるため、処理の合間に呼んでください。
+         * @param path 書き出し先
+         * @return 書き出しに成功した場合はtrue
+         */
+        bool Write(const std::string& path) const;
+
+        /// 記録した区間を破棄します (記録中のスレッドがない時に呼んでください)
+        void Clear();
+
+    private:
+        Buffer& GetBuffer();
+    };
+}
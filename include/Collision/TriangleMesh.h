@@ -0,0 +1,161 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "BroadPhase.h"
+#include "Mathematics.h"
+
+namespace Collision{
+    /// @brief
+    /// 静的な三角形メッシュ (Type::Mesh のコライダーの形状)
+    /// 三角形を包む平坦配列のBVHを持ち、ノードの境界はメッシュ全体の境界に対して16bitで量子化される
+    ///
+    /// 頂点はメッシュのローカル座標 (コライダーの translate が原点) で保持する。
+    /// 構築後は変更できないため、複数のコライダーで shared_ptr として共有できる。
+    /// 構築済みの配列を外部のメモリ (スナップショットのマップなど) から参照することもできる。
+    class TriangleMesh{
+    public:
+        static constexpr uint32_t kLeafSize = 4;
+
+        struct Node{
+            // メッシュ境界を 65535 分割した格子上の境界 (外側へ丸める)
+            uint16_t min[3];
+            uint16_t max[3];
+            // 葉: 先頭の三角形 << 3 | 三角形数 (1..kLeafSize)
+            // 節: 右の子のインデックス << 3 (左の子は常に直後)
+            uint32_t data;
+        };
+
+        // 構築済みのメッシュの配列 (GetPrebuilt で取得し、そのまま書き出して読み戻せる)
+        struct Prebuilt{
+            std::span<const Vec3> vertices;
+            std::span<const std::array<uint32_t, 3>> triangles;
+            std::span<const Node> nodes;
+            Bounds bounds;
+        };
+
+    private:
+        static constexpr uint32_t kMaxDepth = 64;
+
+        // 自身で構築した場合の配列 (外部のメモリを参照する場合は空)
+        std::vector<Vec3> vertexStorage_;
+        std::vector<std::array<uint32_t, 3>> triangleStorage_;
+        std::vector<Node> nodeStorage_;
+        // 外部のメモリを参照する場合にその寿命を保つ
+        std::shared_ptr<const void> external_;
+
+        std::span<const Vec3> vertices_;
+        // BVHの葉の順に並べた三角形の頂点番号
+        std::span<const std::array<uint32_t, 3>> triangles_;
+        std::span<const Node> nodes_;
+        Bounds bounds_ {};
+        // 量子化の1目盛りの大きさ
+        Vec3 scale_ {};
+
+    public:
+        /**
+         * 頂点と頂点番号からメッシュを構築します。
+         * 頂点番号が IsValid で通らない場合は、範囲外を参照しないよう三角形を持たない空のメッシュになります。
+         * @param vertices 頂点 (ローカル座標)
+         * @param indices 三角形ごとに3つずつ並べた頂点番号
+         */
+        TriangleMesh(std::span<const Vec3> vertices, std::span<const uint32_t> indices);
+
+        /**
+         * 構築済みの配列をコピーせずに参照してメッシュを作ります (BVH の再構築もしない)。
+         * @param prebuilt GetPrebuilt で得た配列と同じ内容
+         * @param external 配列を含むメモリの寿命を保つポインタ
+         */
+        TriangleMesh(const Prebuilt& prebuilt, std::shared_ptr<const void> external);
+
+        // 配列を自身の vector で持つ場合に参照がずれるため
+        TriangleMesh(const TriangleMesh&) = delete;
+        TriangleMesh& operator=(const TriangleMesh&) = delete;
+
+        /**
+         * 構築済みの配列が壊れていないか確認します (ファイルから読んだ配列を参照する前に使う)。
+         * 頂点番号・葉の三角形の範囲・子の番号と BVH の深さを調べます。
+         * @param prebuilt 確認する配列
+         * @return 範囲外を参照しない場合はtrue
+         */
+        static bool IsValid(const Prebuilt& prebuilt);
+
+        /**
+         * 構築に使う頂点番号が正しいか確認します。
+         * @param vertices 頂点
+         * @param indices 三角形ごとに3つずつ並べた頂点番号
+         * @return 3の倍数個 (三角形は 2^29 個未満) で、すべて頂点の範囲内にある場合はtrue
+         */
+        static bool IsValid(std::span<const Vec3> vertices, std::span<const uint32_t> indices);
+
+        /// ローカル座標での境界
+        const Bounds& GetBounds() const;
+        size_t GetTriangleCount() const;
+        /// 構築済みの配列 (スナップショットへの書き出し用)
+        Prebuilt GetPrebuilt() const;
+
+        /**
+         * レイと最も近い三角形との交点を求めます (ローカル座標)。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param maxDistance レイの長さ
+         * @param t 交点までの距離の出力先
+         * @return 交差する場合はtrue
+         */
+        bool RayCast(const Vec3& origin, const Vec3& direction, float maxDistance, float& t) const;
+
+        bool OverlapSphere(const Vec3& center, float radius) const;
+        bool OverlapAABB(const Vec3& min, const Vec3& max) const;
+
+        /**
+         * 点に最も近いメッシュ上の点を求めます (ローカル座標)。
+         * @param point 基準点
+         * @param maxDistance 探索半径
+         * @param closest 最近点の出力先
+         * @return 最近点までの距離 (探索半径内に無ければ負の値)
+         */
+        float ClosestPoint(const Vec3& point, float maxDistance, Vec3& closest) const;
+
+        /**
+         * 境界と重なる葉の三角形を列挙します (ローカル座標)。
+         * @param bounds 検索範囲
+         * @param fn 三角形の3頂点を受け取る関数 (false を返すと列挙を打ち切る)
+         */
+        template <typename Fn>
+        void Query(const Bounds& bounds, Fn&& fn) const;
+
+    private:
+        Bounds Dequantize(const Node& node) const;
+    };
+
+    template <typename Fn>
+    void TriangleMesh::Query(const Bounds& bounds, Fn&& fn) const {
+        if (nodes_.empty() || !bounds_.Overlaps(bounds)) return;
+
+        uint32_t stack[kMaxDepth * 2];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top){
+            const uint32_t nodeIndex = stack[--top];
+            const Node& node = nodes_[nodeIndex];
+            if (!Dequantize(node).Overlaps(bounds)) continue;
+
+            const uint32_t count = node.data & 0x7;
+            if (count){
+                const uint32_t first = node.data >> 3;
+                for (uint32_t i = first; i < first + count; ++i){
+                    const auto& triangle = triangles_[i];
+                    if (!fn(vertices_[triangle[0]], vertices_[triangle[1]], vertices_[triangle[2]])) return;
+                }
+                continue;
+            }
+
+            stack[top++] = node.data >> 3;
+            stack[top++] = nodeIndex + 1;
+        }
+    }
+}
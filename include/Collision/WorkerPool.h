@@ -0,0 +1,64 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Collision{
+    /// @brief
+    /// 複数の Manager (ワールド) で共有できるワーカースレッドのプール
+    ///
+    /// 各 Manager は Detect のタスクを積み、自分のタスクの完了だけを待つ。
+    /// プールが持つのはタスクのキューだけなので、ワールド同士がロックを共有するのはタスクの出し入れの間だけになる。
+    class WorkerPool{
+    public:
+        // 実行したワーカーの番号を受け取るタスク (0 から GetThreadCount() - 1、Wait で手伝ったスレッドは GetThreadCount())
+        using Task = std::function<void(uint32_t worker)>;
+
+    private:
+        std::vector<std::thread> threads_;
+        std::queue<Task> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        // タスクが1つ終わるたびに Wait している側を起こす
+        std::condition_variable finished_;
+        bool running_ = true;
+
+    public:
+        /**
+         * ワーカースレッドを起動します。
+         * @param threadCount スレッド数 (0 ならハードウェアのスレッド数)
+         */
+        explicit WorkerPool(uint32_t threadCount = 0);
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        /// 積まれているタスクをすべて実行してからスレッドを終了します
+        ~WorkerPool();
+
+        /// タスクを積みます (どのスレッドからでも呼べる)
+        void Submit(Task task);
+
+        /**
+         * done が true を返すまで、積まれているタスクを呼び出したスレッドでも実行しながら待ちます。
+         * 手伝うタスクは他のワールドのものでもよく、ワーカーの番号として GetThreadCount() を渡します。
+         * @param done 待ち終える条件 (プールのロック中に、タスクが終わるたびに評価する)
+         */
+        void Wait(const std::function<bool()>& done);
+
+        uint32_t GetThreadCount() const;
+
+        /**
+         * プロセスで共有する既定のプールを取得します。
+         * 使っている Manager がなくなると破棄され、次に呼ばれたときに作り直されます。
+         * @return 既定のプール
+         */
+        static std::shared_ptr<WorkerPool> GetShared();
+
+    private:
+        void WorkerThread(uint32_t index);
+    };
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Mathematics.h"
+#include "Snapshot.h"
+#include "WorkerPool.h"
+
+namespace Collision{
+    class Manager;
+    class Collider;
+
+    /// @brief
+    /// 静的なコライダーを空間のセル単位で読み込み・破棄するストリーミング層
+    ///
+    /// セルごとにスナップショット (Snapshot) のファイルを割り当てておき、Update に渡した注目点の周囲のセルだけを
+    /// Manager に登録する。ファイルのマップと形状の準備は専用の読み込みスレッドで行い、準備が済んだセルは
+    /// 次の Update でまとめて生成・登録する (RegisterMany の1回)。離れたセルは UnregisterMany でまとめて解除する。
+    ///
+    /// Update とデストラクタは Manager の Detect・ProcessEvent と同じスレッドから呼んでください。
+    class WorldStreamer{
+    public:
+        struct Settings{
+            // セルの1辺の大きさ
+            float cellSize = 64.f;
+            // 注目点のセルからこのセル数以内を読み込む (各軸)
+            int32_t loadRadius = 1;
+            // 注目点のセルからこのセル数より離れたら破棄する (loadRadius 以上, 境界での読み込みの繰り返しを防ぐ)
+            int32_t unloadRadius = 2;
+            // 1回の Update で登録するセルの上限 (0 なら無制限, 登録の負荷をフレームに分散する)
+            uint32_t maxActivationsPerUpdate = 0;
+        };
+
+        enum class CellState{
+            // 読み込んでいない
+            Unloaded,
+            // 読み込みスレッドで準備中
+            Preparing,
+            // 準備が済み、登録を待っている
+            Prepared,
+            // Manager に登録済み
+            Active,
+            // ファイルを開けなかった (AddCell で登録し直すまで再試行しない)
+            Failed
+        };
+
+    private:
+        struct CellHash{
+            size_t operator()(const Vec3i& cell) const {
+                return static_cast<size_t>(cell.x) * 73856093u ^ static_cast<size_t>(cell.y) * 19349663u ^ static_cast<size_t>(cell.z) * 83492791u;
+            }
+        };
+
+        struct Cell{
+            Vec3i key;
+            std::string path;
+            // 読み込みスレッドが Prepared または Failed にする
+            std::atomic<CellState> state {CellState::Unloaded};
+            // Preparing の間は読み込みスレッドだけが触る
+            Snapshot snapshot;
+            std::vector<Collider*> colliders;
+        };
+
+        Manager& manager_;
+        Settings settings_;
+        std::unordered_map<Vec3i, std::unique_ptr<Cell>, CellHash> cells_;
+        // Unloaded と Failed 以外のセル
+        std::vector<Cell*> resident_;
+        // Update で使う作業領域
+        std::vector<Vec3i> wanted_;
+        // セルの準備を行うスレッド (Detect のワーカーを IO で塞がないよう分ける, cells_ より先に破棄する)
+        WorkerPool loader_ {1};
+
+    public:
+        /**
+         * @param manager セルのコライダーを登録する Manager
+         * @param settings セルの大きさと読み込む範囲
+         */
+        WorldStreamer(Manager& manager, const Settings& settings);
+        WorldStreamer(const WorldStreamer&) = delete;
+        WorldStreamer& operator=(const WorldStreamer&) = delete;
+        /// 登録中のセルのコライダーを破棄します
+        ~WorldStreamer();
+
+        /**
+         * セルにスナップショットのファイルを割り当てます。
+         * 登録中のセルに割り当て直した場合は、次に読み込むときから使われます。
+         * @param cell セルの座標 (位置をセルの大きさで割って切り捨てたもの)
+         * @param path スナップショットのファイル
+         * @return 準備中のセルで割り当て直せない場合はfalse
+         */
+        bool AddCell(const Vec3i& cell, std::string path);
+
+        /**
+         * 注目点の周囲のセルを読み込み、離れたセルを破棄します。
+         * 準備が済んでいないセルは読み込みスレッドに依頼し、以降の Update で登録します。
+         * @param points 注目点 (プレイヤーやカメラの位置など)
+         */
+        void Update(std::span<const Vec3> points);
+
+        /// 位置を含むセルの座標
+        Vec3i CellOf(const Vec3& point) const;
+        CellState GetState(const Vec3i& cell) const;
+        /// 登録中のセルのコライダー (ファイルと同じ順, 登録中でなければ空)
+        std::span<Collider* const> GetColliders(const Vec3i& cell) const;
+        /// 登録中のセルの数
+        size_t GetActiveCellCount() const;
+
+    private:
+        void Prepare(Cell& cell);
+        void Activate(Cell& cell);
+        void Deactivate(Cell& cell);
+        // 注目点のいずれかから radius セル以内か
+        bool IsWithin(const Vec3i& cell, std::span<const Vec3i> centers, int32_t radius) const;
+    };
+}
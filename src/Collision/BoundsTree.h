@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Collision/BroadPhase.h"
+#include "Collision/Mathematics.h"
+
+/// @brief
+/// 形状が持つBVH (TriangleMesh・CompoundShape) の構築と走査で共有する補助関数
+namespace Collision{
+    /// axis 番目 (0: x, 1: y, 2: z) の成分
+    inline float Component(const Vec3& v, int axis) {
+        return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+    }
+
+    /**
+     * レイと境界のスラブ判定を行います。
+     * @param origin レイの原点
+     * @param inverse レイの方向の逆数
+     * @param bounds 判定する境界
+     * @param maxDistance 判定する距離の上限
+     * @return 境界に入る距離 (原点が内側なら0, 交差しなければ負の値)
+     */
+    inline float RayBounds(const Vec3& origin, const Vec3& inverse, const Bounds& bounds, float maxDistance) {
+        float tmin = 0.f;
+        float tmax = maxDistance;
+        for (int axis = 0; axis < 3; ++axis){
+            const float o = Component(origin, axis);
+            const float inv = Component(inverse, axis);
+            float t1 = (Component(bounds.min, axis) - o) * inv;
+            float t2 = (Component(bounds.max, axis) - o) * inv;
+            if (t1 > t2) std::swap(t1, t2);
+            // 0 * inf で NaN になった場合はその軸を無視する
+            if (t1 == t1) tmin = std::max(tmin, t1);
+            if (t2 == t2) tmax = std::min(tmax, t2);
+            if (tmax < tmin) return -1.f;
+        }
+        return tmin;
+    }
+
+    /**
+     * 要素の境界から、重心の広がりが最大の軸で中央値分割したBVHを前順に構築します。
+     * 左の子は常に節の直後に置き、節には右の子の番号を持たせます (中央値分割なので深さは要素数の対数に収まる)。
+     * @param nodes 節の出力先
+     * @param order 要素の番号 ([begin, end) を葉の順に並べ替える)
+     * @param elementBounds 要素ごとの境界 (要素の番号で引く)
+     * @param begin order 上の範囲の先頭
+     * @param end order 上の範囲の終端
+     * @param makeNode 節を作る関数 (範囲の境界, 葉なら order 上の先頭・節なら右の子の番号, 葉の要素数・節なら0)
+     * @param depth 範囲の深さ
+     * @return 作った節の番号
+     */
+    template <uint32_t kLeafSize, uint32_t kMaxDepth, typename Node, typename MakeNode>
+    uint32_t BuildMedianSplit(std::vector<Node>& nodes, std::span<uint32_t> order, std::span<const Bounds> elementBounds,
+                              uint32_t begin, uint32_t end, const MakeNode& makeNode, uint32_t depth = 0) {
+        const uint32_t self = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({});
+
+        Bounds bounds = elementBounds[order[begin]];
+        Bounds centroids {bounds.Center(), bounds.Center()};
+        for (uint32_t i = begin + 1; i < end; ++i){
+            const Bounds& element = elementBounds[order[i]];
+            bounds = bounds.Merge(element);
+            const Vec3 center = element.Center();
+            centroids = centroids.Merge({center, center});
+        }
+
+        // 葉 (中央値分割なので深さの上限には達しない)
+        if (end - begin <= kLeafSize){
+            nodes[self] = makeNode(bounds, begin, end - begin);
+            return self;
+        }
+        assert(depth + 1 < kMaxDepth);
+
+        // 重心の広がりが最大の軸で中央値分割
+        const Vec3 extent = centroids.max - centroids.min;
+        int axis = 0;
+        if (extent.y > extent.x) axis = 1;
+        if (extent.z > Component(extent, axis)) axis = 2;
+
+        const uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](uint32_t a, uint32_t b){
+            return Component(elementBounds[a].Center(), axis) < Component(elementBounds[b].Center(), axis);
+        });
+
+        BuildMedianSplit<kLeafSize, kMaxDepth>(nodes, order, elementBounds, begin, mid, makeNode, depth + 1);
+        const uint32_t right = BuildMedianSplit<kLeafSize, kMaxDepth>(nodes, order, elementBounds, mid, end, makeNode, depth + 1);
+        nodes[self] = makeNode(bounds, right, 0);
+        return self;
+    }
+}
@@ -0,0 +1,287 @@
+#include "Collision/BroadPhase.h"
+
+#include <algorithm>
+#include <variant>
+
+#include "Collision/Collider.h"
+#include "Collision/CompoundShape.h"
+#include "Collision/ConvexHull.h"
+#include "Collision/HeightField.h"
+#include "Collision/TriangleMesh.h"
+#include "Capsule.h"
+#include "Gjk.h"
+#include "OrientedBox.h"
+
+namespace Collision{
+    namespace{
+        // 凸包の境界を広げる幅
+        constexpr float kHullMargin = 1e-4f;
+    }
+
+    bool Bounds::Overlaps(const Bounds& other) const {
+        return (min.x <= other.max.x && max.x >= other.min.x) &&
+            (min.y <= other.max.y && max.y >= other.min.y) &&
+            (min.z <= other.max.z && max.z >= other.min.z);
+    }
+
+    bool Bounds::Contains(const Vec3& point) const {
+        return (min.x <= point.x && point.x <= max.x) &&
+            (min.y <= point.y && point.y <= max.y) &&
+            (min.z <= point.z && point.z <= max.z);
+    }
+
+    float Bounds::SquaredDistance(const Vec3& point) const {
+        const float dx = std::max({min.x - point.x, 0.f, point.x - max.x});
+        const float dy = std::max({min.y - point.y, 0.f, point.y - max.y});
+        const float dz = std::max({min.z - point.z, 0.f, point.z - max.z});
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    Bounds Bounds::Merge(const Bounds& other) const {
+        return {
+            {std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z)},
+            {std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z)}
+        };
+    }
+
+    Vec3 Bounds::Center() const {
+        return (min + max) * 0.5f;
+    }
+
+    Bounds Bounds::Of(const Collider* collider) {
+        const Vec3 translate = collider->GetTranslate();
+        const auto& size = collider->GetSize();
+
+        if (std::holds_alternative<float>(size)){
+            const float radius = std::get<float>(size);
+            const Vec3 extent {radius, radius, radius};
+            return {translate - extent, translate + extent};
+        }
+
+        if (const auto* mesh = std::get_if<std::shared_ptr<const TriangleMesh>>(&size)){
+            if (!*mesh) return {translate, translate};
+            const Bounds& bounds = (*mesh)->GetBounds();
+            return {bounds.min + translate, bounds.max + translate};
+        }
+
+        if (const auto* field = std::get_if<std::shared_ptr<const HeightField>>(&size)){
+            if (!*field) return {translate, translate};
+            // 地表より下は中身が詰まっているので、埋まった形状も拾えるよう水平方向の広さだけ下へ伸ばす
+            const Bounds& bounds = (*field)->GetBounds();
+            const float depth = std::max(bounds.max.x - bounds.min.x, bounds.max.z - bounds.min.z);
+            return {bounds.min + translate - Vec3 {0.f, depth, 0.f}, bounds.max + translate};
+        }
+
+        if (const auto* compound = std::get_if<std::shared_ptr<const CompoundShape>>(&size)){
+            if (!*compound) return {translate, translate};
+            const Bounds& bounds = (*compound)->GetBounds();
+            return {bounds.min + translate, bounds.max + translate};
+        }
+
+        if (const auto* hull = std::get_if<std::shared_ptr<const ConvexHull>>(&size)){
+            if (!*hull) return {translate, translate};
+            // GJK は丸め誤差の範囲で離れた凸包も接触と判定しうるので、ちょうど接する組を取りこぼさないよう広げる
+            const Bounds bounds = SupportShape::Hull(**hull, translate, collider->GetAxes()).GetBounds();
+            return {bounds.min - Vec3 {kHullMargin, kHullMargin, kHullMargin}, bounds.max + Vec3 {kHullMargin, kHullMargin, kHullMargin}};
+        }
+
+        if (std::holds_alternative<CapsuleSize>(size)){
+            const Capsule capsule = Capsule::Of(collider);
+            const Vec3 extent {capsule.radius, capsule.radius, capsule.radius};
+            return {
+                Vec3 {std::min(capsule.a.x, capsule.b.x), std::min(capsule.a.y, capsule.b.y), std::min(capsule.a.z, capsule.b.z)} - extent,
+                Vec3 {std::max(capsule.a.x, capsule.b.x), std::max(capsule.a.y, capsule.b.y), std::max(capsule.a.z, capsule.b.z)} + extent
+            };
+        }
+
+        if (collider->GetType() == Type::OBB){
+            const Vec3 extent = OrientedBox::Of(collider).WorldExtent();
+            return {translate - extent, translate + extent};
+        }
+
+        const Vec3 half = std::get<Vec3>(size) * 0.5f;
+        return {translate - half, translate + half};
+    }
+
+    void BroadPhase::Build(std::vector<Proxy> proxies) {
+        proxies_ = std::move(proxies);
+        dirty_ = false;
+        nodes_.clear();
+        layers_.clear();
+        matrix_.fill(0);
+        if (proxies_.empty()) return;
+
+        // (attribute, ignore) の組ごとにレイヤーを割り当てる
+        bool mixed = false;
+        uint32_t last = 0;
+        for (auto& proxy : proxies_){
+            auto matches = [&proxy](const Layer& layer){
+                return layer.attribute == proxy.attribute && layer.ignore == proxy.ignore;
+            };
+
+            if (last < layers_.size() && matches(layers_[last])){
+                proxy.layer = static_cast<uint8_t>(last);
+                continue;
+            }
+
+            uint32_t layer = 0;
+            while (layer < layers_.size() && !matches(layers_[layer])) ++layer;
+            if (layer == layers_.size()){
+                if (layers_.size() < kMixedLayer){
+                    layers_.push_back({proxy.attribute, proxy.ignore, UINT32_MAX});
+                } else{
+                    layer = kMixedLayer;
+                    mixed = true;
+                }
+            }
+            proxy.layer = static_cast<uint8_t>(layer);
+            last = layer;
+        }
+        if (mixed){
+            layers_.resize(kMaxLayers, {0, 0, UINT32_MAX});
+        }
+
+        // レイヤーの衝突行列
+        const uint32_t layerCount = static_cast<uint32_t>(layers_.size());
+        for (uint32_t i = 0; i < layerCount; ++i){
+            for (uint32_t j = 0; j < layerCount; ++j){
+                const bool collidable = (mixed && (i == kMixedLayer || j == kMixedLayer)) ||
+                    !(layers_[i].attribute & layers_[j].ignore || layers_[i].ignore & layers_[j].attribute);
+                if (collidable){
+                    matrix_[i] |= 1u << j;
+                }
+            }
+        }
+
+        // レイヤー順に並べ替え (計数ソート)
+        std::array<uint32_t, kMaxLayers + 1> offsets {};
+        for (const auto& proxy : proxies_){
+            ++offsets[proxy.layer + 1];
+        }
+        for (uint32_t i = 0; i < kMaxLayers; ++i){
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<Proxy> sorted(proxies_.size());
+        {
+            auto cursor = offsets;
+            for (const auto& proxy : proxies_){
+                sorted[cursor[proxy.layer]++] = proxy;
+            }
+        }
+        proxies_ = std::move(sorted);
+
+        // レイヤー毎に木を構築
+        nodes_.reserve(proxies_.size() / kLeafSize * 2 + layerCount);
+        for (uint32_t i = 0; i < layerCount; ++i){
+            if (offsets[i] == offsets[i + 1]) continue;
+            layers_[i].root = BuildRecursive(offsets[i], offsets[i + 1], 0);
+        }
+    }
+
+    void BroadPhase::Clear() {
+        dirty_ = false;
+        proxies_.clear();
+        nodes_.clear();
+        layers_.clear();
+        matrix_.fill(0);
+    }
+
+    void BroadPhase::Invalidate(uint32_t index, const Collider* collider) {
+        if (index < proxies_.size() && proxies_[index].collider == collider){
+            proxies_[index].collider = nullptr;
+        }
+    }
+
+    void BroadPhase::UpdateBounds(uint32_t index, const Collider* collider, const Bounds& bounds) {
+        if (index < proxies_.size() && proxies_[index].collider == collider){
+            proxies_[index].bounds = bounds;
+            dirty_.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void BroadPhase::Refit() {
+        if (!dirty_) return;
+
+        // 子は常に親より後ろにあるので逆順に辿れば葉から順に求まる
+        for (uint32_t i = static_cast<uint32_t>(nodes_.size()); i-- > 0;){
+            Node& node = nodes_[i];
+            if (!node.count){
+                node.bounds = nodes_[i + 1].bounds.Merge(nodes_[node.index].bounds);
+                continue;
+            }
+
+            node.bounds = proxies_[node.index].bounds;
+            for (uint32_t j = node.index + 1; j < node.index + node.count; ++j){
+                node.bounds = node.bounds.Merge(proxies_[j].bounds);
+            }
+        }
+        dirty_ = false;
+    }
+
+    bool BroadPhase::IsDirty() const {
+        return dirty_.load(std::memory_order_relaxed);
+    }
+
+    const std::vector<BroadPhase::Proxy>& BroadPhase::GetProxies() const {
+        return proxies_;
+    }
+
+    bool BroadPhase::IsEmpty() const {
+        return nodes_.empty();
+    }
+
+    uint32_t BroadPhase::GetCollidableLayers(uint32_t layer) const {
+        return layer < kMaxLayers ? matrix_[layer] : 0;
+    }
+
+    uint32_t BroadPhase::GetCollidableLayers(uint32_t attribute, uint32_t ignore) const {
+        uint32_t layers = 0;
+        for (uint32_t i = 0; i < layers_.size(); ++i){
+            const Layer& layer = layers_[i];
+            const bool mixed = layers_.size() == kMaxLayers && i == kMixedLayer;
+            if (mixed || !(attribute & layer.ignore || ignore & layer.attribute)){
+                layers |= 1u << i;
+            }
+        }
+        return layers;
+    }
+
+    uint32_t BroadPhase::BuildRecursive(uint32_t begin, uint32_t end, uint32_t depth) {
+        const uint32_t self = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back({});
+
+        Bounds bounds = proxies_[begin].bounds;
+        Bounds centroids {proxies_[begin].bounds.Center(), proxies_[begin].bounds.Center()};
+        for (uint32_t i = begin + 1; i < end; ++i){
+            bounds = bounds.Merge(proxies_[i].bounds);
+            const Vec3 center = proxies_[i].bounds.Center();
+            centroids = centroids.Merge({center, center});
+        }
+
+        // 葉
+        if (end - begin <= kLeafSize || depth + 1 >= kMaxDepth){
+            nodes_[self] = {bounds, begin, end - begin};
+            return self;
+        }
+
+        // 重心の広がりが最大の軸で中央値分割
+        const Vec3 extent = centroids.max - centroids.min;
+        int axis = 0;
+        if (extent.y > extent.x) axis = 1;
+        if (extent.z > (axis == 0 ? extent.x : extent.y)) axis = 2;
+
+        const uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(proxies_.begin() + begin, proxies_.begin() + mid, proxies_.begin() + end,
+                         [axis](const Proxy& a, const Proxy& b){
+            const Vec3 ca = a.bounds.Center();
+            const Vec3 cb = b.bounds.Center();
+            return axis == 0 ? ca.x < cb.x : axis == 1 ? ca.y < cb.y : ca.z < cb.z;
+        });
+
+        BuildRecursive(begin, mid, depth + 1);
+        const uint32_t right = BuildRecursive(mid, end, depth + 1);
+
+        nodes_[self] = {bounds, right, 0};
+        return self;
+    }
+}
@@ -0,0 +1,256 @@
+#include "Capsule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <variant>
+
+#include "Intersection.h"
+
+namespace Collision{
+    namespace{
+        constexpr float kEpsilon = 1e-6f;
+
+        // 線分がOBBを貫いている場合の接触情報 (ボックスの面と、線分とボックスの辺の外積を分離軸候補とする)
+        Contact CapsuleOBBPenetration(const Capsule& capsule, const OrientedBox& box, const Vec3& point) {
+            const Vec3 axis = capsule.b - capsule.a;
+            const Vec3 delta = box.center - (capsule.a + capsule.b) * 0.5f;
+
+            float depth = std::numeric_limits<float>::max();
+            Vec3 normal = Vec3::Up;
+            auto consider = [&](Vec3 n){
+                const float length = n.Length();
+                if (length < 0.001f) return;
+                n /= length;
+
+                const float a = capsule.a.Dot(n);
+                const float b = capsule.b.Dot(n);
+                const float center = box.center.Dot(n);
+                const float extent = std::abs(box.axes[0].Dot(n)) * box.half.x +
+                    std::abs(box.axes[1].Dot(n)) * box.half.y +
+                    std::abs(box.axes[2].Dot(n)) * box.half.z;
+
+                const float overlap = std::min(std::max(a, b) + capsule.radius - (center - extent),
+                                               center + extent - (std::min(a, b) - capsule.radius));
+                if (overlap < depth){
+                    depth = overlap;
+                    normal = n.Dot(delta) < 0.f ? n * -1.f : n;
+                }
+            };
+
+            for (const Vec3& boxAxis : box.axes){
+                consider(boxAxis);
+                consider(Vec3::Cross(axis, boxAxis));
+            }
+            return {normal, std::max(depth, 0.f), point};
+        }
+    }
+
+    Capsule Capsule::Of(const Collider* collider) {
+        const CapsuleSize size = std::get<CapsuleSize>(collider->GetSize());
+        const Vec3 half = collider->GetAxes()[1] * (size.height * 0.5f);
+        const Vec3 center = collider->GetTranslate();
+        return {center - half, center + half, size.radius};
+    }
+
+    namespace Intersection{
+        Vec3 ClosestPointOnSegment(const Vec3& point, const Vec3& a, const Vec3& b) {
+            const Vec3 ab = b - a;
+            const float lengthSq = ab.Dot(ab);
+            if (lengthSq <= kEpsilon) return a;
+            return a + ab * std::clamp((point - a).Dot(ab) / lengthSq, 0.f, 1.f);
+        }
+
+        float SegmentSegment(const Vec3& p1, const Vec3& q1, const Vec3& p2, const Vec3& q2, Vec3& c1, Vec3& c2) {
+            const Vec3 d1 = q1 - p1;
+            const Vec3 d2 = q2 - p2;
+            const Vec3 r = p1 - p2;
+            const float a = d1.Dot(d1);
+            const float e = d2.Dot(d2);
+            const float f = d2.Dot(r);
+
+            float s = 0.f;
+            float t = 0.f;
+            if (a <= kEpsilon && e <= kEpsilon){
+                // どちらも点
+            } else if (a <= kEpsilon){
+                t = std::clamp(f / e, 0.f, 1.f);
+            } else{
+                const float c = d1.Dot(r);
+                if (e <= kEpsilon){
+                    s = std::clamp(-c / a, 0.f, 1.f);
+                } else{
+                    const float b = d1.Dot(d2);
+                    const float denom = a * e - b * b;
+                    // 平行なら任意の s でよいので 0 とする
+                    s = denom != 0.f ? std::clamp((b * f - c * e) / denom, 0.f, 1.f) : 0.f;
+                    t = (b * s + f) / e;
+                    if (t < 0.f){
+                        t = 0.f;
+                        s = std::clamp(-c / a, 0.f, 1.f);
+                    } else if (t > 1.f){
+                        t = 1.f;
+                        s = std::clamp((b - c) / a, 0.f, 1.f);
+                    }
+                }
+            }
+
+            c1 = p1 + d1 * s;
+            c2 = p2 + d2 * t;
+            return (c1 - c2).SquaredLength();
+        }
+
+        float SegmentOBB(const Vec3& a, const Vec3& b, const OrientedBox& box, Vec3& onSegment, Vec3& onBox) {
+            // ボックスの座標系では軸平行な箱 [-half, half] になり、線分上の点 p + d * t から箱までの
+            // 距離の2乗は各軸のはみ出し量の2乗和なので、軸ごとに面を横切る t で区切った区間では2次式になる
+            const Vec3 da = a - box.center;
+            const Vec3 db = b - box.center;
+            const float p[3] = {da.Dot(box.axes[0]), da.Dot(box.axes[1]), da.Dot(box.axes[2])};
+            const float q[3] = {db.Dot(box.axes[0]), db.Dot(box.axes[1]), db.Dot(box.axes[2])};
+            const float half[3] = {box.half.x, box.half.y, box.half.z};
+            float d[3];
+
+            // 区間の境界 (両端と、各軸で面を横切る位置)
+            float breaks[8] = {0.f, 1.f};
+            int count = 2;
+            for (int i = 0; i < 3; ++i){
+                d[i] = q[i] - p[i];
+                if (std::abs(d[i]) <= kEpsilon) continue;
+                for (const float face : {-half[i], half[i]}){
+                    const float t = (face - p[i]) / d[i];
+                    if (t <= 0.f || 1.f <= t) continue;
+                    // 昇順を保って挿入する (先頭の0より小さい値は無い)
+                    int k = count++;
+                    for (; t < breaks[k - 1]; --k) breaks[k] = breaks[k - 1];
+                    breaks[k] = t;
+                }
+            }
+
+            auto distanceAt = [&](float t){
+                float sum = 0.f;
+                for (int i = 0; i < 3; ++i){
+                    const float x = p[i] + d[i] * t;
+                    const float outside = x - std::clamp(x, -half[i], half[i]);
+                    sum += outside * outside;
+                }
+                return sum;
+            };
+
+            float bestT = 0.f;
+            float best = distanceAt(0.f);
+            for (int k = 0; k + 1 < count && 0.f < best; ++k){
+                const float t0 = breaks[k];
+                const float t1 = breaks[k + 1];
+                // 区間の中点で各軸が箱のどちら側にあるかを決め、2次式 A t^2 + B t + C の最小点を求める
+                const float middle = (t0 + t1) * 0.5f;
+                float quadratic = 0.f;
+                float linear = 0.f;
+                for (int i = 0; i < 3; ++i){
+                    const float x = p[i] + d[i] * middle;
+                    const float face = x < -half[i] ? -half[i] : half[i] < x ? half[i] : x;
+                    if (face == x) continue;
+                    quadratic += d[i] * d[i];
+                    linear += d[i] * (p[i] - face);
+                }
+                const float t = quadratic > 0.f ? std::clamp(-linear / quadratic, t0, t1) : t0;
+                const float distance = distanceAt(t);
+                if (distance < best){
+                    best = distance;
+                    bestT = t;
+                }
+            }
+
+            onSegment = a + (b - a) * bestT;
+            onBox = box.ClosestPoint(onSegment);
+            return best;
+        }
+
+        bool CapsuleSphere(const Capsule& capsule, const Vec3& center, float radius) {
+            const float r = capsule.radius + radius;
+            return (ClosestPointOnSegment(center, capsule.a, capsule.b) - center).SquaredLength() <= r * r;
+        }
+
+        bool CapsuleCapsule(const Capsule& c1, const Capsule& c2) {
+            Vec3 p1, p2;
+            const float r = c1.radius + c2.radius;
+            return SegmentSegment(c1.a, c1.b, c2.a, c2.b, p1, p2) <= r * r;
+        }
+
+        bool CapsuleOBB(const Capsule& capsule, const OrientedBox& box) {
+            Vec3 onSegment, onBox;
+            return SegmentOBB(capsule.a, capsule.b, box, onSegment, onBox) <= capsule.radius * capsule.radius;
+        }
+
+        bool PointCapsule(const Vec3& point, const Capsule& capsule) {
+            return PointSphere(point, ClosestPointOnSegment(point, capsule.a, capsule.b), capsule.radius);
+        }
+
+        bool RayCapsule(const Vec3& origin, const Vec3& direction, const Capsule& capsule, float& t) {
+            if (PointCapsule(origin, capsule)){
+                t = 0.f;
+                return true;
+            }
+
+            const float r2 = capsule.radius * capsule.radius;
+            const Vec3 ba = capsule.b - capsule.a;
+            const Vec3 oa = origin - capsule.a;
+            const float baba = ba.Dot(ba);
+            const float bard = ba.Dot(direction);
+            const float baoa = ba.Dot(oa);
+
+            // 側面 (無限円柱との交点のうち線分の範囲内のもの)
+            const float a = baba - bard * bard;
+            if (kEpsilon < a){
+                const float b = baba * direction.Dot(oa) - baoa * bard;
+                const float c = baba * oa.Dot(oa) - baoa * baoa - r2 * baba;
+                const float h = b * b - a * c;
+                if (h < 0.f) return false;
+
+                const float hit = (-b - std::sqrt(h)) / a;
+                const float y = baoa + hit * bard;
+                if (0.f < y && y < baba){
+                    if (hit < 0.f) return false;
+                    t = hit;
+                    return true;
+                }
+            }
+
+            // 両端の半球
+            float best = -1.f;
+            for (const Vec3& cap : {capsule.a, capsule.b}){
+                const Vec3 oc = origin - cap;
+                const float b = direction.Dot(oc);
+                const float h = b * b - (oc.Dot(oc) - r2);
+                if (h < 0.f) continue;
+
+                const float hit = -b - std::sqrt(h);
+                if (0.f <= hit && (best < 0.f || hit < best)) best = hit;
+            }
+            if (best < 0.f) return false;
+
+            t = best;
+            return true;
+        }
+
+        Contact CapsuleSphereContact(const Capsule& capsule, const Vec3& center, float radius) {
+            const Vec3 closest = ClosestPointOnSegment(center, capsule.a, capsule.b);
+            return SphereSphereContact(closest, capsule.radius, center, radius);
+        }
+
+        Contact CapsuleCapsuleContact(const Capsule& c1, const Capsule& c2) {
+            Vec3 p1, p2;
+            SegmentSegment(c1.a, c1.b, c2.a, c2.b, p1, p2);
+            return SphereSphereContact(p1, c1.radius, p2, c2.radius);
+        }
+
+        Contact CapsuleOBBContact(const Capsule& capsule, const OrientedBox& box) {
+            Vec3 onSegment, onBox;
+            const float distance = std::sqrt(SegmentOBB(capsule.a, capsule.b, box, onSegment, onBox));
+            if (distance > 0.0001f){
+                return {(onBox - onSegment) / distance, std::max(0.f, capsule.radius - distance), onBox};
+            }
+
+            return CapsuleOBBPenetration(capsule, box, onSegment);
+        }
+    }
+}
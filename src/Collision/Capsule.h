@@ -0,0 +1,67 @@
+#pragma once
+#include "Collision/Collider.h"
+#include "Collision/Mathematics.h"
+#include "OrientedBox.h"
+
+namespace Collision{
+    /// @brief
+    /// 線分と半径で表すカプセル (狭域判定用)
+    struct Capsule{
+        // 線分の両端
+        Vec3 a;
+        Vec3 b;
+        float radius;
+
+        /// コライダーのカプセルを取得 (サイズは CapsuleSize である前提)
+        static Capsule Of(const Collider* collider);
+    };
+
+    namespace Intersection{
+        /// 線分上で点に最も近い点
+        Vec3 ClosestPointOnSegment(const Vec3& point, const Vec3& a, const Vec3& b);
+
+        /**
+         * 線分同士の最近点を求めます。
+         * @param p1 線分1の始点
+         * @param q1 線分1の終点
+         * @param p2 線分2の始点
+         * @param q2 線分2の終点
+         * @param c1 線分1上の最近点の出力先
+         * @param c2 線分2上の最近点の出力先
+         * @return 最近点間の二乗距離
+         */
+        float SegmentSegment(const Vec3& p1, const Vec3& q1, const Vec3& p2, const Vec3& q2, Vec3& c1, Vec3& c2);
+
+        /**
+         * 線分とOBBの最近点を求めます。
+         * @param a 線分の始点
+         * @param b 線分の終点
+         * @param box 判定するOBB
+         * @param onSegment 線分上の最近点の出力先
+         * @param onBox OBB上の最近点の出力先
+         * @return 最近点間の二乗距離 (交差していれば0)
+         */
+        float SegmentOBB(const Vec3& a, const Vec3& b, const OrientedBox& box, Vec3& onSegment, Vec3& onBox);
+
+        bool CapsuleSphere(const Capsule& capsule, const Vec3& center, float radius);
+        bool CapsuleCapsule(const Capsule& c1, const Capsule& c2);
+        /// AABB は OrientedBox::FromAABB で渡す
+        bool CapsuleOBB(const Capsule& capsule, const OrientedBox& box);
+        bool PointCapsule(const Vec3& point, const Capsule& capsule);
+
+        /**
+         * レイとカプセルを判定します。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param capsule 判定するカプセル
+         * @param t 交点までの距離の出力先 (原点が内部にある場合は0)
+         * @return 交差する場合はtrue (レイの長さは考慮しない)
+         */
+        bool RayCapsule(const Vec3& origin, const Vec3& direction, const Capsule& capsule, float& t);
+
+        // 衝突している前提で接触情報を求める (法線はカプセルから相手へ向かう向き)
+        Contact CapsuleSphereContact(const Capsule& capsule, const Vec3& center, float radius);
+        Contact CapsuleCapsuleContact(const Capsule& c1, const Capsule& c2);
+        Contact CapsuleOBBContact(const Capsule& capsule, const OrientedBox& box);
+    }
+}
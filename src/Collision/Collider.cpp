@@ -1,6 +1,6 @@
 #include "Collision/Collider.h"
 
-#include <format>
+#include <cmath>
 #include <utility>
 
 #include "Collision/CollisionManager.h"
@@ -8,7 +8,10 @@
 #include "src/sys/System.h"
 
 namespace Collision{
-	Event::Event(EventType _type, const Collider* _collider) :type_(_type), other_(_collider) {
+	Event::Event(EventType _type, const Collider* _collider, uint32_t _child, uint32_t _otherChild) :type_(_type), other_(_collider), child_(_child), otherChild_(_otherChild) {
+	}
+
+	Event::Event(EventType _type, const Collider* _collider, const Contact& _contact, uint32_t _child, uint32_t _otherChild) :type_(_type), other_(_collider), contact_(_contact), hasContact_(true), child_(_child), otherChild_(_otherChild) {
 	}
 
 	EventType Event::GetType() const {
@@ -19,16 +22,34 @@ namespace Collision{
         return other_;
 	}
 
-	Collider::Collider() :manager_(Singleton<Manager>::Get()){
-        data_.uuid = System::CreateUniqueId();
+	const Contact* Event::GetContact() const {
+        return hasContact_ ? &contact_ : nullptr;
+	}
+
+	uint32_t Event::GetChildIndex() const {
+        return child_;
+	}
+
+	uint32_t Event::GetOtherChildIndex() const {
+        return otherChild_;
+	}
+
+	Collider::Collider() :Collider(*Singleton<Manager>::Get()){
+	}
+
+	Collider::Collider(Manager& _manager) :Collider(Deferred {}, &_manager){
         if (!manager_->Register(this)){
             throw std::runtime_error("Failed to register collider");
         }
-        registered_ = true;
+	}
+
+	Collider::Collider(Deferred, Manager* _manager) :manager_(_manager){
+        data_.id = System::CreateId();
 	}
 
 	Collider::~Collider() {
-        if (!manager_->Unregister(this)){
+        // UnregisterMany で解除済みなら何もしない
+        if (registered_ && !manager_->Unregister(this)){
             //WARNING
         }
 	}
@@ -55,24 +76,47 @@ namespace Collision{
 
     Collider* Collider::SetType(const Type _type) {
         data_.type = _type;
+        RefitProxy();
         return this;
     }
 
     Collider* Collider::SetTranslate(const Vec3& _translate) {
         translate_ = _translate;
+        RefitProxy();
         return this;
     }
 
     Collider* Collider::SetSize(const Size _size) {
         size_ = _size;
+        RefitProxy();
+        return this;
+    }
+
+    Collider* Collider::SetRotate(const Vec3& _rotate) {
+        rotate_ = _rotate;
+
+        // 行ベクトル規約の R = Rx * Ry * Rz の各行がローカル軸となる
+        const float sx = std::sin(_rotate.x), cx = std::cos(_rotate.x);
+        const float sy = std::sin(_rotate.y), cy = std::cos(_rotate.y);
+        const float sz = std::sin(_rotate.z), cz = std::cos(_rotate.z);
+        axes_[0] = {cy * cz, cy * sz, -sy};
+        axes_[1] = {sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy};
+        axes_[2] = {cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy};
+        RefitProxy();
         return this;
     }
 
-	Collider* Collider::SetEvent(EventType _event, std::function<void(const Collider*)> _callback) {
-        onCollisions_[static_cast<int>(_event)] = std::move(_callback);
+
+	Collider* Collider::SetEvent(EventType _event, EventCBFunc _callback) {
+        onCollisionEvents_[static_cast<int>(_event)] = std::move(_callback);
+        UpdateSubscribedEvents(_event);
         return this;
 	}
 
+	Collider* Collider::SetEvent(EventType _event, std::nullptr_t) {
+        return SetEvent(_event, EventCBFunc());
+	}
+
 	Collider* Collider::AddAttribute(const uint32_t _attribute) {
         data_.attribute |= _attribute;
         return this;
@@ -98,18 +142,51 @@ namespace Collision{
         return this;
 	}
 
-	void Collider::OnCollision(const Event _event) const {
-		if (const CBFunc callback = onCollisions_[static_cast<int>(_event.GetType())]){
-            callback(_event.GetOther());
+	void Collider::OnCollision(const Event& _event) const {
+        // コピーせずにその場で呼び出す
+		if (const EventCBFunc& callback = onCollisionEvents_[static_cast<int>(_event.GetType())]){
+            callback(_event);
         }
     }
 
+	uint8_t Collider::GetSubscribedEvents() const {
+        return subscribedEvents_;
+	}
+
+	bool Collider::IsSubscribed(EventType _event) const {
+        return subscribedEvents_ & (1 << static_cast<int>(_event));
+	}
+
+	void Collider::RefitProxy() const {
+        // ブロードフェーズに載っていれば、Detect を待たずにクエリへ反映する
+        if (proxyIndex_ != UINT32_MAX && manager_) manager_->RefitProxy(this);
+	}
+
+	void Collider::UpdateSubscribedEvents(EventType _event) {
+        const int index = static_cast<int>(_event);
+        const uint8_t bit = static_cast<uint8_t>(1 << index);
+        if (onCollisionEvents_[index]){
+            subscribedEvents_ |= bit;
+        } else{
+            subscribedEvents_ &= static_cast<uint8_t>(~bit);
+        }
+	}
+
 	const Data& Collider::GetData() const {
         return data_;
 	}
 
+	uint64_t Collider::GetId() const {
+        return data_.id;
+	}
+
 	std::string Collider::GetUniqueId() const {
-        return data_.uuid;
+        return System::FormatUniqueId(data_.id);
+	}
+
+	bool Collider::operator==(const std::string& other) const {
+        uint64_t id = 0;
+        return System::ParseUniqueId(other, id) && id == data_.id;
 	}
 
 	Type Collider::GetType() const {
@@ -124,7 +201,7 @@ namespace Collision{
         return data_.ignore;
     }
 
-    Collider::Size Collider::GetSize() const {
+    const Collider::Size& Collider::GetSize() const {
         return size_;
     }
 
@@ -132,12 +209,24 @@ namespace Collision{
         return translate_;
     }
 
+    Vec3 Collider::GetRotate() const {
+        return rotate_;
+    }
+
+    const std::array<Vec3, 3>& Collider::GetAxes() const {
+        return axes_;
+    }
+
     void* Collider::GetOwner() const {
         return data_.owner;
     }
 
-    Ray::Ray() :origin_({}), direction_({}), length_(0), manager_(Singleton<Manager>::Get()) {
-        data_.uuid = System::CreateUniqueId();
+    Manager* Collider::GetManager() const {
+        return manager_;
+    }
+
+    Ray::Ray() :origin_({}), direction_({}), length_(0) {
+        data_.id = System::CreateId();
         data_.type = Type::Ray;
     }
 
@@ -219,8 +308,12 @@ namespace Collision{
         return length_;
     }
 
+    uint64_t Ray::GetId() const {
+        return data_.id;
+    }
+
     std::string Ray::GetUniqueId() const {
-        return data_.uuid;
+        return System::FormatUniqueId(data_.id);
     }
 
     Type Ray::GetType() const {
@@ -244,6 +337,7 @@ namespace Collision{
     }
 
     bool Ray::operator==(const std::string& other) const {
-	    return data_.uuid == other;
+        uint64_t id = 0;
+        return System::ParseUniqueId(other, id) && id == data_.id;
     }
 }
@@ -0,0 +1,115 @@
+#include "Collision/ColliderPool.h"
+
+#include <cassert>
+#include <new>
+
+namespace Collision{
+    ColliderPool::ColliderPool(Manager* manager) :manager_(manager) {
+    }
+
+    ColliderPool::~ColliderPool() {
+        Clear();
+    }
+
+    Collider* ColliderPool::Create() {
+        Slot* slot = nullptr;
+        {
+            std::unique_lock lock(mutex_);
+            if (!free_) AddSlab();
+            slot = free_;
+            free_ = slot->next;
+        }
+
+
+        Collider* collider = new(slot->storage) Collider(Collider::Deferred {}, manager_);
+
+        std::unique_lock lock(mutex_);
+        slot->live = true;
+        ++liveCount_;
+        return collider;
+    }
+
+    bool ColliderPool::Destroy(Collider* collider, bool retire) {
+        if (!collider) return false;
+        // storage はスロットの先頭にある
+        Slot* slot = reinterpret_cast<Slot*>(collider);
+        {
+            std::unique_lock lock(mutex_);
+            assert(Owns(slot));
+            if (!slot->live) return false;
+            slot->live = false;
+        }
+
+        // デストラクタは Manager から登録を解除するのでプールのロックの外で呼ぶ
+        collider->~Collider();
+
+        std::unique_lock lock(mutex_);
+        --liveCount_;
+        Slot*& list = retire ? retired_ : free_;
+        slot->next = list;
+        list = slot;
+        return true;
+    }
+
+    void ColliderPool::Release() {
+        std::unique_lock lock(mutex_);
+        while (retired_){
+            Slot* slot = retired_;
+            retired_ = slot->next;
+            slot->next = free_;
+            free_ = slot;
+        }
+    }
+
+    void ColliderPool::Reserve(size_t count) {
+        std::unique_lock lock(mutex_);
+        while (slabs_.size() * kSlabSize < count){
+            AddSlab();
+        }
+    }
+
+    void ColliderPool::Clear() {
+        std::vector<Collider*> live;
+        {
+            std::unique_lock lock(mutex_);
+            live.reserve(liveCount_);
+            for (const auto& slab : slabs_){
+                for (uint32_t i = 0; i < kSlabSize; ++i){
+                    if (slab[i].live) live.push_back(reinterpret_cast<Collider*>(slab[i].storage));
+                }
+            }
+        }
+
+        for (Collider* collider : live){
+            Destroy(collider);
+        }
+        Release();
+    }
+
+    size_t ColliderPool::GetLiveCount() {
+        std::unique_lock lock(mutex_);
+        return liveCount_;
+    }
+
+    size_t ColliderPool::GetCapacity() {
+        std::unique_lock lock(mutex_);
+        return slabs_.size() * kSlabSize;
+    }
+
+    void ColliderPool::AddSlab() {
+        auto slab = std::make_unique_for_overwrite<Slot[]>(kSlabSize);
+        // 先頭のスロットから使われるよう逆順に空きリストへ積む
+        for (uint32_t i = kSlabSize; i-- > 0;){
+            slab[i].next = free_;
+            free_ = &slab[i];
+        }
+        slabs_.push_back(std::move(slab));
+    }
+
+    bool ColliderPool::Owns(const Slot* slot) const {
+        for (const auto& slab : slabs_){
+            if (slab.get() <= slot && slot < slab.get() + kSlabSize) return true;
+        }
+        return false;
+    }
+}
@@ -1,79 +1,753 @@
 #include "Collision/CollisionManager.h"
 #include <algorithm>
-#include <condition_variable>
+#include <cassert>
+#include <chrono>
 #include <queue>
 #include <functional>
 #include <ranges>
 
-#include <EventTimer/EventTimer.h>
+#include "Collision/CompoundShape.h"
+#include "Collision/ConvexHull.h"
+#include "Collision/HeightField.h"
+#include "Collision/TriangleMesh.h"
+
+#include "Capsule.h"
+#include "Gjk.h"
+#include "Intersection.h"
+#include "Triangle.h"
+#include "OrientedBox.h"
+#include "PlaneSet.h"
+#include "src/sys/System.h"
+
+#if COLLISION_ENABLE_STATS
+#define COLLISION_STATS(statement) statement
+#define COLLISION_STATS_TARGET(phase) (&stats_.phaseNanoseconds[static_cast<size_t>(phase)])
+#define COLLISION_STATS_ATOMIC_TARGET(counter) (&(counter))
+#else
+#define COLLISION_STATS(statement)
+#define COLLISION_STATS_TARGET(phase) nullptr
+#define COLLISION_STATS_ATOMIC_TARGET(counter) nullptr
+#endif
+
+// スコープの所要時間を統計の段階に加算し、トレース中なら区間を記録する
+#define COLLISION_PHASE_SCOPE(phase) const PhaseTimer<> phaseTimer(COLLISION_STATS_TARGET(phase), tracer_, kPhaseNames[static_cast<size_t>(phase)])
 
 namespace Collision{
-    Manager::Manager() {
-        InitThreadPool();
-    }
+    namespace{
+        uint64_t ElapsedNanoseconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        }
 
-    Manager::~Manager() {
-        // スレッドプールを停止
-        running_ = false;
-        taskCondition_.notify_all();
+        // トレースに記録する段階の名前 (Phase の順)
+        constexpr const char* kPhaseNames[] = {"Registration", "BroadPhase", "NarrowPhase", "Merge", "EventDiff", "Dispatch", "RayCast"};
+        static_assert(std::size(kPhaseNames) == static_cast<size_t>(Phase::Count));
+
+        // 並行に呼ばれる段階 (RayCast) は Counter を atomic にする
+        template <typename Counter = uint64_t>
+        class PhaseTimer{
+            // 加算先の統計 (nullptr なら加算しない)
+            Counter* target_;
+            // トレース中でなければ nullptr
+            Tracer* tracer_;
+            const char* name_;
+            std::chrono::steady_clock::time_point begin_;
+
+        public:
+            PhaseTimer(Counter* target, Tracer& tracer, const char* name)
+                :target_(target), tracer_(tracer.IsEnabled() ? &tracer : nullptr), name_(name) {
+                if (target_ || tracer_) begin_ = std::chrono::steady_clock::now();
+            }
 
-        // すべてのスレッドが終了するのを待つ
-        for (auto& thread : threadPool_){
-            if (thread.joinable()){
-                thread.join();
+            ~PhaseTimer() {
+                if (!target_ && !tracer_) return;
+                const auto end = std::chrono::steady_clock::now();
+                if (target_) *target_ += ElapsedNanoseconds(begin_, end);
+                if (tracer_) tracer_->Record(name_, begin_, end);
             }
+        };
+
+        // 回転を考慮する必要があるボックスか
+        bool IsOriented(const Collider* c) {
+            return c->GetType() == Type::OBB && std::holds_alternative<Vec3>(c->GetSize());
         }
-    }
 
-    void Manager::InitThreadPool() {
-        for (uint32_t i = 0; i < maxThreadCount_; ++i){
-            threadPool_.emplace_back(&Manager::WorkerThread, this);
+        bool IsCapsule(const Collider* c) {
+            return std::holds_alternative<CapsuleSize>(c->GetSize());
         }
-    }
 
-    void Manager::WorkerThread() {
-        while (running_){
-            std::function<void()> task;
+        bool IsHull(const Collider* c) {
+            return std::holds_alternative<std::shared_ptr<const ConvexHull>>(c->GetSize());
+        }
 
-            {
-                std::unique_lock<std::mutex> lock(taskMutex_);
+        // 球 (狭域判定用)
+        struct SphereShape{
+            Vec3 center;
+            float radius;
+        };
 
-                // タスクがあるか終了するまで待機
-                taskCondition_.wait(lock, [this]{
-                    return !tasks_.empty() || !running_;
-                });
+        // 狭域判定で扱う凸形状 (AABB は回転無しのOBB, 凸包は GJK で判定するサポート写像として扱う)
+        using Convex = std::variant<SphereShape, Capsule, OrientedBox, SupportShape>;
+
+        /// コライダーの凸形状 (サイズが float, Vec3, CapsuleSize, ConvexHull のいずれかである前提)
+        Convex ConvexOf(const Collider* c) {
+            const auto& size = c->GetSize();
+            if (std::holds_alternative<float>(size)) return SphereShape {c->GetTranslate(), std::get<float>(size)};
+            if (std::holds_alternative<CapsuleSize>(size)) return Capsule::Of(c);
+            if (const auto* hull = std::get_if<std::shared_ptr<const ConvexHull>>(&size)){
+                // 形状の寿命はコライダーが保持する shared_ptr が保証する (無ければ点として扱う)
+                if (!*hull) return SupportShape::Sphere(c->GetTranslate(), 0.f);
+                return SupportShape::Hull(**hull, c->GetTranslate(), c->GetAxes());
+            }
+            return OrientedBox::Of(c);
+        }
+
+        SupportShape ToSupport(const Convex& shape) {
+            if (const auto* sphere = std::get_if<SphereShape>(&shape)) return SupportShape::Sphere(sphere->center, sphere->radius);
+            if (const auto* capsule = std::get_if<Capsule>(&shape)) return SupportShape::Segment(capsule->a, capsule->b, capsule->radius);
+            if (const auto* box = std::get_if<OrientedBox>(&shape)) return SupportShape::Box(*box);
+            return std::get<SupportShape>(shape);
+        }
+
+        /// 複合形状の子の凸形状 (origin は複合形状のコライダーの位置)
+        Convex ConvexOf(const CompoundShape::Child& child, const Vec3& origin) {
+            if (std::holds_alternative<float>(child.size)) return SphereShape {origin + child.offset, std::get<float>(child.size)};
+            return OrientedBox::FromAABB(origin + child.offset, std::get<Vec3>(child.size) * 0.5f);
+        }
 
-                // 終了条件
-                if (!running_ && tasks_.empty()){
-                    return;
+        Bounds BoundsOf(const Convex& shape) {
+            if (const auto* sphere = std::get_if<SphereShape>(&shape)){
+                const Vec3 extent {sphere->radius, sphere->radius, sphere->radius};
+                return {sphere->center - extent, sphere->center + extent};
+            }
+            if (const auto* capsule = std::get_if<Capsule>(&shape)){
+                const Vec3 extent {capsule->radius, capsule->radius, capsule->radius};
+                return {
+                    Vec3 {std::min(capsule->a.x, capsule->b.x), std::min(capsule->a.y, capsule->b.y), std::min(capsule->a.z, capsule->b.z)} - extent,
+                    Vec3 {std::max(capsule->a.x, capsule->b.x), std::max(capsule->a.y, capsule->b.y), std::max(capsule->a.z, capsule->b.z)} + extent
+                };
+            }
+            if (const auto* box = std::get_if<OrientedBox>(&shape)){
+                const Vec3 extent = box->WorldExtent();
+                return {box->center - extent, box->center + extent};
+            }
+            return std::get<SupportShape>(shape).GetBounds();
+        }
+
+        /**
+         * 凸形状同士を判定します。
+         * @param a 1つ目の形状
+         * @param b 2つ目の形状
+         * @param contact 接触情報の出力先 (法線は a から b へ向かう向き, nullptrなら求めない)
+         * @param axis GJK を始める分離軸 (a から b へ向かう向き)。判定後の分離軸を書き戻す (nullptrなら使わない)
+         * @return 衝突している場合はtrue
+         */
+        bool DetectConvex(const Convex& a, const Convex& b, Contact* contact, Vec3* axis = nullptr) {
+            // 球, カプセル, OBB, 凸包の順に並べて組み合わせを半分にする
+            if (b.index() < a.index()){
+                if (axis) *axis *= -1.f;
+                const bool hit = DetectConvex(b, a, contact, axis);
+                if (axis) *axis *= -1.f;
+                if (hit && contact) contact->normal *= -1.f;
+                return hit;
+            }
+
+            // 凸包を含む組み合わせは GJK/EPA で判定する
+            if (const auto* hull = std::get_if<SupportShape>(&b)){
+                const SupportShape shape = ToSupport(a);
+                Vec3 initial {};
+                Vec3& direction = axis ? *axis : initial;
+                if (!Intersection::GjkOverlap(shape, *hull, direction)) return false;
+                if (contact) *contact = Intersection::GjkContact(shape, *hull, direction);
+                return true;
+            }
+
+            if (const auto* sphere = std::get_if<SphereShape>(&a)){
+                if (const auto* other = std::get_if<SphereShape>(&b)){
+                    if (!Intersection::SphereSphere(sphere->center, sphere->radius, other->center, other->radius)) return false;
+                    if (contact) *contact = Intersection::SphereSphereContact(sphere->center, sphere->radius, other->center, other->radius);
+                    return true;
                 }
+                if (const auto* capsule = std::get_if<Capsule>(&b)){
+                    if (!Intersection::CapsuleSphere(*capsule, sphere->center, sphere->radius)) return false;
+                    if (contact){
+                        // 法線はカプセルから球向きなので反転する
+                        *contact = Intersection::CapsuleSphereContact(*capsule, sphere->center, sphere->radius);
+                        contact->normal *= -1.f;
+                    }
+                    return true;
+                }
+                const OrientedBox& box = std::get<OrientedBox>(b);
+                if (!Intersection::SphereOBB(sphere->center, sphere->radius, box)) return false;
+                if (contact) *contact = Intersection::SphereOBBContact(sphere->center, sphere->radius, box);
+                return true;
+            }
 
-                // タスクを取得
-                if (!tasks_.empty()){
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
+            if (const auto* capsule = std::get_if<Capsule>(&a)){
+                if (const auto* other = std::get_if<Capsule>(&b)){
+                    if (!Intersection::CapsuleCapsule(*capsule, *other)) return false;
+                    if (contact) *contact = Intersection::CapsuleCapsuleContact(*capsule, *other);
+                    return true;
                 }
+                const OrientedBox& box = std::get<OrientedBox>(b);
+                if (!Intersection::CapsuleOBB(*capsule, box)) return false;
+                if (contact) *contact = Intersection::CapsuleOBBContact(*capsule, box);
+                return true;
             }
 
-            // タスクを実行
-            if (task){
-                task();
+            const OrientedBox& box = std::get<OrientedBox>(a);
+            const OrientedBox& other = std::get<OrientedBox>(b);
+            if (!Intersection::OBBOBB(box, other)) return false;
+            if (contact) *contact = Intersection::OBBOBBContact(box, other);
+            return true;
+        }
+
+        // メッシュのコライダーなら形状を返す
+        const TriangleMesh* GetMesh(const Collider* c) {
+            const auto& size = c->GetSize();
+            const auto* mesh = std::get_if<std::shared_ptr<const TriangleMesh>>(&size);
+            // 形状の寿命はコライダーが保持する shared_ptr が保証する
+            return mesh ? mesh->get() : nullptr;
+        }
+
+        // 地形のコライダーなら形状を返す
+        const HeightField* GetHeightField(const Collider* c) {
+            const auto& size = c->GetSize();
+            const auto* field = std::get_if<std::shared_ptr<const HeightField>>(&size);
+            return field ? field->get() : nullptr;
+        }
+
+        bool IsMesh(const Collider* c) {
+            return std::holds_alternative<std::shared_ptr<const TriangleMesh>>(c->GetSize());
+        }
+
+        bool IsHeightField(const Collider* c) {
+            return std::holds_alternative<std::shared_ptr<const HeightField>>(c->GetSize());
+        }
+
+        // 三角形の集合で表される静的な形状 (メッシュ, 地形) か
+        bool IsSurface(const Collider* c) {
+            return IsMesh(c) || IsHeightField(c);
+        }
+
+        /**
+         * 三角形の集合と凸形状を判定し、最も深く入り込んだ三角形から接触情報を求めます (形状のローカル座標)。
+         * 地形の場合は法線を常に上向きとし、中心が地表より下にあれば三角形と交差していなくても衝突とします。
+         * @param surface メッシュまたは地形
+         * @param query 形状を包む境界
+         * @param center 形状の中心
+         * @param overlaps 三角形と形状が交差するかを返す関数
+         * @param radius 方向に対する形状の半径を返す関数
+         * @param contact 接触情報の出力先 (法線は surface から形状へ向かう向き, nullptrなら求めない)
+         * @return 衝突している場合はtrue
+         */
+        template <typename Surface, typename Overlaps, typename Radius>
+        bool DetectSurfaceShape(const Surface& surface, const Bounds& query, const Vec3& center, Overlaps&& overlaps, Radius&& radius, Contact* contact) {
+            constexpr bool isHeightField = std::is_same_v<Surface, HeightField>;
+
+            if constexpr (isHeightField){
+                float height = 0.f;
+                if (surface.GetHeight(center.x, center.z, height) && center.y < height){
+                    // 地中に埋まっている場合は真上へ押し出す
+                    if (contact) *contact = {Vec3::Up, height - center.y + radius(Vec3::Up), {center.x, height, center.z}};
+                    return true;
+                }
+            }
+
+            bool found = false;
+            float deepest = -std::numeric_limits<float>::max();
+            surface.Query(query, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+                if (!overlaps(a, b, c)) return true;
+                found = true;
+                if (!contact) return false;
+
+                Vec3 normal = Vec3::Cross(b - a, c - a);
+                const float length = normal.Length();
+                if (length <= 0.f) return true;
+                normal /= length;
+                if constexpr (isHeightField){
+                    // 地表は常に上が表
+                    if (normal.y < 0.f) normal *= -1.f;
+                } else{
+                    // 形状の中心がある側を表とする
+                    if (normal.Dot(center - a) < 0.f) normal *= -1.f;
+                }
+
+                const float depth = radius(normal) - normal.Dot(center - a);
+                if (deepest < depth){
+                    deepest = depth;
+                    *contact = {normal, std::max(depth, 0.f), Intersection::ClosestPointOnTriangle(center, a, b, c)};
+                }
+                return true;
+            });
+            return found;
+        }
+
+        /**
+         * メッシュまたは地形と他の形状を判定します。
+         * @param surface メッシュまたは地形
+         * @param offset surface のコライダーの位置
+         * @param shape 相手の形状
+         * @param contact 接触情報の出力先 (法線は surface から相手へ向かう向き, nullptrなら求めない)
+         * @return 衝突している場合はtrue
+         */
+        template <typename Surface>
+        bool DetectSurface(const Surface& surface, const Vec3& offset, const Convex& shape, Contact* contact) {
+            // 相手を surface のローカル座標で扱う
+            const Bounds bounds = BoundsOf(shape);
+            const Bounds query {bounds.min - offset, bounds.max - offset};
+
+            bool hit = false;
+            if (const auto* sphere = std::get_if<SphereShape>(&shape)){
+                const float r = sphere->radius;
+                const Vec3 center = sphere->center - offset;
+                hit = DetectSurfaceShape(surface, query, center, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+                    return (Intersection::ClosestPointOnTriangle(center, a, b, c) - center).SquaredLength() <= r * r;
+                }, [&](const Vec3&){
+                    return r;
+                }, contact);
+            } else if (const auto* capsule = std::get_if<Capsule>(&shape)){
+                const Vec3 a = capsule->a - offset;
+                const Vec3 b = capsule->b - offset;
+                const float r2 = capsule->radius * capsule->radius;
+                hit = DetectSurfaceShape(surface, query, (a + b) * 0.5f, [&](const Vec3& v0, const Vec3& v1, const Vec3& v2){
+                    return Intersection::SegmentTriangle(a, b, v0, v1, v2) <= r2;
+                }, [&](const Vec3& n){
+                    return capsule->radius + std::abs((b - a).Dot(n)) * 0.5f;
+                }, contact);
+            } else if (const auto* support = std::get_if<SupportShape>(&shape)){
+                const SupportShape local = support->Translated(offset * -1.f);
+                const Vec3 center = local.Center();
+                hit = DetectSurfaceShape(surface, query, center, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+                    Vec3 axis {};
+                    return Intersection::GjkOverlap(SupportShape::Triangle(a, b, c), local, axis);
+                }, [&](const Vec3& n){
+                    return (local.Support(n) - center).Dot(n) + local.radius;
+                }, contact);
+            } else{
+                OrientedBox box = std::get<OrientedBox>(shape);
+                box.center -= offset;
+                auto toBox = [&box](const Vec3& v){
+                    const Vec3 d = v - box.center;
+                    return Vec3 {d.Dot(box.axes[0]), d.Dot(box.axes[1]), d.Dot(box.axes[2])};
+                };
+                hit = DetectSurfaceShape(surface, query, box.center, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+                    return Intersection::TriangleBox(toBox(a), toBox(b), toBox(c), box.half);
+                }, [&](const Vec3& n){
+                    return std::abs(box.axes[0].Dot(n)) * box.half.x +
+                        std::abs(box.axes[1].Dot(n)) * box.half.y +
+                        std::abs(box.axes[2].Dot(n)) * box.half.z;
+                }, contact);
             }
+
+            if (hit && contact) contact->point += offset;
+            return hit;
         }
-    }
 
-    void Manager::AddTask(std::function<void()> task) {
-        {
-            std::unique_lock<std::mutex> lock(taskMutex_);
-            tasks_.push(std::move(task));
+        /**
+         * メッシュまたは地形のコライダーと凸形状を判定します。
+         * @param surface メッシュまたは地形のコライダー
+         * @param shape 相手の形状
+         * @param contact 接触情報の出力先 (法線は surface から相手へ向かう向き, nullptrなら求めない)
+         * @return 衝突している場合はtrue
+         */
+        bool DetectSurface(const Collider* surface, const Convex& shape, Contact* contact) {
+            if (const TriangleMesh* mesh = GetMesh(surface)){
+                return DetectSurface(*mesh, surface->GetTranslate(), shape, contact);
+            }
+            if (const HeightField* field = GetHeightField(surface)){
+                return DetectSurface(*field, surface->GetTranslate(), shape, contact);
+            }
+            return false;
+        }
+
+        // 複合形状のコライダーなら形状を返す
+        const CompoundShape* GetCompound(const Collider* c) {
+            const auto& size = c->GetSize();
+            const auto* compound = std::get_if<std::shared_ptr<const CompoundShape>>(&size);
+            return compound ? compound->get() : nullptr;
+        }
+
+        bool IsCompound(const Collider* c) {
+            return std::holds_alternative<std::shared_ptr<const CompoundShape>>(c->GetSize());
+        }
+
+        /**
+         * 複合形状の子のうち、境界と重なり判定を満たすものを探します。
+         * @param compound 複合形状のコライダー
+         * @param bounds 検索範囲 (ワールド座標)
+         * @param test 子の凸形状を受け取る判定関数
+         * @return 判定を満たした子がある場合はtrue
+         */
+        template <typename Test>
+        bool AnyChild(const Collider* compound, const Bounds& bounds, Test&& test) {
+            const CompoundShape* shape = GetCompound(compound);
+            if (!shape) return false;
+
+            const Vec3 origin = compound->GetTranslate();
+            bool found = false;
+            shape->Query({bounds.min - origin, bounds.max - origin}, [&](uint32_t index){
+                found = test(ConvexOf(shape->GetChildren()[index], origin));
+                return !found;
+            });
+            return found;
+        }
+
+        /**
+         * 複合形状のコライダーと他の形状を子ごとに判定します。
+         * 接触情報を求める場合は最も深く入り込んだ子の組を、そうでなければ最初に見つかった子の組を返します。
+         * @param compound 複合形状のコライダー
+         * @param other 相手のコライダー
+         * @param contact 接触情報の出力先 (法線は compound から相手へ向かう向き, nullptrなら求めない)
+         * @param children 接触した子の番号の出力先 (compound, other の順, 複合形状でない側は Event::kNoChild)
+         * @return 衝突している場合はtrue
+         */
+        bool DetectCompound(const Collider* compound, const Collider* other, Contact* contact, std::array<uint32_t, 2>& children) {
+            const CompoundShape* shape = GetCompound(compound);
+            if (!shape) return false;
+            const Vec3 origin = compound->GetTranslate();
+            auto toLocal = [&origin](const Bounds& bounds){
+                return Bounds {bounds.min - origin, bounds.max - origin};
+            };
+
+            bool hit = false;
+            float deepest = -std::numeric_limits<float>::max();
+            // 子の組を判定して最も深いものを残す (列挙を続ける場合は true を返す)
+            auto consider = [&](uint32_t index, uint32_t otherIndex, auto&& detect){
+                Contact candidate {};
+                if (!detect(ConvexOf(shape->GetChildren()[index], origin), contact ? &candidate : nullptr)) return true;
+                hit = true;
+                if (!contact){
+                    children = {index, otherIndex};
+                    return false;
+                }
+                if (deepest < candidate.depth){
+                    deepest = candidate.depth;
+                    children = {index, otherIndex};
+                    *contact = candidate;
+                }
+                return true;
+            };
+
+            if (IsCompound(other)){
+                const CompoundShape* otherShape = GetCompound(other);
+                if (!otherShape) return false;
+
+                const Vec3 otherOrigin = other->GetTranslate();
+                const auto otherChildren = otherShape->GetChildren();
+                bool proceed = true;
+                for (uint32_t j = 0; proceed && j < otherChildren.size(); ++j){
+                    const Convex otherChild = ConvexOf(otherChildren[j], otherOrigin);
+                    const Bounds& bounds = otherShape->GetChildBounds(j);
+                    shape->Query(toLocal({bounds.min + otherOrigin, bounds.max + otherOrigin}), [&](uint32_t i){
+                        proceed = consider(i, j, [&](const Convex& child, Contact* c){
+                            return DetectConvex(child, otherChild, c);
+                        });
+                        return proceed;
+                    });
+                }
+            } else if (IsSurface(other)){
+                shape->Query(toLocal(Bounds::Of(other)), [&](uint32_t i){
+                    return consider(i, Event::kNoChild, [&](const Convex& child, Contact* c){
+                        if (!DetectSurface(other, child, c)) return false;
+                        // 法線は surface から子向きなので反転する
+                        if (c) c->normal *= -1.f;
+                        return true;
+                    });
+                });
+            } else{
+                const Convex otherShape = ConvexOf(other);
+                shape->Query(toLocal(BoundsOf(otherShape)), [&](uint32_t i){
+                    return consider(i, Event::kNoChild, [&](const Convex& child, Contact* c){
+                        return DetectConvex(child, otherShape, c);
+                    });
+                });
+            }
+            return hit;
+        }
+
+        float DistanceTo(const Convex& shape, const Vec3& point) {
+            if (const auto* sphere = std::get_if<SphereShape>(&shape)){
+                return std::max(0.f, (point - sphere->center).Length() - sphere->radius);
+            }
+            if (const auto* capsule = std::get_if<Capsule>(&shape)){
+                const Vec3 closest = Intersection::ClosestPointOnSegment(point, capsule->a, capsule->b);
+                return std::max(0.f, (point - closest).Length() - capsule->radius);
+            }
+            if (const auto* box = std::get_if<OrientedBox>(&shape)){
+                return std::sqrt(box->SquaredDistance(point));
+            }
+            const SupportShape& support = std::get<SupportShape>(shape);
+            Vec3 axis {};
+            Vec3 onShape;
+            Vec3 onPoint;
+            const float distance = Intersection::GjkDistance(support, SupportShape::Sphere(point, 0.f), axis, std::numeric_limits<float>::infinity(), onShape, onPoint);
+            return std::max(0.f, distance - support.radius);
+        }
+
+        bool OverlapSphere(const Collider* c, const Vec3& center, float radius) {
+            if (IsCompound(c)){
+                const Vec3 extent {radius, radius, radius};
+                return AnyChild(c, {center - extent, center + extent}, [&](const Convex& child){
+                    return DetectConvex(child, SphereShape {center, radius}, nullptr);
+                });
+            }
+            if (const TriangleMesh* mesh = GetMesh(c)){
+                return mesh->OverlapSphere(center - c->GetTranslate(), radius);
+            }
+            if (const HeightField* field = GetHeightField(c)){
+                return field->OverlapSphere(center - c->GetTranslate(), radius);
+            }
+            if (IsHull(c)){
+                return DetectConvex(ConvexOf(c), SphereShape {center, radius}, nullptr);
+            }
+            const auto& size = c->GetSize();
+            if (std::holds_alternative<float>(size)){
+                return Intersection::SphereSphere(c->GetTranslate(), std::get<float>(size), center, radius);
+            }
+            if (IsCapsule(c)){
+                return Intersection::CapsuleSphere(Capsule::Of(c), center, radius);
+            }
+            if (IsOriented(c)){
+                return Intersection::SphereOBB(center, radius, OrientedBox::Of(c));
+            }
+            const Vec3 half = std::get<Vec3>(size) * 0.5f;
+            return Intersection::SphereAABB(center, radius, c->GetTranslate() - half, c->GetTranslate() + half);
         }
-        taskCondition_.notify_one();
+
+        bool OverlapAABB(const Collider* c, const Vec3& min, const Vec3& max) {
+            if (IsCompound(c)){
+                const OrientedBox box = OrientedBox::FromAABB((min + max) * 0.5f, (max - min) * 0.5f);
+                return AnyChild(c, {min, max}, [&](const Convex& child){
+                    return DetectConvex(child, box, nullptr);
+                });
+            }
+            if (const TriangleMesh* mesh = GetMesh(c)){
+                return mesh->OverlapAABB(min - c->GetTranslate(), max - c->GetTranslate());
+            }
+            if (const HeightField* field = GetHeightField(c)){
+                return field->OverlapAABB(min - c->GetTranslate(), max - c->GetTranslate());
+            }
+            if (IsHull(c)){
+                return DetectConvex(ConvexOf(c), OrientedBox::FromAABB((min + max) * 0.5f, (max - min) * 0.5f), nullptr);
+            }
+            const auto& size = c->GetSize();
+            if (std::holds_alternative<float>(size)){
+                return Intersection::SphereAABB(c->GetTranslate(), std::get<float>(size), min, max);
+            }
+            if (IsCapsule(c)){
+                return Intersection::CapsuleOBB(Capsule::Of(c), OrientedBox::FromAABB((min + max) * 0.5f, (max - min) * 0.5f));
+            }
+            if (IsOriented(c)){
+                return Intersection::OBBOBB(OrientedBox::Of(c), OrientedBox::FromAABB((min + max) * 0.5f, (max - min) * 0.5f));
+            }
+            const Vec3 half = std::get<Vec3>(size) * 0.5f;
+            return Intersection::AABBAABB(c->GetTranslate() - half, c->GetTranslate() + half, min, max);
+        }
+
+        bool OverlapPoint(const Collider* c, const Vec3& point) {
+            // メッシュは面のみで体積を持たない
+            if (IsMesh(c)) return false;
+            if (IsCompound(c)){
+                return AnyChild(c, {point, point}, [&](const Convex& child){
+                    return DetectConvex(child, SphereShape {point, 0.f}, nullptr);
+                });
+            }
+            if (const HeightField* field = GetHeightField(c)){
+                return field->IsBelow(point - c->GetTranslate());
+            }
+            if (IsHull(c)){
+                return DetectConvex(ConvexOf(c), SphereShape {point, 0.f}, nullptr);
+            }
+            const auto& size = c->GetSize();
+            if (std::holds_alternative<float>(size)){
+                return Intersection::PointSphere(point, c->GetTranslate(), std::get<float>(size));
+            }
+            if (IsCapsule(c)){
+                return Intersection::PointCapsule(point, Capsule::Of(c));
+            }
+            if (IsOriented(c)){
+                return Intersection::PointOBB(point, OrientedBox::Of(c));
+            }
+            const Vec3 half = std::get<Vec3>(size) * 0.5f;
+            return Intersection::PointAABB(point, c->GetTranslate() - half, c->GetTranslate() + half);
+        }
+
+        float DistanceTo(const Collider* c, const Vec3& point) {
+            if (IsCompound(c)){
+                const CompoundShape* shape = GetCompound(c);
+                if (!shape || shape->GetChildren().empty()) return -1.f;
+                float nearest = std::numeric_limits<float>::max();
+                for (const auto& child : shape->GetChildren()){
+                    nearest = std::min(nearest, DistanceTo(ConvexOf(child, c->GetTranslate()), point));
+                }
+                return nearest;
+            }
+            if (IsMesh(c)){
+                const TriangleMesh* mesh = GetMesh(c);
+                Vec3 closest;
+                return mesh ? mesh->ClosestPoint(point - c->GetTranslate(), std::numeric_limits<float>::infinity(), closest) : -1.f;
+            }
+            if (IsHeightField(c)){
+                const HeightField* field = GetHeightField(c);
+                Vec3 closest;
+                return field ? field->ClosestPoint(point - c->GetTranslate(), std::numeric_limits<float>::infinity(), closest) : -1.f;
+            }
+            const auto& size = c->GetSize();
+            if (std::holds_alternative<float>(size)){
+                return std::max(0.f, (point - c->GetTranslate()).Length() - std::get<float>(size));
+            }
+            if (IsCapsule(c) || IsOriented(c) || IsHull(c)){
+                return DistanceTo(ConvexOf(c), point);
+            }
+            const Vec3 half = std::get<Vec3>(size) * 0.5f;
+            return std::sqrt(Bounds {c->GetTranslate() - half, c->GetTranslate() + half}.SquaredDistance(point));
+        }
+
+        /// 狭域判定の形状の種類 (Vec3 のサイズは Type::OBB の場合のみOBB, それ以外はAABB)
+        Type ShapeOf(const Collider* c) {
+            const auto& size = c->GetSize();
+            if (std::holds_alternative<float>(size)) return Type::Sphere;
+            if (std::holds_alternative<Vec3>(size)) return c->GetType() == Type::OBB ? Type::OBB : Type::AABB;
+            if (std::holds_alternative<CapsuleSize>(size)) return Type::Capsule;
+            if (IsMesh(c)) return Type::Mesh;
+            if (IsHeightField(c)) return Type::HeightField;
+            if (IsCompound(c)) return Type::Compound;
+            return Type::ConvexHull;
+        }
+
+        constexpr bool IsSurfaceType(Type type) {
+            return type == Type::Mesh || type == Type::HeightField;
+        }
+
+        /**
+         * 形状の組ごとの既定の狭域判定。
+         * 形状はコンパイル時に決まるため、組ごとに分岐の無い判定関数が生成される。
+         * B < A の組は (B, A) の判定を使い、出力を c1 から見た向きに戻す。
+         */
+        template <Type A, Type B>
+        bool DetectPair(const Collider* c1, const Collider* c2, const Manager::DetectOutput& output) {
+            if constexpr (B < A){
+                Vec3 axis = output.axis ? *output.axis * -1.f : Vec3 {};
+                std::array<uint32_t, 2> children {Event::kNoChild, Event::kNoChild};
+                const bool hit = DetectPair<B, A>(c2, c1, {output.contact, output.children ? &children : nullptr, output.axis ? &axis : nullptr});
+                if (output.axis) *output.axis = axis * -1.f;
+                if (!hit) return false;
+                if (output.contact) output.contact->normal *= -1.f;
+                if (output.children) *output.children = {children[1], children[0]};
+                return true;
+            } else if constexpr (A == Type::Compound || B == Type::Compound){
+                // 複合形状は子ごとに判定する (メッシュや地形との組み合わせも含む)
+                std::array<uint32_t, 2> indices {Event::kNoChild, Event::kNoChild};
+                if constexpr (A == Type::Compound){
+                    if (!DetectCompound(c1, c2, output.contact, indices)) return false;
+                } else{
+                    if (!DetectCompound(c2, c1, output.contact, indices)) return false;
+                    // 法線と子の番号は c2 から見たものなので入れ替える
+                    std::swap(indices[0], indices[1]);
+                    if (output.contact) output.contact->normal *= -1.f;
+                }
+                if (output.children) *output.children = indices;
+                return true;
+            } else if constexpr (IsSurfaceType(A) && IsSurfaceType(B)){
+                // 静的な形状同士は判定しない
+                return false;
+            } else if constexpr (IsSurfaceType(A)){
+                return DetectSurface(c1, ConvexOf(c2), output.contact);
+            } else if constexpr (IsSurfaceType(B)){
+                if (!DetectSurface(c2, ConvexOf(c1), output.contact)) return false;
+                // 法線はメッシュから相手向きなので反転する
+                if (output.contact) output.contact->normal *= -1.f;
+                return true;
+            } else{
+                // 離れた組はブロードフェーズの境界で除かれるので、中心間の距離では打ち切らない
+                if constexpr (A == Type::Sphere && B == Type::Sphere){
+                    const float r1 = std::get<float>(c1->GetSize());
+                    const float r2 = std::get<float>(c2->GetSize());
+                    if (!Intersection::SphereSphere(c1->GetTranslate(), r1, c2->GetTranslate(), r2)) return false;
+                    if (output.contact) *output.contact = Intersection::SphereSphereContact(c1->GetTranslate(), r1, c2->GetTranslate(), r2);
+                    return true;
+                } else if constexpr (A == Type::Sphere && B == Type::AABB){
+                    const float radius = std::get<float>(c1->GetSize());
+                    const Vec3 half = std::get<Vec3>(c2->GetSize()) * 0.5f;
+                    const Vec3 min = c2->GetTranslate() - half;
+                    const Vec3 max = c2->GetTranslate() + half;
+                    if (!Intersection::SphereAABB(c1->GetTranslate(), radius, min, max)) return false;
+                    if (output.contact) *output.contact = Intersection::SphereAABBContact(c1->GetTranslate(), radius, min, max);
+                    return true;
+                } else if constexpr (A == Type::AABB && B == Type::AABB){
+                    const Vec3 half1 = std::get<Vec3>(c1->GetSize()) * 0.5f;
+                    const Vec3 half2 = std::get<Vec3>(c2->GetSize()) * 0.5f;
+                    const Vec3 min1 = c1->GetTranslate() - half1;
+                    const Vec3 max1 = c1->GetTranslate() + half1;
+                    const Vec3 min2 = c2->GetTranslate() - half2;
+                    const Vec3 max2 = c2->GetTranslate() + half2;
+                    if (!Intersection::AABBAABB(min1, max1, min2, max2)) return false;
+                    if (output.contact) *output.contact = Intersection::AABBAABBContact(min1, max1, min2, max2);
+                    return true;
+                } else if constexpr (A == Type::Sphere && B == Type::OBB){
+                    const float radius = std::get<float>(c1->GetSize());
+                    const OrientedBox box = OrientedBox::Of(c2);
+                    if (!Intersection::SphereOBB(c1->GetTranslate(), radius, box)) return false;
+                    if (output.contact) *output.contact = Intersection::SphereOBBContact(c1->GetTranslate(), radius, box);
+                    return true;
+                } else if constexpr (B == Type::OBB){
+                    // AABB は回転無しのOBBとして扱う
+                    const OrientedBox box1 = OrientedBox::Of(c1);
+                    const OrientedBox box2 = OrientedBox::Of(c2);
+                    if (!Intersection::OBBOBB(box1, box2)) return false;
+                    if (output.contact) *output.contact = Intersection::OBBOBBContact(box1, box2);
+                    return true;
+                } else{
+                    // カプセルと凸包を含む組
+                    return DetectConvex(ConvexOf(c1), ConvexOf(c2), output.contact, output.axis);
+                }
+            }
+        }
+
+        template <size_t... I>
+        constexpr Manager::KernelTable MakeKernelTable(std::index_sequence<I...>) {
+            constexpr size_t n = Manager::kShapeCount;
+            Manager::KernelTable table {};
+            ((table[I / n][I % n] = &DetectPair<static_cast<Type>(I / n), static_cast<Type>(I % n)>), ...);
+            return table;
+        }
+
+        static_assert(static_cast<size_t>(Type::ConvexHull) + 1 == Manager::kShapeCount, "形状の種類は Type::Ray より前に並べること");
+        // 既定の狭域判定の表
+        constexpr Manager::KernelTable kDefaultKernels = MakeKernelTable(std::make_index_sequence<Manager::kShapeCount * Manager::kShapeCount>{});
+    }
+
+    Manager::Manager() :Manager(WorkerPool::GetShared()) {
+    }
+
+    Manager::Manager(std::shared_ptr<WorkerPool> workerPool)
+        :kernels_(kDefaultKernels), workerPool_(workerPool ? std::move(workerPool) : WorkerPool::GetShared()),
+         maxThreadCount_(workerPool_->GetThreadCount()), activeThreadCount_(maxThreadCount_), colliderPool_(this) {
+        // 最後の要素は Detect を呼んだスレッドが待つ間に手伝った分
+        workerBusy_ = std::make_unique<std::atomic<uint64_t>[]>(maxThreadCount_ + 1);
+        stats_.workerBusyNanoseconds.resize(maxThreadCount_ + 1);
+    }
+
+    Manager::~Manager() {
+        // Detect は自分のタスクの完了を待ってから戻るので、プールに残っているタスクはない
+        // プールのコライダーは登録情報が残っているうちに破棄する
+        colliderPool_.Clear();
     }
 
-    void Manager::WaitForTasks() {
-        std::unique_lock<std::mutex> lock(taskMutex_);
-        taskCondition_.wait(lock, [this]{
-            return tasks_.empty();
+    void Manager::AddTask(std::function<void()> task, std::atomic<uint32_t>& completed) {
+        workerPool_->Submit([this, task = std::move(task), &completed]([[maybe_unused]] uint32_t worker){
+            // 統計もトレースも無効なら時刻を読まない
+            if (COLLISION_ENABLE_STATS || tracer_.IsEnabled()){
+                const auto begin = std::chrono::steady_clock::now();
+                task();
+                const auto end = std::chrono::steady_clock::now();
+                COLLISION_STATS(workerBusy_[worker].fetch_add(ElapsedNanoseconds(begin, end), std::memory_order_relaxed));
+                if (tracer_.IsEnabled()) tracer_.Record("Task", begin, end);
+            } else{
+                task();
+            }
+            // 完了を伝えた後はこのワールドに触れない
+            completed.fetch_add(1, std::memory_order_release);
         });
     }
 
@@ -84,12 +758,36 @@ namespace Collision{
         if (isProcessingCollisions_){
             std::unique_lock<std::mutex> lock(pendingMutex_);
             pendingQueue_.push(c);
+            c->registered_ = true;
             return true;
         }
 
         // 通常登録
         std::unique_lock lock(mutex_);
-        colliders_[c->GetUniqueId()] = c;
+        colliders_[c->GetId()] = c;
+        c->registered_ = true;
+        return true;
+    }
+
+    bool Manager::RegisterMany(std::span<Collider* const> colliders) {
+        // 衝突処理中なら遅延登録
+        if (isProcessingCollisions_){
+            std::unique_lock<std::mutex> lock(pendingMutex_);
+            for (Collider* c : colliders){
+                if (!c) continue;
+                pendingQueue_.push(c);
+                c->registered_ = true;
+            }
+            return true;
+        }
+
+        std::unique_lock lock(mutex_);
+        colliders_.reserve(colliders_.size() + colliders.size());
+        for (Collider* c : colliders){
+            if (!c) continue;
+            colliders_[c->GetId()] = c;
+            c->registered_ = true;
+        }
         return true;
     }
 
@@ -98,6 +796,11 @@ namespace Collision{
 
         // 衝突処理中なら遅延解除
         if (isProcessingCollisions_){
+            {
+                // クエリから参照されないようプロキシは即座に無効化
+                std::unique_lock lock(mutex_);
+                broadPhase_.Invalidate(c->proxyIndex_, c);
+            }
             std::unique_lock<std::mutex> lock(pendingMutex_);
             unregisterQueue_.push(c);
             return true;
@@ -105,16 +808,84 @@ namespace Collision{
 
         // 通常解除
         std::unique_lock lock(mutex_);
-        colliders_.erase(c->GetUniqueId());
+        colliders_.erase(c->GetId());
+        broadPhase_.Invalidate(c->proxyIndex_, c);
+
+        const auto removed = std::ranges::remove_if(detectedPair_,
+                                                    [&c](const DetectedPair& pair){
+            return pair.ids.first == c->GetId() || pair.ids.second == c->GetId();
+        });
+        detectedPair_.erase(removed.begin(), removed.end());
+
+        return true;
+    }
+
+    bool Manager::UnregisterMany(std::span<Collider* const> colliders) {
+        // 衝突処理中なら1つずつ遅延解除
+        if (isProcessingCollisions_){
+            for (Collider* c : colliders){
+                if (!c) continue;
+                Unregister(c);
+                c->registered_ = false;
+            }
+            return true;
+        }
+
+        std::vector<uint64_t> ids;
+        ids.reserve(colliders.size());
+
+        std::unique_lock lock(mutex_);
+        for (Collider* c : colliders){
+            if (!c) continue;
+            colliders_.erase(c->GetId());
+            broadPhase_.Invalidate(c->proxyIndex_, c);
+            ids.push_back(c->GetId());
+            // デストラクタで改めて解除しない
+            c->registered_ = false;
+        }
 
-        auto it = std::ranges::remove_if(detectedPair_,
-                                         [&c](const Pair& pair){
-            return pair.first == c->GetUniqueId() || pair.second == c->GetUniqueId();
+        // 確定ペアの走査は1回だけ行う
+        std::ranges::sort(ids);
+        const auto removed = std::ranges::remove_if(detectedPair_,
+                                                    [&ids](const DetectedPair& pair){
+            return std::ranges::binary_search(ids, pair.ids.first) || std::ranges::binary_search(ids, pair.ids.second);
         });
+        detectedPair_.erase(removed.begin(), removed.end());
 
         return true;
     }
 
+    Collider* Manager::CreateCollider() {
+        Collider* collider = colliderPool_.Create();
+        Register(collider);
+        return collider;
+    }
+
+    void Manager::CreateColliders(std::span<Collider*> out) {
+        colliderPool_.Reserve(colliderPool_.GetLiveCount() + out.size());
+        for (Collider*& collider : out){
+            collider = colliderPool_.Create();
+        }
+        RegisterMany(out);
+    }
+
+    bool Manager::DestroyCollider(Collider* collider) {
+        // 衝突処理中は遅延解除の対象としてアドレスが残るので再利用を保留する
+        return colliderPool_.Destroy(collider, isProcessingCollisions_);
+    }
+
+    void Manager::DestroyColliders(std::span<Collider* const> colliders) {
+        // 登録の解除はまとめて行い、ロックと確定ペアの走査を1回にする
+        UnregisterMany(colliders);
+        for (Collider* collider : colliders){
+            DestroyCollider(collider);
+        }
+    }
+
+    void Manager::ReserveColliders(size_t count) {
+        colliderPool_.Reserve(count);
+    }
+
     void Manager::ProcessPendingRegistrations() {
         std::queue<Collider*> registrations;
         std::queue<const Collider*> unregistrations;
@@ -131,7 +902,7 @@ namespace Collision{
             registrations.pop();
 
             std::unique_lock lock(mutex_);
-            colliders_[c->GetUniqueId()] = c;
+            colliders_[c->GetId()] = c;
         }
 
         // 遅延解除を処理
@@ -140,84 +911,250 @@ namespace Collision{
             unregistrations.pop();
 
             std::unique_lock lock(mutex_);
-            colliders_.erase(c->GetUniqueId());
+            colliders_.erase(c->GetId());
 
-            auto it = std::ranges::remove_if(detectedPair_,
-                                             [&c](const Pair& pair){
-                return pair.first == c->GetUniqueId() || pair.second == c->GetUniqueId();
+            const auto removed = std::ranges::remove_if(detectedPair_,
+                                                        [&c](const DetectedPair& pair){
+                return pair.ids.first == c->GetId() || pair.ids.second == c->GetId();
             });
+            detectedPair_.erase(removed.begin(), removed.end());
         }
+
+        // 遅延解除が済んだのでプールのスロットを再利用できる
+        colliderPool_.Release();
+    }
+
+    void Manager::UpdateTransforms(std::span<Collider* const> colliders, std::span<const Vec3> translates) {
+        assert(colliders.size() == translates.size());
+        const size_t count = std::min(colliders.size(), translates.size());
+        for (size_t i = 0; i < count; ++i){
+            Collider* c = colliders[i];
+            c->translate_ = translates[i];
+            broadPhase_.UpdateBounds(c->proxyIndex_, c, Bounds::Of(c));
+        }
+    }
+
+    void Manager::UpdateTransforms(std::span<Collider* const> colliders, std::span<const Vec3> translates, std::span<const Collider::Size> sizes) {
+        assert(colliders.size() == translates.size() && colliders.size() == sizes.size());
+        const size_t count = std::min({colliders.size(), translates.size(), sizes.size()});
+        for (size_t i = 0; i < count; ++i){
+            Collider* c = colliders[i];
+            c->translate_ = translates[i];
+            c->size_ = sizes[i];
+            broadPhase_.UpdateBounds(c->proxyIndex_, c, Bounds::Of(c));
+        }
+    }
+
+    void Manager::RefitProxy(const Collider* c) {
+        broadPhase_.UpdateBounds(c->proxyIndex_, c, Bounds::Of(c));
+    }
+
+    void Manager::RefitBroadPhase() {
+        if (!broadPhase_.IsDirty()) return;
+        std::unique_lock lock(mutex_);
+        broadPhase_.Refit();
     }
 
     void Manager::Detect() {
+        const PhaseTimer<> frameTimer(nullptr, tracer_, "Detect");
+        // 前のフレームの統計をリセット
+        COLLISION_STATS({
+            auto workerBusy = std::move(stats_.workerBusyNanoseconds);
+            stats_ = {};
+            stats_.workerBusyNanoseconds = std::move(workerBusy);
+            for (uint32_t i = 0; i <= maxThreadCount_; ++i){
+                workerBusy_[i].store(0, std::memory_order_relaxed);
+            }
+            rayCasts_.store(0, std::memory_order_relaxed);
+            rayCastNanoseconds_.store(0, std::memory_order_relaxed);
+        });
+
         prePair_.clear();
         prePair_ = std::move(detectedPair_);
         detectedPair_.clear();
 
         // 処理前に遅延登録を適用
-        ProcessPendingRegistrations();
+        {
+            COLLISION_PHASE_SCOPE(Phase::Registration);
+            ProcessPendingRegistrations();
+        }
 
-        std::vector<std::pair<std::string, Collider*>> array;
+        // ブロードフェーズを再構築
         {
-            std::shared_lock lock(mutex_);
-            for (const auto& [key, value] : colliders_){
-                if (value->IsEnabled()){
-                    array.emplace_back(key, value);
-                }
+            COLLISION_PHASE_SCOPE(Phase::BroadPhase);
+            std::unique_lock lock(mutex_);
+            std::vector<BroadPhase::Proxy> proxies;
+            proxies.reserve(colliders_.size());
+            for (const auto& value : colliders_ | std::views::values){
+                if (!value->IsEnabled() || value->GetType() == Type::None) continue;
+                proxies.push_back({Bounds::Of(value), value, value->GetAttribute(), value->GetIgnore(), value->GetSubscribedEvents(), 0, static_cast<uint8_t>(ShapeOf(value))});
+            }
+
+            broadPhase_.Build(std::move(proxies));
+
+            const auto& built = broadPhase_.GetProxies();
+            for (uint32_t i = 0; i < built.size(); ++i){
+                built[i].collider->proxyIndex_ = i;
             }
         }
 
-        const size_t count = array.size();
+        const auto& proxies = broadPhase_.GetProxies();
+        const size_t count = proxies.size();
+        COLLISION_STATS(stats_.proxies = static_cast<uint32_t>(count));
         if (count == 0) return;
 
-        std::vector<std::vector<Pair>> threadResults(maxThreadCount_);
+        std::vector<std::vector<DetectedPair>> threadResults(maxThreadCount_);
+        std::vector<std::vector<SeparatingAxis>> threadAxes(maxThreadCount_);
         std::atomic<uint32_t> tasksCompleted = 0;
-        uint32_t totalTasks = std::min(maxThreadCount_, static_cast<uint32_t>(count));
-        const size_t chunkSize = std::max(1ULL, count / maxThreadCount_);
+        uint32_t totalTasks = std::min(activeThreadCount_, static_cast<uint32_t>(count));
+        const size_t chunkSize = std::max<size_t>(1, count / totalTasks);
 
-        EventTimer::GetInstance()->BeginEvent("Thread");
-        // 各スレッドにタスクを割り当て
-        for (uint32_t t = 0; t < totalTasks; ++t){
-            const size_t start = t * chunkSize;
-            const size_t end = std::min(start + chunkSize, count);
-            const uint32_t threadIndex = t;
+        // コールバックモードでは、どちらもイベントを受け取らないペアは判定しない
+        const bool requireListener = eventMode_ == EventMode::Callback;
 
-            AddTask([this, &array, &threadResults, start, end, threadIndex, &tasksCompleted](){
-                std::vector<Pair> localResults;
-
-                for (size_t i = start; i < end; ++i){
-                    const auto& [id1, c1] = array[i];
+        std::atomic<uint64_t> candidatePairs = 0;
+        {
+            // 狭域判定の時間はタスクの完了を待ち終えるまで
+            PhaseTimer<> narrowPhase(COLLISION_STATS_TARGET(Phase::NarrowPhase), tracer_, kPhaseNames[static_cast<size_t>(Phase::NarrowPhase)]);
+
+            // 各スレッドにタスクを割り当て
+            for (uint32_t t = 0; t < totalTasks; ++t){
+                const size_t start = t * chunkSize;
+                // 端数は最後のタスクが受け持つ
+                const size_t end = (t + 1 == totalTasks) ? count : std::min(start + chunkSize, count);
+                const uint32_t threadIndex = t;
+
+                AddTask([this, &proxies, &threadResults, &threadAxes, start, end, threadIndex, &candidatePairs, requireListener](){
+                    std::vector<DetectedPair> localResults;
+                    std::vector<SeparatingAxis> localAxes;
+                    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+
+                    // チャンクごとの偏りを見られるよう、候補の列挙と狭域判定を分けて記録する
+                    const bool tracing = tracer_.IsEnabled();
+                    const auto begin = tracing ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point {};
+
+                    for (size_t i = start; i < end; ++i){
+                        const auto& p1 = proxies[i];
+                        if (!p1.collider) continue;
+
+                        // 自身以降のレイヤーのうち、衝突しうるものだけを走査する
+                        const uint32_t layers = broadPhase_.GetCollidableLayers(p1.layer) & ~((1u << p1.layer) - 1);
+                        broadPhase_.Query(p1.bounds, layers, [&](uint32_t j){
+                            // 各ペアは小さい方のインデックスからのみ列挙する
+                            if (j <= i) return;
+                            const auto& p2 = proxies[j];
+
+                            if (!Filter(p1, p2)) return;
+                            if (requireListener && !(p1.events | p2.events)) return;
+                            candidates.emplace_back(static_cast<uint32_t>(i), j);
+                        });
+                    }
 
-                    for (size_t j = i + 1; j < array.size(); ++j){
-                        const auto& [id2, c2] = array[j];
+                    COLLISION_STATS(candidatePairs.fetch_add(candidates.size(), std::memory_order_relaxed));
+                    const auto queried = tracing ? std::chrono::steady_clock::now() : begin;
+                    if (tracing) tracer_.Record("Candidates", begin, queried, {{{"first", start}, {"proxies", end - start}}});
 
-                        if (!Filter({id1, id2})) continue;
+                    DetectCandidates(candidates, localResults, localAxes);
+                    if (tracing) tracer_.Record("Kernels", queried, std::chrono::steady_clock::now(), {{{"pairs", candidates.size()}, {"hits", localResults.size()}}});
 
-                        if (Detect(c1, c2)){
-                            localResults.emplace_back(id1, id2);
-                        }
-                    }
-                }
+                    threadResults[threadIndex] = std::move(localResults);
+                    threadAxes[threadIndex] = std::move(localAxes);
+                }, tasksCompleted);
+            }
 
-                threadResults[threadIndex] = std::move(localResults);
-                ++tasksCompleted;
+            // すべてのタスクが完了するまで、眠らずにプールのタスクを手伝って待つ
+            workerPool_->Wait([&tasksCompleted, totalTasks]{
+                return tasksCompleted.load(std::memory_order_acquire) == totalTasks;
             });
         }
 
-        // すべてのタスクが完了するのを待つ
-        while (tasksCompleted < totalTasks){
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-
-        EventTimer::GetInstance()->EndEvent("Thread");
         // 結果をマージ
         {
+            COLLISION_PHASE_SCOPE(Phase::Merge);
             std::unique_lock lock(mutex_);
-            for (const auto& results : threadResults){
-                for (const auto& pair : results){
-                    detectedPair_.push_back(pair);
+            for (auto& results : threadResults){
+                for (auto& pair : results){
+                    detectedPair_.push_back(std::move(pair));
                 }
             }
+
+            // 前回との差分をマージで取れるようにソートしておく
+            std::ranges::sort(detectedPair_, {}, &DetectedPair::ids);
+
+            // 今回判定したペアの分離軸だけを次回に引き継ぐ
+            separatingAxes_.clear();
+            for (auto& axes : threadAxes){
+                separatingAxes_.insert(separatingAxes_.end(), axes.begin(), axes.end());
+            }
+            std::ranges::sort(separatingAxes_, {}, &SeparatingAxis::colliders);
+        }
+
+        COLLISION_STATS({
+            stats_.candidatePairs = candidatePairs;
+            stats_.confirmedPairs = detectedPair_.size();
+            for (uint32_t i = 0; i <= maxThreadCount_; ++i){
+                stats_.workerBusyNanoseconds[i] = workerBusy_[i].load(std::memory_order_relaxed);
+            }
+        });
+    }
+
+    void Manager::DetectCandidates(std::vector<std::pair<uint32_t, uint32_t>>& candidates, std::vector<DetectedPair>& results, std::vector<SeparatingAxis>& axes) const {
+        const auto& proxies = broadPhase_.GetProxies();
+        auto bucketOf = [&proxies](const std::pair<uint32_t, uint32_t>& candidate){
+            return proxies[candidate.first].shape * kShapeCount + proxies[candidate.second].shape;
+        };
+
+        // 判定関数は境界でちょうど接する組で引数の順によって結果が変わりうるため、
+        // ブロードフェーズの並びによらず常に (小さいID, 大きいID) の順で判定する
+        // 形状の組ごとに計数ソートでまとめる
+        std::array<uint32_t, kShapeCount * kShapeCount + 1> offsets {};
+        for (auto& candidate : candidates){
+            if (proxies[candidate.second].collider->GetId() < proxies[candidate.first].collider->GetId()){
+                std::swap(candidate.first, candidate.second);
+            }
+            ++offsets[bucketOf(candidate) + 1];
+        }
+        for (size_t b = 0; b < kShapeCount * kShapeCount; ++b){
+            offsets[b + 1] += offsets[b];
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> sorted(candidates.size());
+        auto cursor = offsets;
+        for (const auto& candidate : candidates){
+            sorted[cursor[bucketOf(candidate)]++] = candidate;
+        }
+        candidates = std::move(sorted);
+
+        for (size_t b = 0; b < kShapeCount * kShapeCount; ++b){
+            if (offsets[b] == offsets[b + 1]) continue;
+
+            // 判定関数と分離軸を引き継ぐかは組ごとに決まる
+            const Kernel kernel = kernels_[b / kShapeCount][b % kShapeCount];
+            const bool warmStart = b / kShapeCount == static_cast<size_t>(Type::ConvexHull) || b % kShapeCount == static_cast<size_t>(Type::ConvexHull);
+
+            for (uint32_t k = offsets[b]; k < offsets[b + 1]; ++k){
+                const Collider* c1 = proxies[candidates[k].first].collider;
+                const Collider* c2 = proxies[candidates[k].second].collider;
+
+                // 凸包を含むペアは前回の分離軸から GJK を始める
+                Vec3 axis {};
+                const bool reversed = c2 < c1;
+                const std::pair<const Collider*, const Collider*> key {reversed ? c2 : c1, reversed ? c1 : c2};
+                if (warmStart){
+                    const auto cached = std::ranges::lower_bound(separatingAxes_, key, {}, &SeparatingAxis::colliders);
+                    if (cached != separatingAxes_.end() && cached->colliders == key){
+                        axis = reversed ? cached->axis * -1.f : cached->axis;
+                    }
+                }
+
+                Contact contact {};
+                std::array<uint32_t, 2> children {Event::kNoChild, Event::kNoChild};
+                const bool hit = kernel(c1, c2, {generateContacts_ ? &contact : nullptr, &children, warmStart ? &axis : nullptr});
+                if (warmStart) axes.push_back({key, reversed ? axis * -1.f : axis});
+                if (!hit) continue;
+
+                // c1 が小さいIDなので、そのまま (小さいID, 大きいID) の順で保持できる
+                results.push_back({{c1->GetId(), c2->GetId()}, contact, children});
+            }
         }
     }
 
@@ -225,95 +1162,152 @@ namespace Collision{
      * メインスレッドで実行されることを前提としたProcessEventメソッド
      */
     void Manager::ProcessEvent() {
+        const PhaseTimer<> frameTimer(nullptr, tracer_, "ProcessEvent");
         // 処理中フラグを立てる
         isProcessingCollisions_ = true;
 
-        std::unique_lock lock(mutex_);
+        events_.clear();
+        {
+            COLLISION_PHASE_SCOPE(Phase::EventDiff);
+            std::shared_lock lock(mutex_);
 
-        // 新規衝突の検出と継続衝突の処理
-        for (const auto& pair : detectedPair_){
-            auto itr = colliders_.find(pair.first);
-            auto otr = colliders_.find(pair.second);
+            const bool requireListener = eventMode_ == EventMode::Callback;
+            auto push = [this, requireListener](EventType type, const DetectedPair& pair){
+                const auto itr = colliders_.find(pair.ids.first);
+                const auto otr = colliders_.find(pair.ids.second);
+                if (itr == colliders_.end() || otr == colliders_.end()) return;
 
-            if (itr == colliders_.end() || otr == colliders_.end()) continue;
+                Collider* c1 = itr->second;
+                Collider* c2 = otr->second;
+                if (c1 == c2) return;
 
-            const auto& c1 = itr->second;
-            const auto& c2 = otr->second;
-            if (c1 == c2) continue;
+                // コールバックモードでは、どちらも受け取らない種類のイベントは生成しない
+                if (requireListener && !c1->IsSubscribed(type) && !c2->IsSubscribed(type)) return;
 
-            // 前回のペアから探す
-            bool isNewCollision = true;
-            for (const auto& pre : prePair_){
-                if ((pre.first == pair.first && pre.second == pair.second) ||
-                    (pre.first == pair.second && pre.second == pair.first)){
-                    isNewCollision = false;
-                    break;
-                }
+                // Exit では最後に接触していた子の番号を返す
+                events_.push_back({type, c1, c2, c1->GetOwner(), c2->GetOwner(),
+                                   type == EventType::Exit ? Contact {} : pair.contact, pair.children[0], pair.children[1]});
+            };
+
+            // detectedPair_ と prePair_ はどちらもソート済み
+            // 新規衝突の検出と継続衝突の処理
+            auto pre = prePair_.begin();
+            for (const auto& pair : detectedPair_){
+                while (pre != prePair_.end() && pre->ids < pair.ids) ++pre;
+                const bool isNewCollision = pre == prePair_.end() || pre->ids != pair.ids;
+                push(isNewCollision ? EventType::Trigger : EventType::Stay, pair);
             }
 
-            // メインスレッドでコールバック実行
-            // ロックを一時的に解放
-            lock.unlock();
+            // 終了した衝突の処理
+            auto curr = detectedPair_.begin();
+            for (const auto& pair : prePair_){
+                while (curr != detectedPair_.end() && curr->ids < pair.ids) ++curr;
+                const bool stillColliding = curr != detectedPair_.end() && curr->ids == pair.ids;
+                if (!stillColliding){
+                    push(EventType::Exit, pair);
+                }
+            }
+        }
 
-            if (isNewCollision){
-                // 新規衝突
-                c1->OnCollision({EventType::Trigger, c2});
-                c2->OnCollision({EventType::Trigger, c1});
-            } else{
-                // 継続衝突
-                c1->OnCollision({EventType::Stay, c2});
-                c2->OnCollision({EventType::Stay, c1});
+        COLLISION_STATS(for (const auto& event : events_) ++stats_.events[static_cast<size_t>(event.type)]);
+
+        // メインスレッドでコールバック実行 (ストリームモードでは利用側が GetEvents で取得する)
+        if (eventMode_ == EventMode::Callback){
+            COLLISION_PHASE_SCOPE(Phase::Dispatch);
+            const bool withContact = generateContacts_;
+            for (const auto& event : events_){
+                if (withContact && event.type != EventType::Exit){
+                    Contact reversed = event.contact;
+                    reversed.normal *= -1.f;
+                    event.collider->OnCollision({event.type, event.other, event.contact, event.child, event.otherChild});
+                    event.other->OnCollision({event.type, event.collider, reversed, event.otherChild, event.child});
+                } else{
+                    event.collider->OnCollision({event.type, event.other, event.child, event.otherChild});
+                    event.other->OnCollision({event.type, event.collider, event.otherChild, event.child});
+                }
             }
+        }
 
-            // ロックを再取得
-            lock.lock();
+        // 遅延登録を処理
+        {
+            COLLISION_PHASE_SCOPE(Phase::Registration);
+            ProcessPendingRegistrations();
         }
 
-        // 終了した衝突の処理
-        for (const auto& pre : prePair_){
-            auto itr = colliders_.find(pre.first);
-            auto otr = colliders_.find(pre.second);
+        // 処理終了フラグを下げる
+        isProcessingCollisions_ = false;
+    }
 
-            if (itr == colliders_.end() || otr == colliders_.end()) continue;
+    void Manager::SetEventMode(EventMode _mode) {
+        eventMode_ = _mode;
+    }
 
-            const auto& c1 = itr->second;
-            const auto& c2 = otr->second;
+    Manager::EventMode Manager::GetEventMode() const {
+        return eventMode_;
+    }
 
-            // 現在の衝突ペアから探す
-            bool stillColliding = false;
-            for (const auto& curr : detectedPair_){
-                if ((curr.first == pre.first && curr.second == pre.second) ||
-                    (curr.first == pre.second && curr.second == pre.first)){
-                    stillColliding = true;
-                    break;
-                }
-            }
+    std::span<const Manager::ContactEvent> Manager::GetEvents() const {
+        return events_;
+    }
 
-            // 衝突が終了した場合
-            if (!stillColliding){
-                // ロックを一時的に解放してコールバック実行
-                lock.unlock();
+    void Manager::SetGenerateContacts(bool _generate) {
+        generateContacts_ = _generate;
+    }
 
-                c1->OnCollision({EventType::Exit, c2});
-                c2->OnCollision({EventType::Exit, c1});
+    void Manager::SetThreadCount(uint32_t _count) {
+        activeThreadCount_ = _count == 0 ? maxThreadCount_ : std::min(_count, maxThreadCount_);
+    }
 
-                // ロックを再取得
-                lock.lock();
-            }
-        }
+    uint32_t Manager::GetThreadCount() const {
+        return activeThreadCount_;
+    }
 
-        // ロックを解放
-        lock.unlock();
+    uint32_t Manager::GetMaxThreadCount() const {
+        return maxThreadCount_;
+    }
 
-        // 遅延登録を処理
-        ProcessPendingRegistrations();
+    const std::shared_ptr<WorkerPool>& Manager::GetWorkerPool() const {
+        return workerPool_;
+    }
 
-        // 処理終了フラグを下げる
-        isProcessingCollisions_ = false;
+    FrameStats Manager::GetStats() const {
+        FrameStats stats = stats_;
+        COLLISION_STATS({
+            stats.rayCasts = rayCasts_.load(std::memory_order_relaxed);
+            stats.phaseNanoseconds[static_cast<size_t>(Phase::RayCast)] = rayCastNanoseconds_.load(std::memory_order_relaxed);
+        });
+        return stats;
+    }
+
+    void Manager::SetTracing(bool _enable) {
+        tracer_.SetEnabled(_enable);
+    }
+
+    bool Manager::IsTracing() const {
+        return tracer_.IsEnabled();
+    }
+
+    bool Manager::WriteTrace(const std::string& path) const {
+        return tracer_.Write(path);
+    }
+
+    void Manager::ClearTrace() {
+        tracer_.Clear();
+    }
+
+    bool Manager::RegisterKernel(Type a, Type b, Kernel kernel) {
+        const size_t i = static_cast<size_t>(a);
+        const size_t j = static_cast<size_t>(b);
+        if (kShapeCount <= i || kShapeCount <= j) return false;
+        kernels_[i][j] = kernel ? kernel : kDefaultKernels[i][j];
+        return true;
     }
 
     Manager::RayHitData Manager::RayCast(const Ray* _ray) {
         if (!_ray) return {};
+        // 共有ロックで並行に呼ばれるので stats_ には書かない
+        const PhaseTimer<std::atomic<uint64_t>> phaseTimer(COLLISION_STATS_ATOMIC_TARGET(rayCastNanoseconds_), tracer_, kPhaseNames[static_cast<size_t>(Phase::RayCast)]);
+        COLLISION_STATS(rayCasts_.fetch_add(1, std::memory_order_relaxed));
         std::shared_lock lock(mutex_);
 
         RayHitData closestData {};
@@ -328,7 +1322,7 @@ namespace Collision{
             Detect(_ray, value);
         }
 
-        if (hitRays_.empty())return {.uuid= "", .hitPoint= _ray->GetOrigin() + _ray->GetDirection() * _ray->GetLength()};
+        if (hitRays_.empty())return {.hitPoint= _ray->GetOrigin() + _ray->GetDirection() * _ray->GetLength()};
 
     	for (auto& data : hitRays_){
             float distance = (_ray->GetOrigin() - data.hitPoint).Length();
@@ -344,6 +1338,10 @@ namespace Collision{
         return closestData;
     }
 
+    std::string Manager::RayHitData::GetUniqueId() const {
+        return id ? System::FormatUniqueId(id) : std::string();
+    }
+
     Manager::RayHitData Manager::GetNextClosestHitData(float _distance)
     {
         for (auto& data : hitRaysOrderedByDistance_)
@@ -353,173 +1351,269 @@ namespace Collision{
         return RayHitData();
     }
 
-    Collider* Manager::Get(const std::string& uuid) {
-        if (!colliders_.contains(uuid))return nullptr;
+    bool Manager::TestPair(const Collider* c1, const Collider* c2, Contact* contact) const {
+        if (!c1 || !c2) return false;
+        const Kernel kernel = kernels_[static_cast<size_t>(ShapeOf(c1))][static_cast<size_t>(ShapeOf(c2))];
+        return kernel(c1, c2, {contact});
+    }
+
+    Manager::RayHitData Manager::TestRay(const Ray* _ray, const Collider* _collider) {
+        if (!_ray || !_collider) return {};
+
+        // 形状ごとの判定は hitRays_ に積むので、積んだ分だけを見て戻す
+        const size_t first = hitRays_.size();
+        Detect(_ray, _collider);
 
-        return colliders_[uuid];
+        RayHitData closestData {};
+        float closestDistance = std::numeric_limits<float>::max();
+        for (size_t i = first; i < hitRays_.size(); ++i){
+            RayHitData& data = hitRays_[i];
+            data.distance = (_ray->GetOrigin() - data.hitPoint).Length();
+            if (data.distance < closestDistance){
+                closestDistance = data.distance;
+                closestData = data;
+            }
+        }
+        hitRays_.resize(first);
+        return closestData;
     }
 
-    bool Manager::Filter(const Pair& pair) const {
-        const auto itr = colliders_.find(pair.first);
-        const auto otr = colliders_.find(pair.second);
+    Collider* Manager::Get(const std::string& uuid) {
+        uint64_t id = 0;
+        if (!System::ParseUniqueId(uuid, id))return nullptr;
 
-        if (itr == colliders_.end() || otr == colliders_.end()) return false;
+        return Get(id);
+    }
 
-        const Collider* c1 = itr->second;
-        const Collider* c2 = otr->second;
-        if (c1 == c2) return false;
-        if (!c1->IsEnabled() || !c2->IsEnabled()) return false;
-        if (c1->GetType() == Type::None || c2->GetType() == Type::None) return false;
-    	if (c1->GetAttribute() & c2->GetIgnore() || c1->GetIgnore() & c2->GetAttribute()) return false;
-        return true;
+    Collider* Manager::Get(uint64_t id) {
+        const auto itr = colliders_.find(id);
+        return itr != colliders_.end() ? itr->second : nullptr;
     }
 
-    bool Manager::Filter(const Data& data, const Data& other) {
-        if (data.uuid == other.uuid)return false;
-        if (data.type == Type::None || other.type == Type::None)return false;
-        if (data.attribute & other.ignore || data.ignore & other.attribute) return false;
-        return true;
+    size_t Manager::QuerySphere(const Vec3& center, float radius, std::span<Collider*> out, uint32_t attribute, uint32_t ignore) {
+        const Vec3 extent {radius, radius, radius};
+        return Query({center - extent, center + extent}, out, attribute, ignore, [&](const Collider* c){
+            return OverlapSphere(c, center, radius);
+        });
     }
 
+    size_t Manager::QueryAABB(const Vec3& center, const Vec3& size, std::span<Collider*> out, uint32_t attribute, uint32_t ignore) {
+        const Vec3 half = size * 0.5f;
+        const Vec3 min = center - half;
+        const Vec3 max = center + half;
+        return Query({min, max}, out, attribute, ignore, [&](const Collider* c){
+            return OverlapAABB(c, min, max);
+        });
+    }
 
-    bool Manager::Detect(const Collider* c1, const Collider* c2) {
-        float distance = (c1->GetTranslate() - c2->GetTranslate()).Length();
-        if (100.f < distance)return false;
+    size_t Manager::QueryPoint(const Vec3& point, std::span<Collider*> out, uint32_t attribute, uint32_t ignore) {
+        return Query({point, point}, out, attribute, ignore, [&](const Collider* c){
+            return OverlapPoint(c, point);
+        });
+    }
 
-    	bool sp1 = std::holds_alternative<float>(c1->GetSize());
-        bool sp2 = std::holds_alternative<float>(c2->GetSize());
-        if (sp1 && sp2){
-            // Sphere vs Sphere
-            return distance <= (std::get<float>(c1->GetSize()) + std::get<float>(c2->GetSize()));
-        } 
-        if (!sp1 && !sp2){
-            // AABB vs AABB
-            const auto& min1 = c1->GetTranslate() - std::get<Vec3>(c1->GetSize()) * 0.5f;
-            const auto& max1 = c1->GetTranslate() + std::get<Vec3>(c1->GetSize()) * 0.5f;
-            const auto& min2 = c2->GetTranslate() - std::get<Vec3>(c2->GetSize()) * 0.5f;
-            const auto& max2 = c2->GetTranslate() + std::get<Vec3>(c2->GetSize()) * 0.5f;
+    size_t Manager::QueryNearest(const Vec3& point, float maxRadius, std::span<NearestHit> out, uint32_t attribute, uint32_t ignore) {
+        std::vector<std::pair<float, uint32_t>> nearest(out.size());
 
-            return (min1.x <= max2.x && max1.x >= min2.x) &&
-                (min1.y <= max2.y && max1.y >= min2.y) &&
-                (min1.z <= max2.z && max1.z >= min2.z);
+        RefitBroadPhase();
+        std::shared_lock lock(mutex_);
+        const auto& proxies = broadPhase_.GetProxies();
+        const size_t found = broadPhase_.Nearest(point, maxRadius, broadPhase_.GetCollidableLayers(attribute, ignore), nearest, [&](uint32_t index){
+            const auto& proxy = proxies[index];
+            if (attribute & proxy.ignore || ignore & proxy.attribute) return -1.f;
+            if (!proxy.collider->IsEnabled()) return -1.f;
+            return DistanceTo(proxy.collider, point);
+        });
+
+        for (size_t i = 0; i < found; ++i){
+            out[i] = {proxies[nearest[i].second].collider, nearest[i].first};
         }
-        // AABB vs Sphere
-        const auto& aabb = sp1 ? c2 : c1;
-        const auto& sphere = sp1 ? c1 : c2;
-        const auto& aabbSize = std::get<Vec3>(static_cast<const Collider*>(aabb)->GetSize());
-        const auto& aabbTranslate = aabb->GetTranslate();
-        const auto& aabbMin = aabbTranslate - (aabbSize/2.f);
-        const auto& aabbMax = aabbTranslate + (aabbSize/2.f);
-        const auto& sphereSize = std::get<float>(static_cast<const Collider*>(sphere)->GetSize());
-        const auto& sphereTranslate = sphere->GetTranslate();
+        return found;
+    }
+
+    size_t Manager::QueryPlanes(std::span<const Plane> planes, std::span<Collider*> out, uint32_t attribute, uint32_t ignore) {
+        static_assert(kMaxQueryPlanes == PlaneSet::kMaxPlanes);
+        // 収まらない平面を黙って捨てると領域の外のコライダーを返してしまう
+        if (kMaxQueryPlanes < planes.size()) return 0;
+        const PlaneSet planeSet(planes);
+
+        RefitBroadPhase();
+        std::shared_lock lock(mutex_);
+
+        size_t found = 0;
+        const auto& proxies = broadPhase_.GetProxies();
+        broadPhase_.Cull(broadPhase_.GetCollidableLayers(attribute, ignore), [&](const Bounds& bounds){
+            return planeSet.Classify(bounds);
+        }, [&](uint32_t index, bool inside){
+            const auto& proxy = proxies[index];
+            if (attribute & proxy.ignore || ignore & proxy.attribute) return;
+            if (!proxy.collider->IsEnabled()) return;
+
+            if (!inside){
+                // OBB は外接AABBで判定する (保守的)
+                const auto& size = proxy.collider->GetSize();
+                const Containment containment = std::holds_alternative<float>(size) ?
+                    planeSet.Classify(proxy.collider->GetTranslate(), std::get<float>(size)) :
+                    planeSet.Classify(proxy.bounds);
+                if (containment == Containment::Outside) return;
+            }
 
-        return (sphereTranslate.x >= aabbMin.x - sphereSize && sphereTranslate.x <= aabbMax.x + sphereSize) &&
-            (sphereTranslate.y >= aabbMin.y - sphereSize && sphereTranslate.y <= aabbMax.y + sphereSize) &&
-            (sphereTranslate.z >= aabbMin.z - sphereSize && sphereTranslate.z <= aabbMax.z + sphereSize);
+            if (found < out.size()){
+                out[found] = proxy.collider;
+            }
+            ++found;
+        });
+        return found;
     }
 
-    void Manager::Detect(const Ray* ray, const Collider* collider) {
-        
-    	if (collider->GetType() == Type::AABB){
-            RayAABB(ray, collider);
-            return;
-        }
-        
-        RaySphere(ray, collider);
+    template <typename Test>
+    size_t Manager::Query(const Bounds& bounds, std::span<Collider*> out, uint32_t attribute, uint32_t ignore, Test&& test) {
+        RefitBroadPhase();
+        std::shared_lock lock(mutex_);
+
+        size_t found = 0;
+        const auto& proxies = broadPhase_.GetProxies();
+        broadPhase_.Query(bounds, broadPhase_.GetCollidableLayers(attribute, ignore), [&](uint32_t index){
+            const auto& proxy = proxies[index];
+            if (attribute & proxy.ignore || ignore & proxy.attribute) return;
+            if (!proxy.collider->IsEnabled()) return;
+            if (!test(proxy.collider)) return;
+
+            if (found < out.size()){
+                out[found] = proxy.collider;
+            }
+            ++found;
+        });
+        return found;
     }
 
-    void Manager::RayAABB(const Ray* ray, const Collider* collider) {
-        const Vec3& dir = ray->GetDirection();
-        const Vec3& origin = ray->GetOrigin();
-        const Vec3& center = collider->GetTranslate();
-        const Vec3& halfSize = std::get<Vec3>(collider->GetSize()) * 0.5f;
+    bool Manager::Filter(const BroadPhase::Proxy& p1, const BroadPhase::Proxy& p2) {
+        if (p1.collider == p2.collider) return false;
+        if (!p2.collider) return false;
+        if (p1.attribute & p2.ignore || p1.ignore & p2.attribute) return false;
+        return true;
+    }
 
-        Vec3 t1 = (center - halfSize - origin) / dir;
-        Vec3 t2 = (center + halfSize - origin) / dir;
+    bool Manager::Filter(const Data& data, const Data& other) {
+        if (data.id == other.id)return false;
+        if (data.type == Type::None || other.type == Type::None)return false;
+        if (data.attribute & other.ignore || data.ignore & other.attribute) return false;
+        return true;
+    }
 
-        Vec3 tminVec = {
-			std::min(t1.x, t2.x),
-			std::min(t1.y, t2.y),
-        	std::min(t1.z, t2.z),
-		};
 
-        Vec3 tmaxVec = {
-            std::max(t1.x, t2.x),
-            std::max(t1.y, t2.y),
-            std::max(t1.z, t2.z),
+    void Manager::Detect(const Ray* ray, const Collider* collider) {
+        // Type の順に並べた形状ごとのレイ判定
+        static constexpr std::array<void (Manager::*)(const Ray*, const Collider*), kShapeCount> kRayKernels {
+            &Manager::RaySphere, &Manager::RayAABB, &Manager::RayOBB, &Manager::RayCapsule,
+            &Manager::RayMesh, &Manager::RayHeightField, &Manager::RayCompound, &Manager::RayHull
         };
+        (this->*kRayKernels[static_cast<size_t>(ShapeOf(collider))])(ray, collider);
+    }
 
-        float tmin = std::max({tminVec.x, tminVec.y, tminVec.z});
-        float tmax = std::min({tmaxVec.x, tmaxVec.y, tmaxVec.z});
-
-        if (tmin > tmax || tmax < 0.0f) return;
+    void Manager::RayAABB(const Ray* ray, const Collider* collider) {
+        // 軸に平行なレイでもゼロ除算にならないよう、回転無しのOBBとして判定する
+        const OrientedBox box = OrientedBox::FromAABB(collider->GetTranslate(), std::get<Vec3>(collider->GetSize()) * 0.5f);
+        float t = 0.f;
+        if (!Intersection::RayOBB(ray->GetOrigin(), ray->GetDirection(), box, t)) return;
 
-        float t = (tmin >= 0.0f) ? tmin : tmax;
-        if (0.0f <= t && t <= ray->GetLength()) {
+        if (t <= ray->GetLength()){
             RayHitData hitData {
-                .uuid = collider->GetUniqueId(),
+                .id = collider->GetId(),
                 .hitPoint = ray->GetPoint(t)
             };
             hitRays_.push_back(hitData);
         }
     }
 
-    void Manager::RaySphere(const Ray* ray, const Collider* collider) {
-        // レイの原点からコライダーの中心へのベクトル
-        float dx = collider->GetTranslate().x - ray->GetOrigin().x;
-        float dy = collider->GetTranslate().y - ray->GetOrigin().y;
-        float dz = collider->GetTranslate().z - ray->GetOrigin().z;
-
-        // レイの方向ベクトル上でのコライダー中心への射影
-        float projection_length = dx * ray->GetDirection().x + dy * ray->GetDirection().y + dz * ray->GetDirection().z;
-
-        // レイの後ろにコライダーがある場合は衝突なし
-        if (projection_length < 0){
-            return;
-        }
+    void Manager::RayOBB(const Ray* ray, const Collider* collider) {
+        float t = 0.f;
+        if (!Intersection::RayOBB(ray->GetOrigin(), ray->GetDirection(), OrientedBox::Of(collider), t)) return;
 
-        // レイの最大長より遠い場合も衝突なし
-        if (projection_length > ray->GetLength()){
-            return;
+        if (0.0f <= t && t <= ray->GetLength()){
+            RayHitData hitData {
+                .id = collider->GetId(),
+                .hitPoint = ray->GetPoint(t)
+            };
+            hitRays_.push_back(hitData);
         }
+    }
 
-        // 射影点からコライダー中心までの距離の2乗
-        float d2 = dx * dx + dy * dy + dz * dz - projection_length * projection_length;
+    void Manager::RayCapsule(const Ray* ray, const Collider* collider) {
+        float t = 0.f;
+        if (!Intersection::RayCapsule(ray->GetOrigin(), ray->GetDirection(), Capsule::Of(collider), t)) return;
 
-        // コライダーの半径の2乗
-        float r2;
-        if (std::holds_alternative<float>(collider->GetSize())){
-            r2 = std::get<float>(collider->GetSize()) * std::get<float>(collider->GetSize());
-        } else{
-            r2 = std::get<Vec3>(collider->GetSize()).x;
-            r2 *= r2;
+        if (t <= ray->GetLength()){
+            RayHitData hitData {
+                .id = collider->GetId(),
+                .hitPoint = ray->GetPoint(t)
+            };
+            hitRays_.push_back(hitData);
         }
+    }
 
-        // 距離が半径より大きければ衝突なし
-        if (d2 > r2){
-            return;
-        }
+    void Manager::RayHull(const Ray* ray, const Collider* collider) {
+        float t = 0.f;
+        const auto shape = ConvexOf(collider);
+        if (!Intersection::RayConvex(ray->GetOrigin(), ray->GetDirection(), std::get<SupportShape>(shape), ray->GetLength(), t)) return;
 
-        // ここまで来れば衝突している
-        // 衝突点までの距離を計算
-        float t = projection_length - std::sqrt(r2 - d2);
+        RayHitData hitData {
+            .id = collider->GetId(),
+            .hitPoint = ray->GetPoint(t)
+        };
+        hitRays_.push_back(hitData);
+    }
 
-        // レイの範囲内で最も近い衝突点を計算
-        if (t < 0){
-            t = projection_length - sqrtf(r2 - d2);
+    void Manager::RayMesh(const Ray* ray, const Collider* collider) {
+        const TriangleMesh* mesh = GetMesh(collider);
+        float t = 0.f;
+        if (!mesh || !mesh->RayCast(ray->GetOrigin() - collider->GetTranslate(), ray->GetDirection(), ray->GetLength(), t)) return;
 
-            if (t < 0){
-                t = 0.f;
-            }
-        }
+        RayHitData hitData {
+            .id = collider->GetId(),
+            .hitPoint = ray->GetPoint(t)
+        };
+        hitRays_.push_back(hitData);
+    }
+
+    void Manager::RayHeightField(const Ray* ray, const Collider* collider) {
+        const HeightField* field = GetHeightField(collider);
+        float t = 0.f;
+        if (!field || !field->RayCast(ray->GetOrigin() - collider->GetTranslate(), ray->GetDirection(), ray->GetLength(), t)) return;
 
-        t = std::min(t, ray->GetLength());
+        RayHitData hitData {
+            .id = collider->GetId(),
+            .hitPoint = ray->GetPoint(t)
+        };
+        hitRays_.push_back(hitData);
+    }
 
-        // 衝突点の座標を計算
-        Vec3 hit_point = ray->GetPoint(t);
+    void Manager::RayCompound(const Ray* ray, const Collider* collider) {
+        const CompoundShape* shape = GetCompound(collider);
+        float t = 0.f;
+        uint32_t child = Event::kNoChild;
+        if (!shape || !shape->RayCast(ray->GetOrigin() - collider->GetTranslate(), ray->GetDirection(), ray->GetLength(), t, child)) return;
 
-        // 衝突データを作成
-        RayHitData hitData {.uuid = collider->GetUniqueId(), .hitPoint = hit_point};
+        RayHitData hitData {
+            .id = collider->GetId(),
+            .hitPoint = ray->GetPoint(t),
+            .child = child
+        };
         hitRays_.push_back(hitData);
     }
+
+    void Manager::RaySphere(const Ray* ray, const Collider* collider) {
+        // 球は長さ0のカプセルとして判定する (原点が内部なら距離0)
+        const Vec3& center = collider->GetTranslate();
+        float t = 0.f;
+        if (!Intersection::RayCapsule(ray->GetOrigin(), ray->GetDirection(), {center, center, std::get<float>(collider->GetSize())}, t)) return;
+
+        if (t <= ray->GetLength()){
+            RayHitData hitData {
+                .id = collider->GetId(),
+                .hitPoint = ray->GetPoint(t)
+            };
+            hitRays_.push_back(hitData);
+        }
+    }
 }
@@ -0,0 +1,91 @@
+#include "Collision/CompoundShape.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "BoundsTree.h"
+#include "Capsule.h"
+#include "OrientedBox.h"
+
+namespace Collision{
+    namespace{
+        Bounds ChildBounds(const CompoundShape::Child& child) {
+            const Vec3 half = std::holds_alternative<float>(child.size) ?
+                Vec3 {std::get<float>(child.size), std::get<float>(child.size), std::get<float>(child.size)} :
+                std::get<Vec3>(child.size) * 0.5f;
+            return {child.offset - half, child.offset + half};
+        }
+    }
+
+    CompoundShape::CompoundShape(std::span<const Child> children) :children_(children.begin(), children.end()) {
+        const uint32_t count = static_cast<uint32_t>(children_.size());
+        if (count == 0) return;
+
+        childBounds_.resize(count);
+        for (uint32_t i = 0; i < count; ++i){
+            childBounds_[i] = ChildBounds(children_[i]);
+            bounds_ = i == 0 ? childBounds_[i] : bounds_.Merge(childBounds_[i]);
+        }
+
+        order_.resize(count);
+        std::iota(order_.begin(), order_.end(), 0u);
+        nodes_.reserve(count / kLeafSize * 2 + 1);
+        BuildMedianSplit<kLeafSize, kMaxDepth>(nodes_, order_, childBounds_, 0, count, [](const Bounds& bounds, uint32_t index, uint32_t size){
+            return Node {bounds, index, size};
+        });
+    }
+
+    const Bounds& CompoundShape::GetBounds() const {
+        return bounds_;
+    }
+
+    std::span<const CompoundShape::Child> CompoundShape::GetChildren() const {
+        return children_;
+    }
+
+    const Bounds& CompoundShape::GetChildBounds(uint32_t index) const {
+        return childBounds_[index];
+    }
+
+    bool CompoundShape::RayCast(const Vec3& origin, const Vec3& direction, float maxDistance, float& t, uint32_t& child) const {
+        if (nodes_.empty()) return false;
+
+        const Vec3 inverse {1.f / direction.x, 1.f / direction.y, 1.f / direction.z};
+        float best = maxDistance;
+        bool hit = false;
+
+        uint32_t stack[kMaxDepth * 2];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top){
+            const uint32_t nodeIndex = stack[--top];
+            const Node& node = nodes_[nodeIndex];
+            if (RayBounds(origin, inverse, node.bounds, best) < 0.f) continue;
+
+            if (!node.count){
+                stack[top++] = node.index;
+                stack[top++] = nodeIndex + 1;
+                continue;
+            }
+
+            for (uint32_t i = node.index; i < node.index + node.count; ++i){
+                const Child& candidate = children_[order_[i]];
+                float distance = 0.f;
+                // 球は長さ0のカプセルとして判定する
+                const bool intersects = std::holds_alternative<float>(candidate.size) ?
+                    Intersection::RayCapsule(origin, direction, {candidate.offset, candidate.offset, std::get<float>(candidate.size)}, distance) :
+                    Intersection::RayOBB(origin, direction, OrientedBox::FromAABB(candidate.offset, std::get<Vec3>(candidate.size) * 0.5f), distance);
+                if (intersects && 0.f <= distance && distance <= best){
+                    best = distance;
+                    child = order_[i];
+                    hit = true;
+                }
+            }
+        }
+
+        if (hit) t = best;
+        return hit;
+    }
+}
@@ -0,0 +1,35 @@
+#include "Collision/ConvexHull.h"
+
+#include <cassert>
+
+namespace Collision{
+    ConvexHull::ConvexHull(std::span<const Vec3> vertices) :vertices_(vertices.begin(), vertices.end()) {
+        assert(!vertices_.empty());
+
+        bounds_ = {vertices_[0], vertices_[0]};
+        for (const Vec3& vertex : vertices_){
+            bounds_ = bounds_.Merge({vertex, vertex});
+        }
+    }
+
+    const Bounds& ConvexHull::GetBounds() const {
+        return bounds_;
+    }
+
+    std::span<const Vec3> ConvexHull::GetVertices() const {
+        return vertices_;
+    }
+
+    const Vec3& ConvexHull::Support(const Vec3& direction) const {
+        const Vec3* best = &vertices_[0];
+        float bestDot = best->Dot(direction);
+        for (const Vec3& vertex : vertices_){
+            const float d = vertex.Dot(direction);
+            if (bestDot < d){
+                bestDot = d;
+                best = &vertex;
+            }
+        }
+        return *best;
+    }
+}
@@ -0,0 +1,553 @@
+#include "Gjk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Collision/ConvexHull.h"
+
+namespace Collision{
+    namespace{
+        constexpr int kMaxIterations = 64;
+        // 最近点が縮まなくなったとみなす相対誤差
+        constexpr float kTolerance = 1e-5f;
+        // 原点と重なっているとみなす二乗距離
+        constexpr float kEpsilon = 1e-10f;
+        // 原点と重なっているとみなす距離 (kEpsilon の平方根)
+        constexpr float kContactDistance = 1e-5f;
+        // EPA で面がこれ以上広がらなくなったとみなす距離
+        constexpr float kEpaTolerance = 1e-4f;
+
+        // ミンコフスキー差 a - b 上の点と、それを作った a, b 上の点
+        struct Vertex{
+            Vec3 w;
+            Vec3 a;
+            Vec3 b;
+        };
+
+        struct Simplex{
+            std::array<Vertex, 4> vertices;
+            // 原点に最も近い点の重心座標
+            std::array<float, 4> weights;
+            int count = 0;
+        };
+
+        Vertex Support(const SupportShape& a, const SupportShape& b, const Vec3& direction) {
+            const Vec3 pa = a.Support(direction);
+            const Vec3 pb = b.Support(direction * -1.f);
+            return {pa - pb, pa, pb};
+        }
+
+        Simplex Make(std::initializer_list<Vertex> vertices, std::initializer_list<float> weights) {
+            Simplex s;
+            std::copy(vertices.begin(), vertices.end(), s.vertices.begin());
+            std::copy(weights.begin(), weights.end(), s.weights.begin());
+            s.count = static_cast<int>(vertices.size());
+            return s;
+        }
+
+        Vec3 ClosestPoint(const Simplex& s) {
+            Vec3 point {};
+            for (int i = 0; i < s.count; ++i){
+                point += s.vertices[i].w * s.weights[i];
+            }
+            return point;
+        }
+
+        // 線分上で原点に最も近い点を求め、寄与する頂点だけを残す
+        Simplex ReduceSegment(const Vertex& a, const Vertex& b) {
+            const Vec3 ab = b.w - a.w;
+            const float denom = ab.Dot(ab);
+            const float t = denom > 0.f ? std::clamp(-a.w.Dot(ab) / denom, 0.f, 1.f) : 0.f;
+            if (t <= 0.f) return Make({a}, {1.f});
+            if (t >= 1.f) return Make({b}, {1.f});
+            return Make({a, b}, {1.f - t, t});
+        }
+
+        // 三角形上で原点に最も近い点を求め、寄与する頂点だけを残す (ボロノイ領域で場合分け)
+        Simplex ReduceTriangle(const Vertex& a, const Vertex& b, const Vertex& c) {
+            const Vec3 ab = b.w - a.w;
+            const Vec3 ac = c.w - a.w;
+            const float d1 = -ab.Dot(a.w);
+            const float d2 = -ac.Dot(a.w);
+            if (d1 <= 0.f && d2 <= 0.f) return Make({a}, {1.f});
+
+            const float d3 = -ab.Dot(b.w);
+            const float d4 = -ac.Dot(b.w);
+            if (d3 >= 0.f && d4 <= d3) return Make({b}, {1.f});
+
+            const float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f){
+                const float t = d1 / std::max(d1 - d3, std::numeric_limits<float>::min());
+                return Make({a, b}, {1.f - t, t});
+            }
+
+            const float d5 = -ab.Dot(c.w);
+            const float d6 = -ac.Dot(c.w);
+            if (d6 >= 0.f && d5 <= d6) return Make({c}, {1.f});
+
+            const float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f){
+                const float t = d2 / std::max(d2 - d6, std::numeric_limits<float>::min());
+                return Make({a, c}, {1.f - t, t});
+            }
+
+            const float va = d3 * d6 - d5 * d4;
+            if (va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f){
+                const float t = (d4 - d3) / std::max((d4 - d3) + (d5 - d6), std::numeric_limits<float>::min());
+                return Make({b, c}, {1.f - t, t});
+            }
+
+            // 潰れた三角形は最も近い辺で代用する
+            const float sum = va + vb + vc;
+            if (sum <= 1e-6f * ab.SquaredLength() * ac.SquaredLength()){
+                Simplex best = ReduceSegment(a, b);
+                for (const Simplex& edge : {ReduceSegment(a, c), ReduceSegment(b, c)}){
+                    if (ClosestPoint(edge).SquaredLength() < ClosestPoint(best).SquaredLength()) best = edge;
+                }
+                return best;
+            }
+
+            const float v = vb / sum;
+            const float w = vc / sum;
+            return Make({a, b, c}, {1.f - v - w, v, w});
+        }
+
+        // 原点が三角形 abc の平面に対して d の反対側にあるか
+        bool OriginOutside(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d) {
+            const Vec3 n = Vec3::Cross(b - a, c - a);
+            return -a.Dot(n) * (d - a).Dot(n) < 0.f;
+        }
+
+        // 四面体上で原点に最も近い点を求め、寄与する頂点だけを残す (原点を含めば4点のまま)
+        Simplex ReduceTetrahedron(const Simplex& s) {
+            const auto& [a, b, c, d] = s.vertices;
+            const float scale = std::max({(b.w - a.w).SquaredLength(), (c.w - a.w).SquaredLength(), (d.w - a.w).SquaredLength()});
+            const float volume = (b.w - a.w).Dot(Vec3::Cross(c.w - a.w, d.w - a.w));
+            // 潰れた四面体は内外を判定できないので全ての面を調べる
+            const bool flat = std::abs(volume) <= 1e-6f * scale * std::sqrt(scale);
+
+            const std::array<std::array<const Vertex*, 4>, 4> faces {{
+                {&a, &b, &c, &d}, {&a, &c, &d, &b}, {&a, &d, &b, &c}, {&b, &d, &c, &a}
+            }};
+            Simplex best = s;
+            float bestDistance = std::numeric_limits<float>::max();
+            for (const auto& [p, q, r, opposite] : faces){
+                if (!flat && !OriginOutside(p->w, q->w, r->w, opposite->w)) continue;
+                const Simplex face = ReduceTriangle(*p, *q, *r);
+                const float distance = ClosestPoint(face).SquaredLength();
+                if (distance < bestDistance){
+                    bestDistance = distance;
+                    best = face;
+                }
+            }
+            return best;
+        }
+
+        // 単体上で原点に最も近い点を求める
+        Vec3 Reduce(Simplex& s) {
+            switch (s.count){
+                case 1:
+                    s.weights[0] = 1.f;
+                    break;
+                case 2:
+                    s = ReduceSegment(s.vertices[0], s.vertices[1]);
+                    break;
+                case 3:
+                    s = ReduceTriangle(s.vertices[0], s.vertices[1], s.vertices[2]);
+                    break;
+                default:
+                    s = ReduceTetrahedron(s);
+                    if (s.count == 4) return {};
+                    break;
+            }
+            return ClosestPoint(s);
+        }
+
+        /**
+         * GJK の本体です。
+         * @return 芯同士の距離 (重なっていれば0, 打ち切った場合は limit より大きい下限値)
+         */
+        float Run(const SupportShape& a, const SupportShape& b, Vec3& axis, float limit, Simplex& s) {
+            Vec3 v = axis * -1.f;
+            if (v.SquaredLength() <= kEpsilon){
+                v = a.Center() - b.Center();
+                if (v.SquaredLength() <= kEpsilon) v = {1.f, 0.f, 0.f};
+            }
+
+            s.count = 0;
+            for (int i = 0; i < kMaxIterations; ++i){
+                const Vertex w = Support(a, b, v * -1.f);
+                const float vv = v.SquaredLength();
+                const float vw = v.Dot(w.w);
+
+                // v を法線とする平面で分離でき、距離の下限が limit を超える
+                // 最近点が kContactDistance 以内なら重なりとみなすのに揃え、初期方向によって接する組の結果が変わらないようにする
+                const float separation = limit + kContactDistance;
+                if (0.f < vw && separation * separation * vv < vw * vw){
+                    const float length = std::sqrt(vv);
+                    axis = v * (-1.f / length);
+                    return vw / length;
+                }
+
+                // 新しい点で最近点が縮まらなければ収束 (初回の v は単体上の点ではない)
+                if (s.count && vv - vw <= kTolerance * vv) break;
+                const bool duplicate = std::any_of(s.vertices.begin(), s.vertices.begin() + s.count, [&w](const Vertex& vertex){
+                    return (vertex.w - w.w).SquaredLength() <= kEpsilon;
+                });
+                if (duplicate) break;
+
+                s.vertices[s.count++] = w;
+                v = Reduce(s);
+                if (s.count == 4 || v.SquaredLength() <= kEpsilon) return 0.f;
+            }
+
+            const float distance = v.Length();
+            axis = v * (-1.f / distance);
+            return distance;
+        }
+
+        void Witness(const Simplex& s, Vec3& pointA, Vec3& pointB) {
+            pointA = {};
+            pointB = {};
+            for (int i = 0; i < s.count; ++i){
+                pointA += s.vertices[i].a * s.weights[i];
+                pointB += s.vertices[i].b * s.weights[i];
+            }
+        }
+
+        struct Face{
+            int a;
+            int b;
+            int c;
+            // 外向きの法線
+            Vec3 normal;
+            // 原点からの距離
+            float distance;
+        };
+
+        bool MakeFace(const std::vector<Vertex>& vertices, int a, int b, int c, Face& face) {
+            Vec3 normal = Vec3::Cross(vertices[b].w - vertices[a].w, vertices[c].w - vertices[a].w);
+            const float length = normal.Length();
+            if (length <= kEpsilon) return false;
+            normal /= length;
+            face = {a, b, c, normal, normal.Dot(vertices[a].w)};
+            return true;
+        }
+
+        // 原点で重なった単体を、体積を持つ四面体まで広げる
+        bool Expand(const SupportShape& a, const SupportShape& b, Simplex& s) {
+            static const Vec3 kDirections[] = {
+                {1.f, 0.f, 0.f}, {-1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, -1.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, 0.f, -1.f}
+            };
+
+            if (s.count == 1){
+                for (const Vec3& direction : kDirections){
+                    const Vertex w = Support(a, b, direction);
+                    if (kEpsilon < (w.w - s.vertices[0].w).SquaredLength()){
+                        s.vertices[s.count++] = w;
+                        break;
+                    }
+                }
+                if (s.count == 1) return false;
+            }
+
+            if (s.count == 2){
+                const Vec3 d = s.vertices[1].w - s.vertices[0].w;
+                // 線分と最も直交に近い座標軸から垂直な向きを作る
+                const Vec3 ad {std::abs(d.x), std::abs(d.y), std::abs(d.z)};
+                const Vec3 e = ad.x <= ad.y && ad.x <= ad.z ? Vec3 {1.f, 0.f, 0.f} : ad.y <= ad.z ? Vec3 {0.f, 1.f, 0.f} : Vec3 {0.f, 0.f, 1.f};
+                const Vec3 p = Vec3::Cross(d, e).Normalized();
+                const Vec3 q = Vec3::Cross(d, p).Normalized();
+                for (const Vec3& direction : {p, p * -1.f, q, q * -1.f}){
+                    const Vertex w = Support(a, b, direction);
+                    if (kEpsilon * d.SquaredLength() < Vec3::Cross(d, w.w - s.vertices[0].w).SquaredLength()){
+                        s.vertices[s.count++] = w;
+                        break;
+                    }
+                }
+                if (s.count == 2) return false;
+            }
+
+            if (s.count == 3){
+                const Vec3 n = Vec3::Cross(s.vertices[1].w - s.vertices[0].w, s.vertices[2].w - s.vertices[0].w);
+                const float length = n.Length();
+                if (length <= kEpsilon) return false;
+                for (const Vec3& direction : {n, n * -1.f}){
+                    const Vertex w = Support(a, b, direction);
+                    if (std::sqrt(kEpsilon) * length < std::abs(n.Dot(w.w - s.vertices[0].w))){
+                        s.vertices[s.count++] = w;
+                        break;
+                    }
+                }
+                if (s.count == 3) return false;
+            }
+            return true;
+        }
+
+        /**
+         * EPA で芯同士の侵入量を求めます。
+         * @param s GJK が原点と重なったと判定した単体
+         * @param normal 法線の出力先 (a から b へ向かう向き)
+         * @param depth 侵入量の出力先
+         * @param pointA a の芯上の点の出力先
+         * @param pointB b の芯上の点の出力先
+         * @return 求められた場合はtrue (芯が平たい場合などは false)
+         */
+        bool Epa(const SupportShape& a, const SupportShape& b, Simplex s, Vec3& normal, float& depth, Vec3& pointA, Vec3& pointB) {
+            if (!Expand(a, b, s)) return false;
+
+            std::vector<Vertex> vertices(s.vertices.begin(), s.vertices.end());
+            std::vector<Face> faces;
+            faces.reserve(kMaxIterations * 2);
+            const Vec3 centroid = (vertices[0].w + vertices[1].w + vertices[2].w + vertices[3].w) * 0.25f;
+            constexpr int kTetrahedron[4][3] = {{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+            for (const auto& [i, j, k] : kTetrahedron){
+                Face face {};
+                if (!MakeFace(vertices, i, j, k, face)) return false;
+                // 四面体の外側を向くよう揃える
+                if (0.f < face.normal.Dot(centroid - vertices[i].w)) MakeFace(vertices, i, k, j, face);
+                faces.push_back(face);
+            }
+
+            std::vector<std::pair<int, int>> horizon;
+            Face closest = faces[0];
+            for (int iteration = 0; iteration < kMaxIterations; ++iteration){
+                closest = *std::ranges::min_element(faces, {}, &Face::distance);
+                const Vertex w = Support(a, b, closest.normal);
+                if (w.w.Dot(closest.normal) - closest.distance <= kEpaTolerance) break;
+
+                // w から見える面を取り除き、その境界の辺と w で穴を塞ぐ
+                horizon.clear();
+                auto addEdge = [&horizon](int p, int q){
+                    const auto shared = std::ranges::find(horizon, std::pair {q, p});
+                    if (shared != horizon.end()){
+                        horizon.erase(shared);
+                    } else{
+                        horizon.emplace_back(p, q);
+                    }
+                };
+                const auto removed = std::ranges::remove_if(faces, [&](const Face& face){
+                    if (face.normal.Dot(w.w - vertices[face.a].w) <= 0.f) return false;
+                    addEdge(face.a, face.b);
+                    addEdge(face.b, face.c);
+                    addEdge(face.c, face.a);
+                    return true;
+                });
+                faces.erase(removed.begin(), removed.end());
+
+                vertices.push_back(w);
+                const int apex = static_cast<int>(vertices.size()) - 1;
+                for (const auto& [p, q] : horizon){
+                    Face face {};
+                    if (MakeFace(vertices, p, q, apex, face)) faces.push_back(face);
+                }
+                if (faces.empty()) return false;
+            }
+
+            normal = closest.normal;
+            depth = std::max(closest.distance, 0.f);
+
+            // 原点から面へ下ろした点の重心座標で元の形状上の点を求める
+            const Vertex& va = vertices[closest.a];
+            const Vertex& vb = vertices[closest.b];
+            const Vertex& vc = vertices[closest.c];
+            const Vec3 e0 = vb.w - va.w;
+            const Vec3 e1 = vc.w - va.w;
+            const Vec3 e2 = normal * closest.distance - va.w;
+            const float d00 = e0.Dot(e0);
+            const float d01 = e0.Dot(e1);
+            const float d11 = e1.Dot(e1);
+            const float d20 = e2.Dot(e0);
+            const float d21 = e2.Dot(e1);
+            const float denom = d00 * d11 - d01 * d01;
+            const float v = denom != 0.f ? (d11 * d20 - d01 * d21) / denom : 0.f;
+            const float u = denom != 0.f ? (d00 * d21 - d01 * d20) / denom : 0.f;
+            pointA = va.a * (1.f - v - u) + vb.a * v + vc.a * u;
+            pointB = va.b * (1.f - v - u) + vb.b * v + vc.b * u;
+            return true;
+        }
+    }
+
+    SupportShape SupportShape::Sphere(const Vec3& center, float radius) {
+        SupportShape shape;
+        shape.kind = Kind::Point;
+        shape.center = center;
+        shape.radius = radius;
+        return shape;
+    }
+
+    SupportShape SupportShape::Segment(const Vec3& a, const Vec3& b, float radius) {
+        SupportShape shape;
+        shape.kind = Kind::Segment;
+        shape.center = (a + b) * 0.5f;
+        shape.vertices = {a, b, b};
+        shape.radius = radius;
+        return shape;
+    }
+
+    SupportShape SupportShape::Triangle(const Vec3& a, const Vec3& b, const Vec3& c) {
+        SupportShape shape;
+        shape.kind = Kind::Triangle;
+        shape.center = (a + b + c) / 3.f;
+        shape.vertices = {a, b, c};
+        return shape;
+    }
+
+    SupportShape SupportShape::Box(const OrientedBox& box) {
+        SupportShape shape;
+        shape.kind = Kind::Box;
+        shape.center = box.center;
+        shape.axes = box.axes;
+        shape.vertices[0] = box.half;
+        return shape;
+    }
+
+    SupportShape SupportShape::Hull(const ConvexHull& hull, const Vec3& center, const std::array<Vec3, 3>& axes) {
+        SupportShape shape;
+        shape.kind = Kind::Hull;
+        shape.center = center;
+        shape.axes = axes;
+        shape.hull = &hull;
+        return shape;
+    }
+
+    Vec3 SupportShape::Support(const Vec3& direction) const {
+        switch (kind){
+            case Kind::Point:
+                return center;
+            case Kind::Segment:
+                return direction.Dot(vertices[1] - vertices[0]) < 0.f ? vertices[0] : vertices[1];
+            case Kind::Triangle:
+            {
+                const float d0 = direction.Dot(vertices[0]);
+                const float d1 = direction.Dot(vertices[1]);
+                const float d2 = direction.Dot(vertices[2]);
+                if (d1 <= d0 && d2 <= d0) return vertices[0];
+                return d2 <= d1 ? vertices[1] : vertices[2];
+            }
+            case Kind::Box:
+            {
+                const Vec3& half = vertices[0];
+                return center +
+                    axes[0] * (direction.Dot(axes[0]) < 0.f ? -half.x : half.x) +
+                    axes[1] * (direction.Dot(axes[1]) < 0.f ? -half.y : half.y) +
+                    axes[2] * (direction.Dot(axes[2]) < 0.f ? -half.z : half.z);
+            }
+            case Kind::Hull:
+            {
+                // ローカル座標で最も遠い頂点を探してワールド座標へ戻す
+                const Vec3& p = hull->Support({direction.Dot(axes[0]), direction.Dot(axes[1]), direction.Dot(axes[2])});
+                return center + axes[0] * p.x + axes[1] * p.y + axes[2] * p.z;
+            }
+        }
+        return center;
+    }
+
+    Vec3 SupportShape::Center() const {
+        if (kind != Kind::Hull) return center;
+        const Vec3 p = hull->GetBounds().Center();
+        return center + axes[0] * p.x + axes[1] * p.y + axes[2] * p.z;
+    }
+
+    Bounds SupportShape::GetBounds() const {
+        const Vec3 extent {radius, radius, radius};
+        const Vec3 x {1.f, 0.f, 0.f};
+        const Vec3 y {0.f, 1.f, 0.f};
+        const Vec3 z {0.f, 0.f, 1.f};
+        return {
+            Vec3 {Support(x * -1.f).x, Support(y * -1.f).y, Support(z * -1.f).z} - extent,
+            Vec3 {Support(x).x, Support(y).y, Support(z).z} + extent
+        };
+    }
+
+    SupportShape SupportShape::Translated(const Vec3& offset) const {
+        SupportShape shape = *this;
+        shape.center += offset;
+        // Box の vertices[0] は大きさなので動かさない
+        if (kind == Kind::Segment || kind == Kind::Triangle){
+            for (Vec3& vertex : shape.vertices){
+                vertex += offset;
+            }
+        }
+        return shape;
+    }
+
+    namespace Intersection{
+        float GjkDistance(const SupportShape& a, const SupportShape& b, Vec3& axis, float limit, Vec3& pointA, Vec3& pointB) {
+            Simplex s;
+            const float distance = Run(a, b, axis, limit, s);
+            if (0.f < distance && distance <= limit) Witness(s, pointA, pointB);
+            return distance;
+        }
+
+        bool GjkOverlap(const SupportShape& a, const SupportShape& b, Vec3& axis) {
+            Simplex s;
+            const float margin = a.radius + b.radius;
+            // 収束の誤差で初期方向によって結果が変わらないよう、早期の分離判定と同じ幅の余裕を持たせる
+            return Run(a, b, axis, margin, s) <= margin + kContactDistance;
+        }
+
+        Contact GjkContact(const SupportShape& a, const SupportShape& b, Vec3& axis) {
+            Simplex s;
+            const float margin = a.radius + b.radius;
+            const float distance = Run(a, b, axis, std::numeric_limits<float>::infinity(), s);
+
+            Vec3 pointA;
+            Vec3 pointB;
+            // 芯が離れていれば最近点を結ぶ向きが法線
+            if (0.f < distance){
+                Witness(s, pointA, pointB);
+                const Vec3 normal = (pointB - pointA) / distance;
+                axis = normal;
+                return {normal, margin - distance, (pointA + normal * a.radius + pointB - normal * b.radius) * 0.5f};
+            }
+
+            Vec3 normal;
+            float depth = 0.f;
+            if (!Epa(a, b, s, normal, depth, pointA, pointB)){
+                // 芯が平たく侵入量を求められない場合は中心間の向きで押し出す
+                normal = b.Center() - a.Center();
+                normal = kEpsilon < normal.SquaredLength() ? normal.Normalized() : Vec3::Up;
+                return {normal, margin, (a.Center() + b.Center()) * 0.5f};
+            }
+            axis = normal;
+            return {normal, depth + margin, (pointA + normal * a.radius + pointB - normal * b.radius) * 0.5f};
+        }
+
+        bool RayConvex(const Vec3& origin, const Vec3& direction, const SupportShape& shape, float maxDistance, float& t) {
+            // 交点までレイを進めながら、現在の点と形状との最近点を GJK で求める
+            float lambda = 0.f;
+            Vec3 x = origin;
+            Vec3 v = x - shape.Center();
+            Simplex s;
+
+            for (int i = 0; i < kMaxIterations && kEpsilon < v.SquaredLength(); ++i){
+                const Vec3 p = shape.Support(v);
+                const float vw = v.Dot(x - p);
+                if (0.f < vw){
+                    // v を法線とする平面まで進める
+                    const float vr = v.Dot(direction);
+                    if (0.f <= vr) return false;
+                    lambda -= vw / vr;
+                    if (maxDistance < lambda) return false;
+                    x = origin + direction * lambda;
+                    for (int j = 0; j < s.count; ++j){
+                        s.vertices[j].w = x - s.vertices[j].a;
+                    }
+                }
+
+                const bool duplicate = std::any_of(s.vertices.begin(), s.vertices.begin() + s.count, [&p](const Vertex& vertex){
+                    return (vertex.a - p).SquaredLength() <= kEpsilon;
+                });
+                if (!duplicate) s.vertices[s.count++] = {x - p, p, p};
+                v = Reduce(s);
+                if (s.count == 4) break;
+            }
+
+            t = lambda;
+            return true;
+        }
+    }
+}
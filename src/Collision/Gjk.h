@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+
+#include "Collision/BroadPhase.h"
+#include "Collision/Collider.h"
+#include "Collision/Mathematics.h"
+#include "OrientedBox.h"
+
+namespace Collision{
+    /// @brief
+    /// サポート写像で表す凸形状 (GJK/EPA 用)
+    /// 芯となる点・線分・三角形・箱・凸包を radius だけ膨らませた形状を表す
+    struct SupportShape{
+        enum class Kind{
+            Point,
+            Segment,
+            Triangle,
+            Box,
+            Hull
+        };
+
+        Kind kind = Kind::Point;
+        // Point: 点 / Box, Hull: ローカル座標の原点
+        Vec3 center {};
+        // Box, Hull: ローカル軸 (ワールド空間, 正規直交)
+        std::array<Vec3, 3> axes {Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f)};
+        // Segment, Triangle: 頂点 (ワールド座標) / Box: vertices[0] が各軸方向の半分の大きさ
+        std::array<Vec3, 3> vertices {};
+        const ConvexHull* hull = nullptr;
+        // 芯を膨らませる半径
+        float radius = 0.f;
+
+        static SupportShape Sphere(const Vec3& center, float radius);
+        static SupportShape Segment(const Vec3& a, const Vec3& b, float radius);
+        static SupportShape Triangle(const Vec3& a, const Vec3& b, const Vec3& c);
+        static SupportShape Box(const OrientedBox& box);
+        static SupportShape Hull(const ConvexHull& hull, const Vec3& center, const std::array<Vec3, 3>& axes);
+
+        /// 方向に最も遠い芯の点 (radius を含まない)
+        Vec3 Support(const Vec3& direction) const;
+        /// 芯の内側にある代表点
+        Vec3 Center() const;
+        /// ワールド座標での境界 (radius を含む)
+        Bounds GetBounds() const;
+        /// 平行移動した形状
+        SupportShape Translated(const Vec3& offset) const;
+    };
+
+    namespace Intersection{
+        /**
+         * GJK で芯同士の距離を求めます (radius は含まない)。
+         * @param a 1つ目の形状
+         * @param b 2つ目の形状
+         * @param axis 探索を始める分離軸 (a から b へ向かう向き, ゼロなら中心間の向き)。終了時の分離軸を書き戻す
+         * @param limit この距離より離れていると分かった時点で打ち切る
+         * @param pointA a の芯上の最近点の出力先
+         * @param pointB b の芯上の最近点の出力先
+         * @return 芯同士の距離 (重なっていれば0, 打ち切った場合は limit より大きい下限値)
+         */
+        float GjkDistance(const SupportShape& a, const SupportShape& b, Vec3& axis, float limit, Vec3& pointA, Vec3& pointB);
+
+        /**
+         * GJK で形状同士が重なるか判定します。
+         * 前回の分離軸を axis に渡すと、多くの場合1回のサポート写像の評価で分離を確定できます。
+         * @param a 1つ目の形状
+         * @param b 2つ目の形状
+         * @param axis 探索を始める分離軸 (a から b へ向かう向き)。終了時の分離軸を書き戻す
+         * @return 重なっている場合はtrue
+         */
+        bool GjkOverlap(const SupportShape& a, const SupportShape& b, Vec3& axis);
+
+        /**
+         * 重なっている前提で接触情報を求めます。
+         * 芯が離れていれば GJK の最近点から、芯が重なっていれば EPA で侵入量を求めます。
+         * @param a 1つ目の形状
+         * @param b 2つ目の形状
+         * @param axis 探索を始める分離軸 (a から b へ向かう向き)。終了時の法線を書き戻す
+         * @return 接触情報 (法線は a から b へ向かう向き)
+         */
+        Contact GjkContact(const SupportShape& a, const SupportShape& b, Vec3& axis);
+
+        /**
+         * レイと芯との交点を GJK で求めます (radius は含まない)。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param shape 判定する形状
+         * @param maxDistance レイの長さ
+         * @param t 交点までの距離の出力先 (原点が内側なら0)
+         * @return 交差する場合はtrue
+         */
+        bool RayConvex(const Vec3& origin, const Vec3& direction, const SupportShape& shape, float maxDistance, float& t);
+    }
+}
@@ -0,0 +1,240 @@
+#include "Collision/HeightField.h"
+
+#include <cassert>
+#include <limits>
+#include <utility>
+
+#include "Triangle.h"
+
+namespace Collision{
+    HeightField::HeightField(uint32_t width, uint32_t depth, float cellSize, float heightScale, float heightOffset, std::span<const uint16_t> heights)
+        :width_(width), depth_(depth), cellSize_(cellSize), heightScale_(heightScale), heightOffset_(heightOffset), heightStorage_(heights.begin(), heights.end()) {
+        heights_ = heightStorage_;
+        ComputeBounds();
+    }
+
+    HeightField::HeightField(uint32_t width, uint32_t depth, float cellSize, float heightScale, float heightOffset, std::span<const uint16_t> heights, std::shared_ptr<const void> external)
+        :width_(width), depth_(depth), cellSize_(cellSize), heightScale_(heightScale), heightOffset_(heightOffset), external_(std::move(external)), heights_(heights) {
+        ComputeBounds();
+    }
+
+    void HeightField::ComputeBounds() {
+        assert(2 <= width_ && 2 <= depth_);
+        assert(heights_.size() == static_cast<size_t>(width_) * depth_);
+
+        const auto [low, high] = std::minmax_element(heights_.begin(), heights_.end());
+        bounds_ = {
+            {0.f, heightOffset_ + *low * heightScale_, 0.f},
+            {(width_ - 1) * cellSize_, heightOffset_ + *high * heightScale_, (depth_ - 1) * cellSize_}
+        };
+        // 負の倍率では上下が入れ替わる
+        if (bounds_.max.y < bounds_.min.y) std::swap(bounds_.min.y, bounds_.max.y);
+    }
+
+    const Bounds& HeightField::GetBounds() const {
+        return bounds_;
+    }
+
+    uint32_t HeightField::GetWidth() const {
+        return width_;
+    }
+
+    uint32_t HeightField::GetDepth() const {
+        return depth_;
+    }
+
+    float HeightField::GetCellSize() const {
+        return cellSize_;
+    }
+
+    float HeightField::GetHeightScale() const {
+        return heightScale_;
+    }
+
+    float HeightField::GetHeightOffset() const {
+        return heightOffset_;
+    }
+
+    std::span<const uint16_t> HeightField::GetHeights() const {
+        return heights_;
+    }
+
+    bool HeightField::GetHeight(float x, float z, float& height) const {
+        if (x < 0.f || bounds_.max.x < x || z < 0.f || bounds_.max.z < z) return false;
+
+        const float gx = x / cellSize_;
+        const float gz = z / cellSize_;
+        const uint32_t ix = std::min(static_cast<uint32_t>(gx), width_ - 2);
+        const uint32_t iz = std::min(static_cast<uint32_t>(gz), depth_ - 2);
+        const float fx = gx - ix;
+        const float fz = gz - iz;
+
+        const float h00 = Sample(ix, iz);
+        const float h10 = Sample(ix + 1, iz);
+        const float h01 = Sample(ix, iz + 1);
+        const float h11 = Sample(ix + 1, iz + 1);
+        // 対角線のどちら側の三角形か
+        height = fx <= fz ?
+            h00 + (h11 - h01) * fx + (h01 - h00) * fz :
+            h00 + (h10 - h00) * fx + (h11 - h10) * fz;
+        return true;
+    }
+
+    bool HeightField::IsBelow(const Vec3& point) const {
+        float height = 0.f;
+        return GetHeight(point.x, point.z, height) && point.y < height;
+    }
+
+    bool HeightField::RayCast(const Vec3& origin, const Vec3& direction, float maxDistance, float& t) const {
+        // 格子全体の境界で区間を切り詰める
+        float enter = 0.f;
+        float exit = maxDistance;
+        const float o[3] = {origin.x, origin.y, origin.z};
+        const float d[3] = {direction.x, direction.y, direction.z};
+        const float lo[3] = {bounds_.min.x, bounds_.min.y, bounds_.min.z};
+        const float hi[3] = {bounds_.max.x, bounds_.max.y, bounds_.max.z};
+        for (int axis = 0; axis < 3; ++axis){
+            if (d[axis] == 0.f){
+                if (o[axis] < lo[axis] || hi[axis] < o[axis]) return false;
+                continue;
+            }
+            float t1 = (lo[axis] - o[axis]) / d[axis];
+            float t2 = (hi[axis] - o[axis]) / d[axis];
+            if (t1 > t2) std::swap(t1, t2);
+            enter = std::max(enter, t1);
+            exit = std::min(exit, t2);
+            if (exit < enter) return false;
+        }
+
+        const Vec3 start = origin + direction * enter;
+        int x = static_cast<int>(std::min(static_cast<uint32_t>(std::max(start.x / cellSize_, 0.f)), width_ - 2));
+        int z = static_cast<int>(std::min(static_cast<uint32_t>(std::max(start.z / cellSize_, 0.f)), depth_ - 2));
+
+        constexpr float kInfinity = std::numeric_limits<float>::infinity();
+        const int stepX = direction.x < 0.f ? -1 : 1;
+        const int stepZ = direction.z < 0.f ? -1 : 1;
+        const float deltaX = direction.x != 0.f ? cellSize_ / std::abs(direction.x) : kInfinity;
+        const float deltaZ = direction.z != 0.f ? cellSize_ / std::abs(direction.z) : kInfinity;
+        float nextX = direction.x != 0.f ? ((x + (stepX > 0 ? 1 : 0)) * cellSize_ - origin.x) / direction.x : kInfinity;
+        float nextZ = direction.z != 0.f ? ((z + (stepZ > 0 ? 1 : 0)) * cellSize_ - origin.z) / direction.z : kInfinity;
+
+        float current = enter;
+        while (true){
+            const float cellExit = std::min({nextX, nextZ, exit});
+
+            // セル内でのレイの高さがセルの高さの範囲と重なる場合のみ三角形を判定する
+            const float y0 = origin.y + direction.y * current;
+            const float y1 = origin.y + direction.y * cellExit;
+            const float h00 = Sample(x, z);
+            const float h10 = Sample(x + 1, z);
+            const float h01 = Sample(x, z + 1);
+            const float h11 = Sample(x + 1, z + 1);
+            if (std::min(y0, y1) <= std::max({h00, h10, h01, h11}) && std::min({h00, h10, h01, h11}) <= std::max(y0, y1)){
+                float best = kInfinity;
+                ForEachCellTriangle(x, z, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+                    float hit = 0.f;
+                    if (Intersection::RayTriangle(origin, direction, a, b, c, hit) && 0.f <= hit && hit <= maxDistance){
+                        best = std::min(best, hit);
+                    }
+                    return true;
+                });
+                // 手前のセルから順に辿るので最初に当たった三角形が最も近い
+                if (best != kInfinity){
+                    t = best;
+                    return true;
+                }
+            }
+
+            if (exit <= cellExit) break;
+            if (nextX < nextZ){
+                x += stepX;
+                if (x < 0 || static_cast<int>(width_) - 2 < x) break;
+                current = nextX;
+                nextX += deltaX;
+            } else{
+                z += stepZ;
+                if (z < 0 || static_cast<int>(depth_) - 2 < z) break;
+                current = nextZ;
+                nextZ += deltaZ;
+            }
+        }
+        return false;
+    }
+
+    bool HeightField::OverlapSphere(const Vec3& center, float radius) const {
+        if (IsBelow(center)) return true;
+
+        const Vec3 extent {radius, radius, radius};
+        bool found = false;
+        Query({center - extent, center + extent}, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+            found = (Intersection::ClosestPointOnTriangle(center, a, b, c) - center).SquaredLength() <= radius * radius;
+            return !found;
+        });
+        return found;
+    }
+
+    bool HeightField::OverlapAABB(const Vec3& min, const Vec3& max) const {
+        const Vec3 center = (min + max) * 0.5f;
+        if (IsBelow(center)) return true;
+
+        const Vec3 half = (max - min) * 0.5f;
+        bool found = false;
+        Query({min, max}, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+            found = Intersection::TriangleBox(a - center, b - center, c - center, half);
+            return !found;
+        });
+        return found;
+    }
+
+    float HeightField::ClosestPoint(const Vec3& point, float maxDistance, Vec3& closest) const {
+        if (IsBelow(point)){
+            closest = point;
+            return 0.f;
+        }
+
+        // 格子上の最寄りの地点までの距離で探索範囲を絞る
+        const float x = std::clamp(point.x, 0.f, bounds_.max.x);
+        const float z = std::clamp(point.z, 0.f, bounds_.max.z);
+        float height = 0.f;
+        GetHeight(x, z, height);
+        // 丸め誤差でその点自体を取りこぼさないよう少し広げる
+        const float radius = std::min(maxDistance, (Vec3 {x, height, z} - point).Length() * 1.001f + 1e-4f);
+
+        const Vec3 extent {radius, radius, radius};
+        float best = radius * radius;
+        bool found = false;
+        Query({point - extent, point + extent}, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+            const Vec3 candidate = Intersection::ClosestPointOnTriangle(point, a, b, c);
+            const float distance = (candidate - point).SquaredLength();
+            if (distance <= best){
+                best = distance;
+                closest = candidate;
+                found = true;
+            }
+            return true;
+        });
+        return found ? std::sqrt(best) : -1.f;
+    }
+
+    float HeightField::Sample(uint32_t x, uint32_t z) const {
+        return heightOffset_ + heights_[static_cast<size_t>(z) * width_ + x] * heightScale_;
+    }
+
+    Vec3 HeightField::Vertex(uint32_t x, uint32_t z) const {
+        return {x * cellSize_, Sample(x, z), z * cellSize_};
+    }
+
+    bool HeightField::CellRange(const Bounds& bounds, uint32_t& x0, uint32_t& z0, uint32_t& x1, uint32_t& z1) const {
+        if (bounds.max.x < 0.f || bounds_.max.x < bounds.min.x) return false;
+        if (bounds.max.z < 0.f || bounds_.max.z < bounds.min.z) return false;
+
+        auto cell = [this](float value, uint32_t count){
+            return std::min(static_cast<uint32_t>(std::max(value / cellSize_, 0.f)), count - 2);
+        };
+        x0 = cell(bounds.min.x, width_);
+        x1 = cell(bounds.max.x, width_);
+        z0 = cell(bounds.min.z, depth_);
+        z1 = cell(bounds.max.z, depth_);
+        return true;
+    }
+}
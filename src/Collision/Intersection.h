@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+#include "Collision/Collider.h"
+#include "Collision/Mathematics.h"
+
+/// @brief
+/// 形状同士の交差判定 (コライダーに依存しないプリミティブ版)
+/// Manager::Detect と領域クエリで共有する
+namespace Collision::Intersection{
+    inline bool SphereSphere(const Vec3& c1, float r1, const Vec3& c2, float r2) {
+        return (c1 - c2).Length() <= r1 + r2;
+    }
+
+    inline bool AABBAABB(const Vec3& min1, const Vec3& max1, const Vec3& min2, const Vec3& max2) {
+        return (min1.x <= max2.x && max1.x >= min2.x) &&
+            (min1.y <= max2.y && max1.y >= min2.y) &&
+            (min1.z <= max2.z && max1.z >= min2.z);
+    }
+
+    inline bool SphereAABB(const Vec3& center, float radius, const Vec3& min, const Vec3& max) {
+        // 半径だけ広げた箱では角の付近で誤って交差するので、箱上の最近点までの距離で判定する
+        const Vec3 closest {
+            std::clamp(center.x, min.x, max.x),
+            std::clamp(center.y, min.y, max.y),
+            std::clamp(center.z, min.z, max.z)
+        };
+        return (closest - center).SquaredLength() <= radius * radius;
+    }
+
+    inline bool PointSphere(const Vec3& point, const Vec3& center, float radius) {
+        return (point - center).SquaredLength() <= radius * radius;
+    }
+
+    inline bool PointAABB(const Vec3& point, const Vec3& min, const Vec3& max) {
+        return (min.x <= point.x && point.x <= max.x) &&
+            (min.y <= point.y && point.y <= max.y) &&
+            (min.z <= point.z && point.z <= max.z);
+    }
+
+    // 以下は衝突している前提で接触情報を求める (法線は1つ目から2つ目へ向かう向き)
+
+    inline Contact SphereSphereContact(const Vec3& c1, float r1, const Vec3& c2, float r2) {
+        const Vec3 delta = c2 - c1;
+        const float distance = delta.Length();
+        const Vec3 normal = distance > 0.0001f ? delta / distance : Vec3::Up;
+        const float depth = r1 + r2 - distance;
+        return {normal, depth, c1 + normal * (r1 - depth * 0.5f)};
+    }
+
+    inline Contact AABBAABBContact(const Vec3& min1, const Vec3& max1, const Vec3& min2, const Vec3& max2) {
+        const Vec3 overlapMin {std::max(min1.x, min2.x), std::max(min1.y, min2.y), std::max(min1.z, min2.z)};
+        const Vec3 overlapMax {std::min(max1.x, max2.x), std::min(max1.y, max2.y), std::min(max1.z, max2.z)};
+        const Vec3 overlap = overlapMax - overlapMin;
+        const Vec3 delta = (min2 + max2) * 0.5f - (min1 + max1) * 0.5f;
+
+        // 重なりが最小の軸を分離方向とする
+        Contact contact {};
+        if (overlap.x <= overlap.y && overlap.x <= overlap.z){
+            contact.normal = {delta.x < 0.f ? -1.f : 1.f, 0.f, 0.f};
+            contact.depth = overlap.x;
+        } else if (overlap.y <= overlap.z){
+            contact.normal = {0.f, delta.y < 0.f ? -1.f : 1.f, 0.f};
+            contact.depth = overlap.y;
+        } else{
+            contact.normal = {0.f, 0.f, delta.z < 0.f ? -1.f : 1.f};
+            contact.depth = overlap.z;
+        }
+        contact.point = (overlapMin + overlapMax) * 0.5f;
+        return contact;
+    }
+
+    /// 法線は球からAABBへ向かう向き
+    inline Contact SphereAABBContact(const Vec3& center, float radius, const Vec3& min, const Vec3& max) {
+        const Vec3 closest {
+            std::clamp(center.x, min.x, max.x),
+            std::clamp(center.y, min.y, max.y),
+            std::clamp(center.z, min.z, max.z)
+        };
+        const Vec3 delta = closest - center;
+        const float distance = delta.Length();
+
+        if (distance > 0.0001f){
+            return {delta / distance, std::max(0.f, radius - distance), closest};
+        }
+
+        // 中心がAABB内部にある場合は最も近い面から押し出す
+        const float faces[6] = {
+            center.x - min.x, max.x - center.x,
+            center.y - min.y, max.y - center.y,
+            center.z - min.z, max.z - center.z
+        };
+        const Vec3 normals[6] = {Vec3::Right, Vec3::Left, Vec3::Up, Vec3::Down, Vec3::Forward, Vec3::Backward};
+
+        int face = 0;
+        for (int i = 1; i < 6; ++i){
+            if (faces[i] < faces[face]) face = i;
+        }
+        return {normals[face], radius + faces[face], center};
+    }
+}
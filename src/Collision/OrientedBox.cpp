@@ -0,0 +1,318 @@
+#include "OrientedBox.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <variant>
+
+#include "BoundsTree.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define COLLISION_OBB_SSE
+#endif
+
+namespace Collision{
+    namespace{
+        constexpr float kEpsilon = 1e-6f;
+
+        // 分離軸判定の準備 (R[i][j] = a_i・b_j, t は A の座標系での中心間ベクトル)
+        struct SatBasis{
+            float r[3][3];
+            float absR[3][3];
+            float t[3];
+            float ah[3];
+            float bh[3];
+
+            SatBasis(const OrientedBox& a, const OrientedBox& b) {
+                for (int i = 0; i < 3; ++i){
+                    for (int j = 0; j < 3; ++j){
+                        r[i][j] = a.axes[i].Dot(b.axes[j]);
+                        // 平行な辺の外積がゼロベクトルになる場合に備えて微小値を足す
+                        absR[i][j] = std::abs(r[i][j]) + kEpsilon;
+                    }
+                }
+                const Vec3 delta = b.center - a.center;
+                for (int i = 0; i < 3; ++i){
+                    t[i] = delta.Dot(a.axes[i]);
+                    ah[i] = Component(a.half, i);
+                    bh[i] = Component(b.half, i);
+                }
+            }
+        };
+
+#ifdef COLLISION_OBB_SSE
+        __m128 Load(const float (&v)[3]) {
+            return _mm_set_ps(0.f, v[2], v[1], v[0]);
+        }
+
+        // [j] = v[(j + 1) % 3]
+        __m128 RotateLeft(__m128 v) {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+
+        // [j] = v[(j + 2) % 3]
+        __m128 RotateRight(__m128 v) {
+            return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2));
+        }
+
+        // 下位3レーンのいずれかで |d| > limit なら分離している
+        bool Separated(__m128 d, __m128 limit) {
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            return (_mm_movemask_ps(_mm_cmpgt_ps(_mm_and_ps(d, absMask), limit)) & 0x7) != 0;
+        }
+
+        bool OverlapSimd(const SatBasis& s) {
+            const __m128 r[3] = {Load(s.r[0]), Load(s.r[1]), Load(s.r[2])};
+            const __m128 absR[3] = {Load(s.absR[0]), Load(s.absR[1]), Load(s.absR[2])};
+            const __m128 t = Load(s.t);
+            const __m128 ah = Load(s.ah);
+            const __m128 bh = Load(s.bh);
+
+            // A の面法線 (レーン i)
+            {
+                __m128 c0 = absR[0], c1 = absR[1], c2 = absR[2], c3 = _mm_setzero_ps();
+                _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+                const __m128 rb = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(s.bh[0])),
+                                                        _mm_mul_ps(c1, _mm_set1_ps(s.bh[1]))),
+                                             _mm_mul_ps(c2, _mm_set1_ps(s.bh[2])));
+                if (Separated(t, _mm_add_ps(ah, rb))) return false;
+            }
+
+            // B の面法線 (レーン j)
+            {
+                const __m128 ra = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absR[0], _mm_set1_ps(s.ah[0])),
+                                                        _mm_mul_ps(absR[1], _mm_set1_ps(s.ah[1]))),
+                                             _mm_mul_ps(absR[2], _mm_set1_ps(s.ah[2])));
+                const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], _mm_set1_ps(s.t[0])),
+                                                       _mm_mul_ps(r[1], _mm_set1_ps(s.t[1]))),
+                                            _mm_mul_ps(r[2], _mm_set1_ps(s.t[2])));
+                if (Separated(d, _mm_add_ps(ra, bh))) return false;
+            }
+
+            // 辺同士の外積 A_i x B_j (i 毎にレーン j の3軸をまとめて判定)
+            const __m128 bhL = RotateLeft(bh);
+            const __m128 bhR = RotateRight(bh);
+            for (int i = 0; i < 3; ++i){
+                const int i1 = (i + 1) % 3;
+                const int i2 = (i + 2) % 3;
+
+                const __m128 ra = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s.ah[i1]), absR[i2]),
+                                             _mm_mul_ps(_mm_set1_ps(s.ah[i2]), absR[i1]));
+                const __m128 rb = _mm_add_ps(_mm_mul_ps(bhL, RotateRight(absR[i])),
+                                             _mm_mul_ps(bhR, RotateLeft(absR[i])));
+                const __m128 d = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(s.t[i2]), r[i1]),
+                                            _mm_mul_ps(_mm_set1_ps(s.t[i1]), r[i2]));
+                if (Separated(d, _mm_add_ps(ra, rb))) return false;
+            }
+            return true;
+        }
+#endif
+
+        // SSE がない環境の経路 (SSE がある環境でも検証のために常にコンパイルする)
+        bool OverlapScalar(const SatBasis& s) {
+            for (int i = 0; i < 3; ++i){
+                const float rb = s.bh[0] * s.absR[i][0] + s.bh[1] * s.absR[i][1] + s.bh[2] * s.absR[i][2];
+                if (std::abs(s.t[i]) > s.ah[i] + rb) return false;
+            }
+
+            for (int j = 0; j < 3; ++j){
+                const float ra = s.ah[0] * s.absR[0][j] + s.ah[1] * s.absR[1][j] + s.ah[2] * s.absR[2][j];
+                const float d = s.t[0] * s.r[0][j] + s.t[1] * s.r[1][j] + s.t[2] * s.r[2][j];
+                if (std::abs(d) > ra + s.bh[j]) return false;
+            }
+
+            for (int i = 0; i < 3; ++i){
+                const int i1 = (i + 1) % 3;
+                const int i2 = (i + 2) % 3;
+                for (int j = 0; j < 3; ++j){
+                    const int j1 = (j + 1) % 3;
+                    const int j2 = (j + 2) % 3;
+                    const float ra = s.ah[i1] * s.absR[i2][j] + s.ah[i2] * s.absR[i1][j];
+                    const float rb = s.bh[j1] * s.absR[i][j2] + s.bh[j2] * s.absR[i][j1];
+                    const float d = s.t[i2] * s.r[i1][j] - s.t[i1] * s.r[i2][j];
+                    if (std::abs(d) > ra + rb) return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    OrientedBox OrientedBox::FromAABB(const Vec3& center, const Vec3& half) {
+        return {center, {Vec3::Right, Vec3::Up, Vec3::Forward}, half};
+    }
+
+    OrientedBox OrientedBox::Of(const Collider* collider) {
+        const Vec3 half = std::get<Vec3>(collider->GetSize()) * 0.5f;
+        if (collider->GetType() != Type::OBB){
+            return FromAABB(collider->GetTranslate(), half);
+        }
+        return {collider->GetTranslate(), collider->GetAxes(), half};
+    }
+
+    Vec3 OrientedBox::WorldExtent() const {
+        return {
+            std::abs(axes[0].x) * half.x + std::abs(axes[1].x) * half.y + std::abs(axes[2].x) * half.z,
+            std::abs(axes[0].y) * half.x + std::abs(axes[1].y) * half.y + std::abs(axes[2].y) * half.z,
+            std::abs(axes[0].z) * half.x + std::abs(axes[1].z) * half.y + std::abs(axes[2].z) * half.z
+        };
+    }
+
+    Vec3 OrientedBox::ClosestPoint(const Vec3& point) const {
+        const Vec3 delta = point - center;
+        Vec3 result = center;
+        for (int i = 0; i < 3; ++i){
+            const float extent = Component(half, i);
+            result += axes[i] * std::clamp(delta.Dot(axes[i]), -extent, extent);
+        }
+        return result;
+    }
+
+    float OrientedBox::SquaredDistance(const Vec3& point) const {
+        // 最近点をワールド座標に戻すと内部の点でも丸め誤差で0にならないので、軸ごとにはみ出した量で測る
+        const Vec3 delta = point - center;
+        float distance = 0.f;
+        for (int i = 0; i < 3; ++i){
+            const float outside = std::abs(delta.Dot(axes[i])) - Component(half, i);
+            if (0.f < outside) distance += outside * outside;
+        }
+        return distance;
+    }
+
+    namespace Intersection{
+        bool OBBOBB(const OrientedBox& a, const OrientedBox& b) {
+            const SatBasis basis(a, b);
+#ifdef COLLISION_OBB_SSE
+            return OverlapSimd(basis);
+#else
+            return OverlapScalar(basis);
+#endif
+        }
+
+        bool OBBOBBScalar(const OrientedBox& a, const OrientedBox& b) {
+            return OverlapScalar(SatBasis(a, b));
+        }
+
+        bool SphereOBB(const Vec3& center, float radius, const OrientedBox& box) {
+            return box.SquaredDistance(center) <= radius * radius;
+        }
+
+        bool PointOBB(const Vec3& point, const OrientedBox& box) {
+            const Vec3 delta = point - box.center;
+            for (int i = 0; i < 3; ++i){
+                if (std::abs(delta.Dot(box.axes[i])) > Component(box.half, i)) return false;
+            }
+            return true;
+        }
+
+        bool RayOBB(const Vec3& origin, const Vec3& direction, const OrientedBox& box, float& t) {
+            const Vec3 delta = origin - box.center;
+
+            float tmin = -std::numeric_limits<float>::max();
+            float tmax = std::numeric_limits<float>::max();
+            for (int i = 0; i < 3; ++i){
+                const float o = delta.Dot(box.axes[i]);
+                const float d = direction.Dot(box.axes[i]);
+                const float extent = Component(box.half, i);
+
+                // スラブと平行
+                if (std::abs(d) < kEpsilon){
+                    if (std::abs(o) > extent) return false;
+                    continue;
+                }
+
+                float t1 = (-extent - o) / d;
+                float t2 = (extent - o) / d;
+                if (t1 > t2) std::swap(t1, t2);
+                tmin = std::max(tmin, t1);
+                tmax = std::min(tmax, t2);
+            }
+
+            if (tmin > tmax || tmax < 0.0f) return false;
+
+            // 原点が箱の内部なら距離0 (出口ではなく原点で当たる)
+            t = std::max(tmin, 0.f);
+            return true;
+        }
+
+        Contact OBBOBBContact(const OrientedBox& a, const OrientedBox& b) {
+            const SatBasis s(a, b);
+            const Vec3 delta = b.center - a.center;
+
+            // 重なりが最小の分離軸を求める
+            float depth = std::numeric_limits<float>::max();
+            Vec3 normal = Vec3::Up;
+            auto consider = [&](const Vec3& axis, float overlap){
+                if (overlap < depth){
+                    depth = overlap;
+                    normal = axis;
+                }
+            };
+
+            for (int i = 0; i < 3; ++i){
+                const float rb = s.bh[0] * s.absR[i][0] + s.bh[1] * s.absR[i][1] + s.bh[2] * s.absR[i][2];
+                consider(a.axes[i], s.ah[i] + rb - std::abs(s.t[i]));
+            }
+            for (int j = 0; j < 3; ++j){
+                const float ra = s.ah[0] * s.absR[0][j] + s.ah[1] * s.absR[1][j] + s.ah[2] * s.absR[2][j];
+                const float d = s.t[0] * s.r[0][j] + s.t[1] * s.r[1][j] + s.t[2] * s.r[2][j];
+                consider(b.axes[j], ra + s.bh[j] - std::abs(d));
+            }
+            for (int i = 0; i < 3; ++i){
+                const int i1 = (i + 1) % 3;
+                const int i2 = (i + 2) % 3;
+                for (int j = 0; j < 3; ++j){
+                    const Vec3 axis = Vec3::Cross(a.axes[i], b.axes[j]);
+                    const float length = axis.Length();
+                    // 平行な辺からは軸が定まらない
+                    if (length < 0.001f) continue;
+
+                    const int j1 = (j + 1) % 3;
+                    const int j2 = (j + 2) % 3;
+                    const float ra = s.ah[i1] * s.absR[i2][j] + s.ah[i2] * s.absR[i1][j];
+                    const float rb = s.bh[j1] * s.absR[i][j2] + s.bh[j2] * s.absR[i][j1];
+                    const float d = s.t[i2] * s.r[i1][j] - s.t[i1] * s.r[i2][j];
+                    consider(axis / length, (ra + rb - std::abs(d)) / length);
+                }
+            }
+
+            if (normal.Dot(delta) < 0.f) normal *= -1.f;
+
+            // B のうち最も A 側に入り込んだ頂点と A の面の中点を接触点とする
+            Vec3 deepest = b.center;
+            for (int k = 0; k < 3; ++k){
+                const float sign = normal.Dot(b.axes[k]) > 0.f ? 1.f : -1.f;
+                deepest -= b.axes[k] * (Component(b.half, k) * sign);
+            }
+            depth = std::max(depth, 0.f);
+            return {normal, depth, deepest + normal * (depth * 0.5f)};
+        }
+
+        Contact SphereOBBContact(const Vec3& center, float radius, const OrientedBox& box) {
+            const Vec3 closest = box.ClosestPoint(center);
+            const Vec3 delta = closest - center;
+            const float distance = delta.Length();
+
+            if (distance > 0.0001f){
+                return {delta / distance, std::max(0.f, radius - distance), closest};
+            }
+
+            // 中心がOBB内部にある場合は最も近い面から押し出す
+            const Vec3 local = center - box.center;
+            int face = 0;
+            float faceDistance = std::numeric_limits<float>::max();
+            float faceSign = 1.f;
+            for (int i = 0; i < 3; ++i){
+                const float o = local.Dot(box.axes[i]);
+                const float toFace = Component(box.half, i) - std::abs(o);
+                if (toFace < faceDistance){
+                    faceDistance = toFace;
+                    face = i;
+                    faceSign = o < 0.f ? -1.f : 1.f;
+                }
+            }
+            // 球は面の外側へ押し出されるので、球からOBBへの法線は面法線の逆
+            return {box.axes[face] * -faceSign, radius + faceDistance, center};
+        }
+    }
+}
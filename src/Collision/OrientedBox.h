@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+
+#include "Collision/Collider.h"
+#include "Collision/Mathematics.h"
+
+namespace Collision{
+    /// @brief
+    /// 有向境界ボックス (狭域判定用)
+    struct OrientedBox{
+        Vec3 center;
+        // ローカル軸 (ワールド空間, 正規直交)
+        std::array<Vec3, 3> axes;
+        // 各軸方向の半分の大きさ
+        Vec3 half;
+
+        static OrientedBox FromAABB(const Vec3& center, const Vec3& half);
+        /// コライダーのボックスを取得 (Type::OBB 以外は軸平行として扱う, サイズは Vec3 である前提)
+        static OrientedBox Of(const Collider* collider);
+
+        /// ワールド座標系での各軸方向の半径 (外接AABB用)
+        Vec3 WorldExtent() const;
+        /// 点に最も近いボックス上の点
+        Vec3 ClosestPoint(const Vec3& point) const;
+        /// 点からボックスまでの距離の2乗 (内部なら0)
+        float SquaredDistance(const Vec3& point) const;
+    };
+
+    namespace Intersection{
+        /**
+         * OBB同士を分離軸判定で判定します (15軸, SSE対応環境ではSIMDで評価)。
+         */
+        bool OBBOBB(const OrientedBox& a, const OrientedBox& b);
+        /// OBBOBB の SIMD を使わない経路 (SSE がない環境の OBBOBB と同じ, 両者を比べる検証用)
+        bool OBBOBBScalar(const OrientedBox& a, const OrientedBox& b);
+        bool SphereOBB(const Vec3& center, float radius, const OrientedBox& box);
+        bool PointOBB(const Vec3& point, const OrientedBox& box);
+
+        /**
+         * レイとOBBをスラブ法で判定します。
+         * @param origin レイの原点
+         * @param direction レイの方向 (正規化済み)
+         * @param box 判定するOBB
+         * @param t 交点までの距離の出力先 (原点が内部なら0)
+         * @return 交差する場合はtrue (レイの長さは考慮しない)
+         */
+        bool RayOBB(const Vec3& origin, const Vec3& direction, const OrientedBox& box, float& t);
+
+        // 衝突している前提で接触情報を求める (法線は1つ目から2つ目へ向かう向き)
+        Contact OBBOBBContact(const OrientedBox& a, const OrientedBox& b);
+        /// 法線は球からOBBへ向かう向き
+        Contact SphereOBBContact(const Vec3& center, float radius, const OrientedBox& box);
+    }
+}
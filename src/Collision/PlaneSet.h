@@ -0,0 +1,114 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <span>
+
+#include "Collision/BroadPhase.h"
+#include "Collision/Mathematics.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_PLANESET_SSE
+#endif
+
+namespace Collision{
+    /// @brief
+    /// 凸領域を表す平面の集合 (最大8枚)
+    /// 4枚ずつSoAで保持し、SSEでまとめて判定する
+    class PlaneSet{
+    public:
+        static constexpr size_t kMaxPlanes = 8;
+
+    private:
+        alignas(16) float nx_[kMaxPlanes];
+        alignas(16) float ny_[kMaxPlanes];
+        alignas(16) float nz_[kMaxPlanes];
+        alignas(16) float d_[kMaxPlanes];
+        size_t groups_ = 0;
+
+    public:
+        explicit PlaneSet(std::span<const Plane> planes) {
+            assert(planes.size() <= kMaxPlanes);
+            const size_t count = std::min(planes.size(), kMaxPlanes);
+
+            // 余りは常に内側となる平面で埋める
+            for (size_t i = 0; i < kMaxPlanes; ++i){
+                const bool used = i < count;
+                nx_[i] = used ? planes[i].normal.x : 0.f;
+                ny_[i] = used ? planes[i].normal.y : 0.f;
+                nz_[i] = used ? planes[i].normal.z : 0.f;
+                d_[i] = used ? planes[i].distance : 1e30f;
+            }
+            groups_ = (count + 3) / 4;
+        }
+
+        /**
+         * 中心と各軸の半径で表される箱の包含関係を判定します。
+         * @param center 中心
+         * @param extent 各軸の半径
+         */
+        Containment Classify(const Vec3& center, const Vec3& extent) const {
+            return Classify(center, extent, -1.f);
+        }
+
+        /**
+         * 球の包含関係を判定します (平面の法線は正規化されている前提)。
+         * @param center 中心
+         * @param radius 半径
+         */
+        Containment Classify(const Vec3& center, float radius) const {
+            return Classify(center, {}, radius);
+        }
+
+        Containment Classify(const Bounds& bounds) const {
+            return Classify(bounds.Center(), (bounds.max - bounds.min) * 0.5f);
+        }
+
+    private:
+        // sphereRadius が負なら箱として判定する
+        Containment Classify(const Vec3& center, const Vec3& extent, float sphereRadius) const {
+            bool inside = true;
+
+#ifdef COLLISION_PLANESET_SSE
+            const __m128 cx = _mm_set1_ps(center.x);
+            const __m128 cy = _mm_set1_ps(center.y);
+            const __m128 cz = _mm_set1_ps(center.z);
+            const __m128 ex = _mm_set1_ps(extent.x);
+            const __m128 ey = _mm_set1_ps(extent.y);
+            const __m128 ez = _mm_set1_ps(extent.z);
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+            for (size_t g = 0; g < groups_; ++g){
+                const __m128 nx = _mm_load_ps(nx_ + g * 4);
+                const __m128 ny = _mm_load_ps(ny_ + g * 4);
+                const __m128 nz = _mm_load_ps(nz_ + g * 4);
+                const __m128 d = _mm_load_ps(d_ + g * 4);
+
+                const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                               _mm_add_ps(_mm_mul_ps(nz, cz), d));
+                const __m128 radius = 0.f <= sphereRadius ? _mm_set1_ps(sphereRadius) :
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex),
+                                          _mm_mul_ps(_mm_and_ps(ny, absMask), ey)),
+                               _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+
+                if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()))){
+                    return Containment::Outside;
+                }
+                if (_mm_movemask_ps(_mm_cmpge_ps(dist, radius)) != 0xF){
+                    inside = false;
+                }
+            }
+#else
+            for (size_t i = 0; i < groups_ * 4; ++i){
+                const float dist = nx_[i] * center.x + ny_[i] * center.y + nz_[i] * center.z + d_[i];
+                const float radius = 0.f <= sphereRadius ? sphereRadius :
+                    std::abs(nx_[i]) * extent.x + std::abs(ny_[i]) * extent.y + std::abs(nz_[i]) * extent.z;
+                if (dist + radius < 0.f) return Containment::Outside;
+                if (dist < radius) inside = false;
+            }
+#endif
+
+            return inside ? Containment::Inside : Containment::Intersect;
+        }
+    };
+}
@@ -0,0 +1,412 @@
+#include "Collision/Snapshot.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Collision/CollisionManager.h"
+#include "Collision/CompoundShape.h"
+#include "Collision/ConvexHull.h"
+#include "Collision/HeightField.h"
+#include "Collision/TriangleMesh.h"
+
+namespace Collision{
+    namespace{
+        // Collider::Size の variant の番号
+        enum SizeIndex : uint8_t{
+            kSphereSize,
+            kBoxSize,
+            kCapsuleSize,
+            kMeshSize,
+            kHeightFieldSize,
+            kCompoundSize,
+            kHullSize
+        };
+        static_assert(std::is_same_v<std::variant_alternative_t<kMeshSize, Collider::Size>, std::shared_ptr<const TriangleMesh>>);
+        static_assert(std::is_same_v<std::variant_alternative_t<kHullSize, Collider::Size>, std::shared_ptr<const ConvexHull>>);
+
+        // マップしたメモリをそのまま配列として読むため
+        static_assert(sizeof(Vec3) == sizeof(float) * 3 && std::is_trivially_copyable_v<Vec3>);
+        static_assert(std::is_trivially_copyable_v<TriangleMesh::Node> && std::is_trivially_copyable_v<Snapshot::ShapeRecord>);
+
+        // 各配列の先頭をそろえる境界
+        constexpr uint64_t kAlignment = 16;
+
+        uint64_t AlignUp(uint64_t value) {
+            return (value + kAlignment - 1) & ~(kAlignment - 1);
+        }
+
+        /**
+         * ファイルを読み取り専用でマップします。
+         * @param path ファイル
+         * @param size ファイルの大きさの出力先
+         * @return マップした先頭 (解放するとマップを解除する, 失敗したら nullptr)
+         */
+        std::shared_ptr<const std::byte> MapFile(const std::string& path, size_t& size) {
+#ifdef _WIN32
+            const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return nullptr;
+            LARGE_INTEGER length {};
+            if (!GetFileSizeEx(file, &length) || length.QuadPart == 0){
+                CloseHandle(file);
+                return nullptr;
+            }
+            const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (!mapping) return nullptr;
+            // ビューが残っている間はマッピングも残る
+            const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (!view) return nullptr;
+            size = static_cast<size_t>(length.QuadPart);
+            return {static_cast<const std::byte*>(view), [](const std::byte* p){ UnmapViewOfFile(p); }};
+#else
+            const int file = open(path.c_str(), O_RDONLY);
+            if (file < 0) return nullptr;
+            struct stat status {};
+            if (fstat(file, &status) != 0 || status.st_size <= 0){
+                close(file);
+                return nullptr;
+            }
+            const size_t length = static_cast<size_t>(status.st_size);
+            void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            close(file);
+            if (view == MAP_FAILED) return nullptr;
+            size = length;
+            return {static_cast<const std::byte*>(view), [length](const std::byte* p){ munmap(const_cast<std::byte*>(p), length); }};
+#endif
+        }
+
+        // 共有形状の実体 (float, Vec3, CapsuleSize なら nullptr)
+        const void* SharedShapeOf(const Collider::Size& size) {
+            return std::visit([](const auto& value) -> const void*{
+                if constexpr (requires { value.get(); }) return value.get();
+                else return nullptr;
+            }, size);
+        }
+
+        Snapshot::UpdateRecord StateOf(const Collider* collider, uint32_t index) {
+            return {index, collider->IsEnabled() ? Snapshot::kEnable : 0u, collider->GetTranslate(), collider->GetRotate()};
+        }
+
+        // 書き出す配列 (ファイル上の位置は Write で決める)
+        struct Blob{
+            const void* data;
+            size_t bytes;
+            // 位置を書き込む先
+            uint64_t* offset;
+        };
+    }
+
+    bool Snapshot::Open(const std::string& path) {
+        Close();
+
+        size_t size = 0;
+        std::shared_ptr<const std::byte> mapping = MapFile(path, size);
+        if (!mapping || size < sizeof(Header)) return false;
+
+        const auto* header = reinterpret_cast<const Header*>(mapping.get());
+        if (header->magic != kMagic || header->version != kVersion || header->fileSize != size) return false;
+
+        mapping_ = std::move(mapping);
+        size_ = size;
+        header_ = header;
+        if (!Section<ColliderRecord>(header_->collidersOffset, header_->colliderCount) ||
+            !Section<ShapeRecord>(header_->shapesOffset, header_->shapeCount) ||
+            !Section<FrameRecord>(header_->framesOffset, header_->frameCount) ||
+            !Section<UpdateRecord>(header_->updatesOffset, header_->updateCount) ||
+            !LoadShapes() || !ValidateColliders()){
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Snapshot::Close() {
+        shapes_.clear();
+        header_ = nullptr;
+        size_ = 0;
+        mapping_.reset();
+    }
+
+    bool Snapshot::IsOpen() const {
+        return header_ != nullptr;
+    }
+
+    size_t Snapshot::GetColliderCount() const {
+        return header_ ? header_->colliderCount : 0;
+    }
+
+    size_t Snapshot::GetFrameCount() const {
+        return header_ ? header_->frameCount : 0;
+    }
+
+    std::span<const Snapshot::ColliderRecord> Snapshot::GetColliders() const {
+        if (!header_) return {};
+        return {Section<ColliderRecord>(header_->collidersOffset, header_->colliderCount), header_->colliderCount};
+    }
+
+    std::span<const Snapshot::UpdateRecord> Snapshot::GetFrame(size_t frame) const {
+        if (frame >= GetFrameCount()) return {};
+        const FrameRecord& record = Section<FrameRecord>(header_->framesOffset, header_->frameCount)[frame];
+        if (header_->updateCount < record.first || header_->updateCount - record.first < record.count) return {};
+        return {Section<UpdateRecord>(header_->updatesOffset, header_->updateCount) + record.first, record.count};
+    }
+
+    void Snapshot::Load(Manager& manager, std::span<Collider*> out) const {
+        const std::span<const ColliderRecord> records = GetColliders();
+        assert(out.size() == records.size());
+        const size_t count = std::min(out.size(), records.size());
+
+        manager.CreateColliders(out.first(count));
+        for (size_t i = 0; i < count; ++i){
+            const ColliderRecord& record = records[i];
+            Collider* collider = out[i];
+            collider->SetType(static_cast<Type>(record.type))->SetTranslate(record.translate);
+            // 回転なしなら三角関数を省く
+            if (record.rotate != Vec3 {}) collider->SetRotate(record.rotate);
+
+            switch (record.sizeIndex){
+            case kSphereSize:
+                collider->SetSize(record.size[0]);
+                break;
+            case kBoxSize:
+                collider->SetSize(Vec3 {record.size[0], record.size[1], record.size[2]});
+                break;
+            case kCapsuleSize:
+                collider->SetSize(CapsuleSize {record.size[0], record.size[1]});
+                break;
+            default:
+                if (record.shape < shapes_.size()) collider->SetSize(shapes_[record.shape]);
+                break;
+            }
+
+            if (record.attribute) collider->AddAttribute(record.attribute);
+            if (record.ignore) collider->AddIgnore(record.ignore);
+            if (record.enabled) collider->Enable();
+        }
+    }
+
+    void Snapshot::ApplyFrame(Manager& manager, size_t frame, std::span<Collider* const> colliders) {
+        moved_.clear();
+        translates_.clear();
+        for (const UpdateRecord& update : GetFrame(frame)){
+            if (update.collider >= colliders.size()) continue;
+            Collider* collider = colliders[update.collider];
+            // 境界は UpdateTransforms で求め直すので回転を先に反映する
+            if (update.flags & kRotate) collider->SetRotate(update.rotate);
+            if (update.flags & kEnable) collider->Enable();
+            else collider->Disable();
+            moved_.push_back(collider);
+            translates_.push_back(update.translate);
+        }
+        manager.UpdateTransforms(moved_, translates_);
+    }
+
+    template <typename T>
+    const T* Snapshot::Section(uint64_t offset, uint64_t count) const {
+        if (offset % alignof(T) != 0 || size_ < offset || (size_ - offset) / sizeof(T) < count) return nullptr;
+        return reinterpret_cast<const T*>(mapping_.get() + offset);
+    }
+
+    bool Snapshot::LoadShapes() {
+        const ShapeRecord* records = Section<ShapeRecord>(header_->shapesOffset, header_->shapeCount);
+        shapes_.reserve(header_->shapeCount);
+        for (uint32_t i = 0; i < header_->shapeCount; ++i){
+            const ShapeRecord& record = records[i];
+            switch (record.sizeIndex){
+            case kMeshSize:{
+                const auto* vertices = Section<Vec3>(record.offsets[0], record.counts[0]);
+                const auto* triangles = Section<std::array<uint32_t, 3>>(record.offsets[1], record.counts[1]);
+                const auto* nodes = Section<TriangleMesh::Node>(record.offsets[2], record.counts[2]);
+                if (!vertices || !triangles || !nodes) return false;
+                const TriangleMesh::Prebuilt prebuilt {{vertices, record.counts[0]}, {triangles, record.counts[1]}, {nodes, record.counts[2]}, record.bounds};
+                // 壊れたファイルでメッシュの判定が範囲外を読まないよう、参照する前に一度だけ確かめる
+                if (!TriangleMesh::IsValid(prebuilt)) return false;
+                shapes_.emplace_back(std::make_shared<const TriangleMesh>(prebuilt, mapping_));
+                break;
+            }
+            case kHeightFieldSize:{
+                const uint64_t samples = static_cast<uint64_t>(record.counts[0]) * record.counts[1];
+                const auto* heights = Section<uint16_t>(record.offsets[0], samples);
+                if (!heights || record.counts[0] < 2 || record.counts[1] < 2) return false;
+                shapes_.emplace_back(std::make_shared<const HeightField>(record.counts[0], record.counts[1], record.parameters[0], record.parameters[1], record.parameters[2],
+                                                                         std::span<const uint16_t> {heights, static_cast<size_t>(samples)}, mapping_));
+                break;
+            }
+            case kCompoundSize:{
+                // 子の BVH は小さいので組み立て直す
+                const auto* records = Section<ChildRecord>(record.offsets[0], record.counts[0]);
+                if (!records) return false;
+                std::vector<CompoundShape::Child> children(record.counts[0]);
+                for (uint32_t c = 0; c < record.counts[0]; ++c){
+                    const ChildRecord& child = records[c];
+                    children[c].offset = child.offset;
+                    if (child.kind == 0) children[c].size = child.size[0];
+                    else children[c].size = Vec3 {child.size[0], child.size[1], child.size[2]};
+                }
+                shapes_.emplace_back(std::make_shared<const CompoundShape>(children));
+                break;
+            }
+            case kHullSize:{
+                const auto* vertices = Section<Vec3>(record.offsets[0], record.counts[0]);
+                if (!vertices || record.counts[0] == 0) return false;
+                shapes_.emplace_back(std::make_shared<const ConvexHull>(std::span<const Vec3> {vertices, record.counts[0]}));
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Snapshot::ValidateColliders() const {
+        for (const ColliderRecord& record : GetColliders()){
+            // 狭域判定の表を種類で引くため (Type::None は判定から外れるので許す)
+            const auto type = static_cast<Type>(record.type);
+            if (static_cast<uint8_t>(Type::None) < record.type || type == Type::Ray || kHullSize < record.sizeIndex) return false;
+            if (record.sizeIndex < kMeshSize) continue;
+            if (shapes_.size() <= record.shape || shapes_[record.shape].index() != record.sizeIndex) return false;
+        }
+        return true;
+    }
+
+    SnapshotWriter::SnapshotWriter(std::span<Collider* const> colliders) :colliders_(colliders.begin(), colliders.end()) {
+        records_.resize(colliders_.size());
+        last_.resize(colliders_.size());
+        // 形状の実体から表の番号を引く
+        std::unordered_map<const void*, uint32_t> shapeIndices;
+        for (uint32_t i = 0; i < colliders_.size(); ++i){
+            const Collider* collider = colliders_[i];
+            const Collider::Size& size = collider->GetSize();
+            Snapshot::ColliderRecord& record = records_[i];
+            record = {collider->GetTranslate(), collider->GetRotate(), {}, Snapshot::kNoShape, collider->GetAttribute(), collider->GetIgnore(),
+                      static_cast<uint8_t>(collider->GetType()), static_cast<uint8_t>(size.index()), static_cast<uint8_t>(collider->IsEnabled()), 0};
+            last_[i] = StateOf(collider, i);
+
+            if (const auto* radius = std::get_if<float>(&size)){
+                record.size[0] = *radius;
+            } else if (const auto* box = std::get_if<Vec3>(&size)){
+                record.size[0] = box->x;
+                record.size[1] = box->y;
+                record.size[2] = box->z;
+            } else if (const auto* capsule = std::get_if<CapsuleSize>(&size)){
+                record.size[0] = capsule->radius;
+                record.size[1] = capsule->height;
+            } else{
+                // 同じ形状を共有するコライダーは同じ番号を指す
+                const auto [itr, inserted] = shapeIndices.try_emplace(SharedShapeOf(size), static_cast<uint32_t>(shapes_.size()));
+                if (inserted) shapes_.push_back(size);
+                record.shape = itr->second;
+            }
+        }
+    }
+
+    void SnapshotWriter::RecordFrame() {
+        const uint32_t first = static_cast<uint32_t>(updates_.size());
+        for (uint32_t i = 0; i < colliders_.size(); ++i){
+            Snapshot::UpdateRecord state = StateOf(colliders_[i], i);
+            Snapshot::UpdateRecord& last = last_[i];
+            if (state.translate == last.translate && state.rotate == last.rotate && state.flags == last.flags) continue;
+            if (state.rotate != last.rotate) state.flags |= Snapshot::kRotate;
+            updates_.push_back(state);
+            last = state;
+            last.flags &= ~Snapshot::kRotate;
+        }
+        frames_.push_back({first, static_cast<uint32_t>(updates_.size()) - first});
+    }
+
+    bool SnapshotWriter::Write(const std::string& path) const {
+        Snapshot::Header header {};
+        header.magic = Snapshot::kMagic;
+        header.version = Snapshot::kVersion;
+        header.colliderCount = static_cast<uint32_t>(records_.size());
+        header.shapeCount = static_cast<uint32_t>(shapes_.size());
+        header.frameCount = static_cast<uint32_t>(frames_.size());
+        header.updateCount = static_cast<uint32_t>(updates_.size());
+
+        std::vector<Snapshot::ShapeRecord> shapes(shapes_.size());
+        // 複合形状の子は書き出しまで残しておく
+        std::vector<std::vector<Snapshot::ChildRecord>> children;
+        children.reserve(shapes_.size());
+
+        std::vector<Blob> blobs {
+            {records_.data(), records_.size() * sizeof(Snapshot::ColliderRecord), &header.collidersOffset},
+            {shapes.data(), shapes.size() * sizeof(Snapshot::ShapeRecord), &header.shapesOffset},
+            {frames_.data(), frames_.size() * sizeof(Snapshot::FrameRecord), &header.framesOffset},
+            {updates_.data(), updates_.size() * sizeof(Snapshot::UpdateRecord), &header.updatesOffset}
+        };
+        for (size_t i = 0; i < shapes_.size(); ++i){
+            Snapshot::ShapeRecord& record = shapes[i];
+            record.sizeIndex = static_cast<uint32_t>(shapes_[i].index());
+            if (const auto* mesh = std::get_if<std::shared_ptr<const TriangleMesh>>(&shapes_[i])){
+                const TriangleMesh::Prebuilt prebuilt = (*mesh)->GetPrebuilt();
+                record.counts[0] = static_cast<uint32_t>(prebuilt.vertices.size());
+                record.counts[1] = static_cast<uint32_t>(prebuilt.triangles.size());
+                record.counts[2] = static_cast<uint32_t>(prebuilt.nodes.size());
+                record.bounds = prebuilt.bounds;
+                blobs.push_back({prebuilt.vertices.data(), prebuilt.vertices.size_bytes(), &record.offsets[0]});
+                blobs.push_back({prebuilt.triangles.data(), prebuilt.triangles.size_bytes(), &record.offsets[1]});
+                blobs.push_back({prebuilt.nodes.data(), prebuilt.nodes.size_bytes(), &record.offsets[2]});
+            } else if (const auto* field = std::get_if<std::shared_ptr<const HeightField>>(&shapes_[i])){
+                record.counts[0] = (*field)->GetWidth();
+                record.counts[1] = (*field)->GetDepth();
+                record.parameters[0] = (*field)->GetCellSize();
+                record.parameters[1] = (*field)->GetHeightScale();
+                record.parameters[2] = (*field)->GetHeightOffset();
+                blobs.push_back({(*field)->GetHeights().data(), (*field)->GetHeights().size_bytes(), &record.offsets[0]});
+            } else if (const auto* compound = std::get_if<std::shared_ptr<const CompoundShape>>(&shapes_[i])){
+                auto& out = children.emplace_back();
+                for (const CompoundShape::Child& child : (*compound)->GetChildren()){
+                    Snapshot::ChildRecord& r = out.emplace_back(Snapshot::ChildRecord {child.offset, {}, 0});
+                    if (const auto* radius = std::get_if<float>(&child.size)){
+                        r.size[0] = *radius;
+                    } else{
+                        const Vec3& box = std::get<Vec3>(child.size);
+                        r = {child.offset, {box.x, box.y, box.z}, 1};
+                    }
+                }
+                record.counts[0] = static_cast<uint32_t>(out.size());
+                blobs.push_back({out.data(), out.size() * sizeof(Snapshot::ChildRecord), &record.offsets[0]});
+            } else if (const auto* hull = std::get_if<std::shared_ptr<const ConvexHull>>(&shapes_[i])){
+                record.counts[0] = static_cast<uint32_t>((*hull)->GetVertices().size());
+                blobs.push_back({(*hull)->GetVertices().data(), (*hull)->GetVertices().size_bytes(), &record.offsets[0]});
+            }
+        }
+
+        // 配列の位置を決めてからまとめて書き出す
+        uint64_t offset = AlignUp(sizeof(Snapshot::Header));
+        for (const Blob& blob : blobs){
+            *blob.offset = offset;
+            offset = AlignUp(offset + blob.bytes);
+        }
+        header.fileSize = offset;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        const char padding[kAlignment] {};
+        auto writeAligned = [&](const void* data, size_t bytes){
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            file.write(padding, static_cast<std::streamsize>(AlignUp(bytes) - bytes));
+        };
+        writeAligned(&header, sizeof(header));
+        for (const Blob& blob : blobs){
+            writeAligned(blob.data, blob.bytes);
+        }
+        return static_cast<bool>(file);
+    }
+}
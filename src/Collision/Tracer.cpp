@@ -0,0 +1,139 @@
+#include "Collision/Tracer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace Collision{
+    namespace{
+        uint64_t ToNanoseconds(Tracer::Clock::time_point time) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+        }
+
+        // ナノ秒を Chrome trace のマイクロ秒表記 (小数3桁) にする
+        std::string ToMicroseconds(uint64_t nanoseconds) {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%llu.%03llu",
+                          static_cast<unsigned long long>(nanoseconds / 1000), static_cast<unsigned long long>(nanoseconds % 1000));
+            return buffer;
+        }
+
+        // JSON の文字列としてエスケープする
+        std::string Escape(const std::string& text) {
+            std::string result;
+            result.reserve(text.size());
+            for (const char c : text){
+                if (c == '"' || c == '\\'){
+                    result += '\\';
+                    result += c;
+                } else if (static_cast<unsigned char>(c) < 0x20){
+                    result += ' ';
+                } else{
+                    result += c;
+                }
+            }
+            return result;
+        }
+
+        std::atomic<uint64_t> serialCounter {1};
+
+        // スレッドごとにロックを取らずにバッファを引ける Tracer の数 (番号の剰余で振り分ける)
+        constexpr size_t kThreadCacheSize = 16;
+
+        // SetThreadName で設定した呼び出しスレッドの表示名
+        thread_local std::string threadName;
+    }
+
+    Tracer::Tracer() :serial_(serialCounter.fetch_add(1, std::memory_order_relaxed)) {
+    }
+
+    void Tracer::SetEnabled(bool enabled) {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    void Tracer::Record(const char* name, Clock::time_point begin, Clock::time_point end, std::array<Arg, 2> args) {
+        Buffer& buffer = GetBuffer();
+        // 書き込むのは所有スレッドだけなので、書き込み位置の読み出しと更新は分けてよい
+        const uint64_t written = buffer.written.load(std::memory_order_relaxed);
+        buffer.spans[written % kCapacity] = {name, ToNanoseconds(begin), ToNanoseconds(end), args};
+        buffer.written.store(written + 1, std::memory_order_release);
+    }
+
+    void Tracer::SetThreadName(std::string name) {
+        threadName = std::move(name);
+    }
+
+    bool Tracer::Write(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+
+        std::unique_lock lock(mutex_);
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        file << R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"Collision"}})";
+
+        for (const auto& buffer : buffers_){
+            const uint32_t tid = buffer->index + 1;
+
+            const std::string name = buffer->name.empty() ? "Thread " + std::to_string(tid) : buffer->name;
+            file << ",\n" << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+                 << R"(,"args":{"name":")" << Escape(name) << "\"}}";
+
+            // 上書きされていない範囲だけを古い順に書き出す
+            const uint64_t written = buffer->written.load(std::memory_order_acquire);
+            const uint64_t first = written > kCapacity ? written - kCapacity : 0;
+            for (uint64_t i = first; i < written; ++i){
+                const Span& span = buffer->spans[i % kCapacity];
+                file << ",\n" << R"({"name":")" << span.name << R"(","cat":"collision","ph":"X","pid":1,"tid":)" << tid
+                     << ",\"ts\":" << ToMicroseconds(span.begin)
+                     << ",\"dur\":" << ToMicroseconds(span.end - span.begin);
+                if (span.args[0].name){
+                    file << ",\"args\":{";
+                    for (size_t a = 0; a < span.args.size() && span.args[a].name; ++a){
+                        if (a) file << ',';
+                        file << '"' << span.args[a].name << "\":" << span.args[a].value;
+                    }
+                    file << '}';
+                }
+                file << '}';
+            }
+        }
+
+        file << "\n]}\n";
+        return static_cast<bool>(file);
+    }
+
+    void Tracer::Clear() {
+        std::unique_lock lock(mutex_);
+        for (const auto& buffer : buffers_){
+            buffer->written.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Tracer::Buffer& Tracer::GetBuffer() {
+        // Tracer ごとのバッファを番号で振り分けて覚えておき、2回目以降はロックを取らない
+        // (共有ワーカーが複数のワールドを行き来しても、番号が衝突しない限りロックを取り直さない)
+        struct CacheEntry{
+            uint64_t serial = 0;
+            Buffer* buffer = nullptr;
+        };
+        thread_local std::array<CacheEntry, kThreadCacheSize> cache;
+        CacheEntry& entry = cache[serial_ % kThreadCacheSize];
+        if (entry.serial == serial_) return *entry.buffer;
+
+        std::unique_lock lock(mutex_);
+        const auto id = std::this_thread::get_id();
+        auto itr = std::ranges::find_if(buffers_, [id](const auto& buffer){ return buffer->thread == id; });
+        if (itr == buffers_.end()){
+            auto buffer = std::make_unique<Buffer>();
+            buffer->thread = id;
+            buffer->index = static_cast<uint32_t>(buffers_.size());
+            buffer->name = threadName;
+            buffer->spans = std::make_unique_for_overwrite<Span[]>(kCapacity);
+            buffers_.push_back(std::move(buffer));
+            itr = std::prev(buffers_.end());
+        }
+
+        entry = {serial_, itr->get()};
+        return *entry.buffer;
+    }
+}
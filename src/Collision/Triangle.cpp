@@ -0,0 +1,120 @@
+#include "Triangle.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Capsule.h"
+
+namespace Collision::Intersection{
+    namespace{
+        constexpr float kEpsilon = 1e-8f;
+    }
+
+    Vec3 ClosestPointOnTriangle(const Vec3& point, const Vec3& a, const Vec3& b, const Vec3& c) {
+        const Vec3 ab = b - a;
+        const Vec3 ac = c - a;
+
+        // 頂点 a の領域
+        const Vec3 ap = point - a;
+        const float d1 = ab.Dot(ap);
+        const float d2 = ac.Dot(ap);
+        if (d1 <= 0.f && d2 <= 0.f) return a;
+
+        // 頂点 b の領域
+        const Vec3 bp = point - b;
+        const float d3 = ab.Dot(bp);
+        const float d4 = ac.Dot(bp);
+        if (d3 >= 0.f && d4 <= d3) return b;
+
+        // 辺 ab の領域
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f){
+            return a + ab * (d1 / (d1 - d3));
+        }
+
+        // 頂点 c の領域
+        const Vec3 cp = point - c;
+        const float d5 = ab.Dot(cp);
+        const float d6 = ac.Dot(cp);
+        if (d6 >= 0.f && d5 <= d6) return c;
+
+        // 辺 ac の領域
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f){
+            return a + ac * (d2 / (d2 - d6));
+        }
+
+        // 辺 bc の領域
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f){
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        // 面の内側
+        const float denom = 1.f / (va + vb + vc);
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    }
+
+    bool TriangleBox(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& half) {
+        auto separated = [&](const Vec3& axis){
+            const float p0 = a.Dot(axis);
+            const float p1 = b.Dot(axis);
+            const float p2 = c.Dot(axis);
+            const float r = half.x * std::abs(axis.x) + half.y * std::abs(axis.y) + half.z * std::abs(axis.z);
+            return std::max({p0, p1, p2}) < -r || r < std::min({p0, p1, p2});
+        };
+
+        // ボックスの面法線
+        if (std::max({a.x, b.x, c.x}) < -half.x || half.x < std::min({a.x, b.x, c.x})) return false;
+        if (std::max({a.y, b.y, c.y}) < -half.y || half.y < std::min({a.y, b.y, c.y})) return false;
+        if (std::max({a.z, b.z, c.z}) < -half.z || half.z < std::min({a.z, b.z, c.z})) return false;
+
+        // 三角形の法線
+        const Vec3 edges[3] = {b - a, c - b, a - c};
+        if (separated(Vec3::Cross(edges[0], edges[1]))) return false;
+
+        // 三角形の辺とボックスの軸の外積
+        for (const Vec3& edge : edges){
+            for (const Vec3& axis : {Vec3::Right, Vec3::Up, Vec3::Forward}){
+                if (separated(Vec3::Cross(axis, edge))) return false;
+            }
+        }
+        return true;
+    }
+
+    bool RayTriangle(const Vec3& origin, const Vec3& direction, const Vec3& a, const Vec3& b, const Vec3& c, float& t) {
+        const Vec3 e1 = b - a;
+        const Vec3 e2 = c - a;
+        const Vec3 p = Vec3::Cross(direction, e2);
+        const float det = e1.Dot(p);
+        // 三角形と平行
+        if (std::abs(det) < kEpsilon) return false;
+
+        const float inv = 1.f / det;
+        const Vec3 s = origin - a;
+        const float u = s.Dot(p) * inv;
+        if (u < 0.f || 1.f < u) return false;
+
+        const Vec3 q = Vec3::Cross(s, e1);
+        const float v = direction.Dot(q) * inv;
+        if (v < 0.f || 1.f < u + v) return false;
+
+        t = e2.Dot(q) * inv;
+        return true;
+    }
+
+    float SegmentTriangle(const Vec3& p, const Vec3& q, const Vec3& a, const Vec3& b, const Vec3& c) {
+        float t = 0.f;
+        if (RayTriangle(p, q - p, a, b, c, t) && 0.f <= t && t <= 1.f) return 0.f;
+
+        // 交差しなければ最近点は線分の端点か三角形の辺上にある
+        float distance = std::min((ClosestPointOnTriangle(p, a, b, c) - p).SquaredLength(),
+                                  (ClosestPointOnTriangle(q, a, b, c) - q).SquaredLength());
+        const Vec3 vertices[3] = {a, b, c};
+        for (int i = 0; i < 3; ++i){
+            Vec3 onSegment, onEdge;
+            distance = std::min(distance, SegmentSegment(p, q, vertices[i], vertices[(i + 1) % 3], onSegment, onEdge));
+        }
+        return distance;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Collision/Mathematics.h"
+
+/// @brief
+/// 三角形を含む交差判定 (TriangleMesh の狭域判定用)
+namespace Collision::Intersection{
+    /// 三角形上で点に最も近い点
+    Vec3 ClosestPointOnTriangle(const Vec3& point, const Vec3& a, const Vec3& b, const Vec3& c);
+
+    /**
+     * 三角形と、原点を中心とする軸平行ボックスを分離軸判定で判定します。
+     * OBB はボックスのローカル座標系に変換した三角形を渡します。
+     * @param a 三角形の頂点
+     * @param b 三角形の頂点
+     * @param c 三角形の頂点
+     * @param half ボックスの各軸方向の半分の大きさ
+     * @return 交差する場合はtrue
+     */
+    bool TriangleBox(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& half);
+
+    /**
+     * レイと三角形を判定します (両面)。
+     * @param origin レイの原点
+     * @param direction レイの方向
+     * @param a 三角形の頂点
+     * @param b 三角形の頂点
+     * @param c 三角形の頂点
+     * @param t 交点までのパラメータの出力先 (origin + direction * t)
+     * @return 交差する場合はtrue (t が負の場合も含む)
+     */
+    bool RayTriangle(const Vec3& origin, const Vec3& direction, const Vec3& a, const Vec3& b, const Vec3& c, float& t);
+
+    /// 線分と三角形の二乗距離 (交差していれば0)
+    float SegmentTriangle(const Vec3& p, const Vec3& q, const Vec3& a, const Vec3& b, const Vec3& c);
+}
@@ -0,0 +1,265 @@
+#include "Collision/TriangleMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "BoundsTree.h"
+#include "Triangle.h"
+
+namespace Collision{
+    namespace{
+        constexpr float kQuantizeMax = 65535.f;
+
+        // 量子化による丸め誤差を吸収するため1目盛り外側へ広げる
+        uint16_t QuantizeMin(float value, float origin, float scale) {
+            if (scale <= 0.f) return 0;
+            return static_cast<uint16_t>(std::clamp(std::floor((value - origin) / scale) - 1.f, 0.f, kQuantizeMax));
+        }
+
+        uint16_t QuantizeMax(float value, float origin, float scale) {
+            if (scale <= 0.f) return static_cast<uint16_t>(kQuantizeMax);
+            return static_cast<uint16_t>(std::clamp(std::ceil((value - origin) / scale) + 1.f, 0.f, kQuantizeMax));
+        }
+    }
+
+    TriangleMesh::TriangleMesh(std::span<const Vec3> vertices, std::span<const uint32_t> indices) :vertexStorage_(vertices.begin(), vertices.end()) {
+        vertices_ = vertexStorage_;
+        if (!IsValid(vertices, indices)) return;
+        const uint32_t count = static_cast<uint32_t>(indices.size() / 3);
+        if (count == 0) return;
+
+        std::vector<std::array<uint32_t, 3>> triangles(count);
+        std::vector<Bounds> triangleBounds(count);
+        for (uint32_t i = 0; i < count; ++i){
+            triangles[i] = {indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]};
+            const Vec3& a = vertices_[triangles[i][0]];
+            const Vec3& b = vertices_[triangles[i][1]];
+            const Vec3& c = vertices_[triangles[i][2]];
+            triangleBounds[i] = Bounds {a, a}.Merge({b, b}).Merge({c, c});
+            bounds_ = i == 0 ? triangleBounds[i] : bounds_.Merge(triangleBounds[i]);
+        }
+        scale_ = (bounds_.max - bounds_.min) / kQuantizeMax;
+
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        nodeStorage_.reserve(count / kLeafSize * 2 + 1);
+        BuildMedianSplit<kLeafSize, kMaxDepth>(nodeStorage_, order, triangleBounds, 0, count, [this](const Bounds& bounds, uint32_t index, uint32_t size){
+            // 境界は量子化し、data には葉の先頭と三角形数か、節の右の子を詰める
+            Node node {};
+            for (int axis = 0; axis < 3; ++axis){
+                node.min[axis] = QuantizeMin(Component(bounds.min, axis), Component(bounds_.min, axis), Component(scale_, axis));
+                node.max[axis] = QuantizeMax(Component(bounds.max, axis), Component(bounds_.min, axis), Component(scale_, axis));
+            }
+            node.data = index << 3 | size;
+            return node;
+        });
+        nodes_ = nodeStorage_;
+
+        // 葉から連続して参照できるよう三角形を並べ替える
+        triangleStorage_.resize(count);
+        for (uint32_t i = 0; i < count; ++i){
+            triangleStorage_[i] = triangles[order[i]];
+        }
+        triangles_ = triangleStorage_;
+    }
+
+    TriangleMesh::TriangleMesh(const Prebuilt& prebuilt, std::shared_ptr<const void> external)
+        :external_(std::move(external)), vertices_(prebuilt.vertices), triangles_(prebuilt.triangles), nodes_(prebuilt.nodes), bounds_(prebuilt.bounds) {
+        scale_ = (bounds_.max - bounds_.min) / kQuantizeMax;
+    }
+
+    bool TriangleMesh::IsValid(const Prebuilt& prebuilt) {
+        const size_t vertexCount = prebuilt.vertices.size();
+        for (const auto& triangle : prebuilt.triangles){
+            if (vertexCount <= triangle[0] || vertexCount <= triangle[1] || vertexCount <= triangle[2]) return false;
+        }
+        if (prebuilt.nodes.empty()) return true;
+        if (std::numeric_limits<uint32_t>::max() < prebuilt.nodes.size()) return false;
+
+        // 節は [自身, end) の範囲を持ち、左の子は直後、右の子はその範囲の後半から始まる (構築時と同じ前順)
+        struct Range{
+            uint32_t index;
+            uint32_t end;
+            uint32_t depth;
+        };
+        Range stack[kMaxDepth * 2];
+        uint32_t top = 0;
+        stack[top++] = {0, static_cast<uint32_t>(prebuilt.nodes.size()), 0};
+
+        while (top){
+            const Range range = stack[--top];
+            // 走査のスタックに収まる深さまで
+            if (kMaxDepth <= range.depth) return false;
+
+            const Node& node = prebuilt.nodes[range.index];
+            const uint32_t count = node.data & 0x7;
+            if (count){
+                const uint64_t first = node.data >> 3;
+                if (kLeafSize < count || range.end != range.index + 1 || prebuilt.triangles.size() < first + count) return false;
+                continue;
+            }
+
+            const uint32_t left = range.index + 1;
+            const uint32_t right = node.data >> 3;
+            if (right <= left || range.end <= right) return false;
+            stack[top++] = {right, range.end, range.depth + 1};
+            stack[top++] = {left, right, range.depth + 1};
+        }
+        return true;
+    }
+
+    bool TriangleMesh::IsValid(std::span<const Vec3> vertices, std::span<const uint32_t> indices) {
+        if (indices.size() % 3 != 0) return false;
+        // 葉の先頭を 29bit で表すため
+        if ((size_t {1} << 29) * 3 <= indices.size()) return false;
+        return std::ranges::all_of(indices, [&](uint32_t index){ return index < vertices.size(); });
+    }
+
+    const Bounds& TriangleMesh::GetBounds() const {
+        return bounds_;
+    }
+
+    size_t TriangleMesh::GetTriangleCount() const {
+        return triangles_.size();
+    }
+
+    TriangleMesh::Prebuilt TriangleMesh::GetPrebuilt() const {
+        return {vertices_, triangles_, nodes_, bounds_};
+    }
+
+    bool TriangleMesh::RayCast(const Vec3& origin, const Vec3& direction, float maxDistance, float& t) const {
+        if (nodes_.empty()) return false;
+
+        const Vec3 inverse {1.f / direction.x, 1.f / direction.y, 1.f / direction.z};
+        float best = maxDistance;
+        bool hit = false;
+
+        // ノード番号と、ノードに入る距離
+        std::pair<uint32_t, float> stack[kMaxDepth * 2];
+        uint32_t top = 0;
+        const float rootDistance = RayBounds(origin, inverse, Dequantize(nodes_[0]), best);
+        if (rootDistance < 0.f) return false;
+        stack[top++] = {0, rootDistance};
+
+        while (top){
+            const auto [nodeIndex, entry] = stack[--top];
+            // 積んだ後により近い交点が見つかっていれば調べない
+            if (best < entry) continue;
+            const Node& node = nodes_[nodeIndex];
+
+            const uint32_t count = node.data & 0x7;
+            if (count){
+                const uint32_t first = node.data >> 3;
+                for (uint32_t i = first; i < first + count; ++i){
+                    const auto& triangle = triangles_[i];
+                    float distance = 0.f;
+                    if (Intersection::RayTriangle(origin, direction, vertices_[triangle[0]], vertices_[triangle[1]], vertices_[triangle[2]], distance) &&
+                        0.f <= distance && distance <= best){
+                        best = distance;
+                        hit = true;
+                    }
+                }
+                continue;
+            }
+
+            // 近い子を後に積んで先に調べる
+            const uint32_t left = nodeIndex + 1;
+            const uint32_t right = node.data >> 3;
+            const float leftDistance = RayBounds(origin, inverse, Dequantize(nodes_[left]), best);
+            const float rightDistance = RayBounds(origin, inverse, Dequantize(nodes_[right]), best);
+            const bool leftFirst = rightDistance < 0.f || (0.f <= leftDistance && leftDistance <= rightDistance);
+            if (leftFirst){
+                if (0.f <= rightDistance) stack[top++] = {right, rightDistance};
+                if (0.f <= leftDistance) stack[top++] = {left, leftDistance};
+            } else{
+                if (0.f <= leftDistance) stack[top++] = {left, leftDistance};
+                stack[top++] = {right, rightDistance};
+            }
+        }
+
+        if (hit) t = best;
+        return hit;
+    }
+
+    bool TriangleMesh::OverlapSphere(const Vec3& center, float radius) const {
+        const Vec3 extent {radius, radius, radius};
+        bool found = false;
+        Query({center - extent, center + extent}, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+            found = (Intersection::ClosestPointOnTriangle(center, a, b, c) - center).SquaredLength() <= radius * radius;
+            return !found;
+        });
+        return found;
+    }
+
+    bool TriangleMesh::OverlapAABB(const Vec3& min, const Vec3& max) const {
+        const Vec3 center = (min + max) * 0.5f;
+        const Vec3 half = (max - min) * 0.5f;
+        bool found = false;
+        Query({min, max}, [&](const Vec3& a, const Vec3& b, const Vec3& c){
+            found = Intersection::TriangleBox(a - center, b - center, c - center, half);
+            return !found;
+        });
+        return found;
+    }
+
+    float TriangleMesh::ClosestPoint(const Vec3& point, float maxDistance, Vec3& closest) const {
+        if (nodes_.empty()) return -1.f;
+
+        float best = maxDistance * maxDistance;
+        bool found = false;
+
+        uint32_t stack[kMaxDepth * 2];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top){
+            const uint32_t nodeIndex = stack[--top];
+            const Node& node = nodes_[nodeIndex];
+            if (best < Dequantize(node).SquaredDistance(point)) continue;
+
+            const uint32_t count = node.data & 0x7;
+            if (count){
+                const uint32_t first = node.data >> 3;
+                for (uint32_t i = first; i < first + count; ++i){
+                    const auto& triangle = triangles_[i];
+                    const Vec3 candidate = Intersection::ClosestPointOnTriangle(point, vertices_[triangle[0]], vertices_[triangle[1]], vertices_[triangle[2]]);
+                    const float distance = (candidate - point).SquaredLength();
+                    if (distance <= best){
+                        best = distance;
+                        closest = candidate;
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            const uint32_t left = nodeIndex + 1;
+            const uint32_t right = node.data >> 3;
+            if (Dequantize(nodes_[left]).SquaredDistance(point) <= Dequantize(nodes_[right]).SquaredDistance(point)){
+                stack[top++] = right;
+                stack[top++] = left;
+            } else{
+                stack[top++] = left;
+                stack[top++] = right;
+            }
+        }
+
+        return found ? std::sqrt(best) : -1.f;
+    }
+
+    Bounds TriangleMesh::Dequantize(const Node& node) const {
+        auto decode = [this](uint16_t q, int axis, float origin, float end){
+            // 端はメッシュ境界そのものを使い、丸めで内側に入らないようにする
+            if (q == 0) return origin;
+            if (q == static_cast<uint16_t>(kQuantizeMax)) return end;
+            return origin + static_cast<float>(q) * Component(scale_, axis);
+        };
+        return {
+            {decode(node.min[0], 0, bounds_.min.x, bounds_.max.x), decode(node.min[1], 1, bounds_.min.y, bounds_.max.y), decode(node.min[2], 2, bounds_.min.z, bounds_.max.z)},
+            {decode(node.max[0], 0, bounds_.min.x, bounds_.max.x), decode(node.max[1], 1, bounds_.min.y, bounds_.max.y), decode(node.max[2], 2, bounds_.min.z, bounds_.max.z)}
+        };
+    }
+}
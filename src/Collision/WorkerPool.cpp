@@ -0,0 +1,107 @@
+#include "Collision/WorkerPool.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Collision/Tracer.h"
+
+namespace Collision{
+    WorkerPool::WorkerPool(uint32_t threadCount) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threads_.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i){
+            threads_.emplace_back(&WorkerPool::WorkerThread, this, i);
+        }
+    }
+
+    WorkerPool::~WorkerPool() {
+        {
+            std::unique_lock lock(mutex_);
+            running_ = false;
+        }
+        condition_.notify_all();
+
+        // すべてのスレッドが終了するのを待つ
+        for (auto& thread : threads_){
+            if (thread.joinable()){
+                thread.join();
+            }
+        }
+    }
+
+    void WorkerPool::Submit(Task task) {
+        {
+            std::unique_lock lock(mutex_);
+            tasks_.push(std::move(task));
+        }
+        condition_.notify_one();
+    }
+
+    void WorkerPool::Wait(const std::function<bool()>& done) {
+        std::unique_lock lock(mutex_);
+        while (!done()){
+            if (tasks_.empty()){
+                finished_.wait(lock);
+                continue;
+            }
+
+            // 眠らずに積まれているタスクを手伝う
+            Task task = std::move(tasks_.front());
+            tasks_.pop();
+            lock.unlock();
+            task(GetThreadCount());
+            lock.lock();
+            // 手伝ったタスクを待っている他の呼び出し元を起こす
+            finished_.notify_all();
+        }
+    }
+
+    uint32_t WorkerPool::GetThreadCount() const {
+        return static_cast<uint32_t>(threads_.size());
+    }
+
+    std::shared_ptr<WorkerPool> WorkerPool::GetShared() {
+        static std::mutex mutex;
+        static std::weak_ptr<WorkerPool> shared;
+
+        std::unique_lock lock(mutex);
+        std::shared_ptr<WorkerPool> pool = shared.lock();
+        if (!pool){
+            pool = std::make_shared<WorkerPool>();
+            shared = pool;
+        }
+        return pool;
+    }
+
+    void WorkerPool::WorkerThread(uint32_t index) {
+        Tracer::SetThreadName("Collision Worker " + std::to_string(index));
+        while (true){
+            Task task;
+
+            {
+                std::unique_lock lock(mutex_);
+
+                // タスクがあるか終了するまで待機
+                condition_.wait(lock, [this]{
+                    return !tasks_.empty() || !running_;
+                });
+
+                // 終了条件
+                if (!running_ && tasks_.empty()){
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+
+            task(index);
+
+            // 完了の通知はタスク内で済んでいるので、待っている側が条件を見直す前に起こしても取りこぼさない
+            {
+                std::unique_lock lock(mutex_);
+            }
+            finished_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include "Collision/WorldStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "Collision/CollisionManager.h"
+
+namespace Collision{
+    WorldStreamer::WorldStreamer(Manager& manager, const Settings& settings) :manager_(manager), settings_(settings) {
+        assert(0.f < settings_.cellSize);
+        settings_.unloadRadius = std::max(settings_.unloadRadius, settings_.loadRadius);
+    }
+
+    WorldStreamer::~WorldStreamer() {
+        for (Cell* cell : resident_){
+            if (cell->state == CellState::Active) Deactivate(*cell);
+        }
+    }
+
+    bool WorldStreamer::AddCell(const Vec3i& cell, std::string path) {
+        auto& entry = cells_[cell];
+        if (!entry){
+            entry = std::make_unique<Cell>();
+            entry->key = cell;
+        }
+        if (entry->state == CellState::Preparing) return false;
+
+        entry->path = std::move(path);
+        if (entry->state == CellState::Failed) entry->state = CellState::Unloaded;
+        return true;
+    }
+
+    void WorldStreamer::Update(std::span<const Vec3> points) {
+        // 注目点のセルの周囲を読み込み対象にする
+        std::vector<Vec3i> centers;
+        centers.reserve(points.size());
+        for (const Vec3& point : points){
+            centers.push_back(CellOf(point));
+        }
+
+        // 離れたセルを先に破棄して、同じフレームで読み込むコライダーの分を空ける
+        std::erase_if(resident_, [&](Cell* cell){
+            const CellState state = cell->state.load(std::memory_order_acquire);
+            // 開けなかったセル (AddCell で戻されたものを含む) はここで外す
+            if (state == CellState::Failed || state == CellState::Unloaded) return true;
+            if (IsWithin(cell->key, centers, settings_.unloadRadius)) return false;
+            switch (state){
+            case CellState::Active:
+                Deactivate(*cell);
+                return true;
+            case CellState::Prepared:
+                cell->snapshot.Close();
+                cell->state = CellState::Unloaded;
+                return true;
+            default:
+                // 準備中のセルは終わってから破棄する
+                return false;
+            }
+        });
+
+        wanted_.clear();
+        const int32_t r = settings_.loadRadius;
+        for (const Vec3i& center : centers){
+            for (int32_t z = -r; z <= r; ++z){
+                for (int32_t y = -r; y <= r; ++y){
+                    for (int32_t x = -r; x <= r; ++x){
+                        const Vec3i key(center.x + x, center.y + y, center.z + z);
+                        if (cells_.contains(key)) wanted_.push_back(key);
+                    }
+                }
+            }
+        }
+        // 注目点が近い場合に同じセルを2度扱わない
+        std::ranges::sort(wanted_, [](const Vec3i& a, const Vec3i& b){
+            return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+        });
+        wanted_.erase(std::unique(wanted_.begin(), wanted_.end()), wanted_.end());
+
+        uint32_t activations = 0;
+        for (const Vec3i& key : wanted_){
+            Cell& cell = *cells_.at(key);
+            switch (cell.state.load(std::memory_order_acquire)){
+            case CellState::Unloaded:
+                Prepare(cell);
+                break;
+            case CellState::Prepared:
+                if (settings_.maxActivationsPerUpdate && settings_.maxActivationsPerUpdate <= activations) break;
+                Activate(cell);
+                ++activations;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    Vec3i WorldStreamer::CellOf(const Vec3& point) const {
+        const float inverse = 1.f / settings_.cellSize;
+        return {
+            static_cast<int32_t>(std::floor(point.x * inverse)),
+            static_cast<int32_t>(std::floor(point.y * inverse)),
+            static_cast<int32_t>(std::floor(point.z * inverse))
+        };
+    }
+
+    WorldStreamer::CellState WorldStreamer::GetState(const Vec3i& cell) const {
+        const auto itr = cells_.find(cell);
+        return itr == cells_.end() ? CellState::Unloaded : itr->second->state.load(std::memory_order_acquire);
+    }
+
+    std::span<Collider* const> WorldStreamer::GetColliders(const Vec3i& cell) const {
+        const auto itr = cells_.find(cell);
+        if (itr == cells_.end()) return {};
+        return itr->second->colliders;
+    }
+
+    size_t WorldStreamer::GetActiveCellCount() const {
+        return static_cast<size_t>(std::ranges::count_if(resident_, [](const Cell* cell){ return cell->state == CellState::Active; }));
+    }
+
+    void WorldStreamer::Prepare(Cell& cell) {
+        cell.state = CellState::Preparing;
+        resident_.push_back(&cell);
+        // マップと形状の復元 (メッシュはマップを参照するだけ) を読み込みスレッドで済ませる
+        loader_.Submit([&cell](uint32_t){
+            const bool opened = cell.snapshot.Open(cell.path);
+            cell.state.store(opened ? CellState::Prepared : CellState::Failed, std::memory_order_release);
+        });
+    }
+
+    void WorldStreamer::Activate(Cell& cell) {
+        cell.colliders.resize(cell.snapshot.GetColliderCount());
+        // プールからまとめて生成し、RegisterMany で1回に登録する
+        cell.snapshot.Load(manager_, cell.colliders);
+        // 形状はコライダーが保持するのでマップの参照だけが残る
+        cell.snapshot.Close();
+        cell.state = CellState::Active;
+    }
+
+    void WorldStreamer::Deactivate(Cell& cell) {
+        manager_.DestroyColliders(cell.colliders);
+        cell.colliders.clear();
+        cell.state = CellState::Unloaded;
+    }
+
+    bool WorldStreamer::IsWithin(const Vec3i& cell, std::span<const Vec3i> centers, int32_t radius) const {
+        return std::ranges::any_of(centers, [&](const Vec3i& center){
+            return std::abs(cell.x - center.x) <= radius && std::abs(cell.y - center.y) <= radius && std::abs(cell.z - center.z) <= radius;
+        });
+    }
+}
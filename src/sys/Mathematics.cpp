@@ -1,5 +1,7 @@
 ﻿#include "Collision/Mathematics.h"
 
+#include <cmath>
+
 namespace Collision {
     // 静的メンバの定義
     const Vec3 Vec3::Zero = Vec3(0.0f, 0.0f, 0.0f);
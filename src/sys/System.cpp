@@ -1,19 +1,85 @@
 #include "System.h"
-#include <rpc.h>
+#include <atomic>
+#include <chrono>
+#include <random>
 
-#pragma comment(lib, "rpcrt4.lib")
 namespace System{
-    std::string CreateUniqueId() {
-    	UUID uuid;
-        UuidCreate(&uuid);
-        RPC_CSTR szUuid = nullptr;
-        UuidToStringA(&uuid, &szUuid);
-        struct UUIDCleaner{
-            RPC_CSTR& ptr;
-            ~UUIDCleaner() {
-                if (ptr)RpcStringFreeA(&ptr);
+    namespace{
+        // UUID の上位64ビット (プロセスごとの乱数, バージョン 8 の位置を固定)
+        uint64_t SessionBits() {
+            static const uint64_t bits = []{
+                std::random_device device;
+                const uint64_t random = (static_cast<uint64_t>(device()) << 32) ^ device() ^
+                    static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+                return (random & ~uint64_t {0xF000}) | 0x8000;
+            }();
+            return bits;
+        }
+
+        // UUID の下位64ビットのバリアント (RFC 9562 の 10xx)
+        constexpr uint64_t kVariant = uint64_t {0b10} << 62;
+        constexpr uint64_t kVariantMask = uint64_t {0b11} << 62;
+    }
+
+    uint64_t CreateId() {
+        static std::atomic<uint64_t> next {1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::string FormatUniqueId(uint64_t id) {
+        const uint64_t high = SessionBits();
+        const uint64_t low = (id & ~kVariantMask) | kVariant;
+
+        constexpr char kDigits[] = "0123456789abcdef";
+        std::string uuid(36, '-');
+        size_t position = 0;
+        auto put = [&](uint64_t value, int digits){
+            for (int i = digits - 1; 0 <= i; --i){
+                uuid[position++] = kDigits[(value >> (i * 4)) & 0xF];
             }
-        } cleaner {szUuid};
-        return reinterpret_cast<char*>(szUuid);
+        };
+        put(high >> 32, 8);
+        ++position;
+        put(high >> 16, 4);
+        ++position;
+        put(high, 4);
+        ++position;
+        put(low >> 48, 4);
+        ++position;
+        put(low, 12);
+        return uuid;
+    }
+
+    bool ParseUniqueId(std::string_view uuid, uint64_t& id) {
+        if (uuid.size() != 36) return false;
+
+        uint64_t high = 0;
+        uint64_t low = 0;
+        int digits = 0;
+        for (size_t i = 0; i < uuid.size(); ++i){
+            const char c = uuid[i];
+            if (i == 8 || i == 13 || i == 18 || i == 23){
+                if (c != '-') return false;
+                continue;
+            }
+
+            uint64_t value = 0;
+            if ('0' <= c && c <= '9') value = c - '0';
+            else if ('a' <= c && c <= 'f') value = c - 'a' + 10;
+            else if ('A' <= c && c <= 'F') value = c - 'A' + 10;
+            else return false;
+
+            uint64_t& half = digits < 16 ? high : low;
+            half = half << 4 | value;
+            ++digits;
+        }
+
+        if (high != SessionBits() || (low & kVariantMask) != kVariant) return false;
+        id = low & ~kVariantMask;
+        return true;
+    }
+
+    std::string CreateUniqueId() {
+        return FormatUniqueId(CreateId());
     }
 }
@@ -1,7 +1,23 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace System{
+    /// プロセス内で一意な64ビットのID (0 は使われない)。ロックを取らずどのスレッドからでも呼べる
+    uint64_t CreateId();
+
+    /// ID を UUID 形式の文字列にします (プロセスごとの乱数と ID から作るので、別のプロセスの ID とも重ならない)
+    std::string FormatUniqueId(uint64_t id);
+
+    /**
+     * FormatUniqueId で作った文字列から ID を取り出します。
+     * @param uuid UUID 形式の文字列
+     * @param id ID の出力先
+     * @return このプロセスで作られた文字列でなければfalse
+     */
+    bool ParseUniqueId(std::string_view uuid, uint64_t& id);
+
+    /// 新しい ID を UUID 形式の文字列で返します
     std::string CreateUniqueId();
 };
-